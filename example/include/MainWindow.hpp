@@ -13,6 +13,7 @@ class QVBoxLayout;
 class QSyntaxStyle;
 class QComboBox;
 class QCheckBox;
+class QLineEdit;
 class QSpinBox;
 class QCompleter;
 class QStyleSyntaxHighlighter;
@@ -47,6 +48,8 @@ private:
 
     void performConnections();
 
+    void updateCompletionProviders();
+
     QVBoxLayout* m_setupLayout;
 
     QComboBox* m_codeSampleCombobox;
@@ -59,10 +62,21 @@ private:
     QCheckBox* m_tabReplaceEnabledCheckbox;
     QSpinBox*  m_tabReplaceNumberSpinbox;
     QCheckBox* m_autoIndentationCheckbox;
+    QCheckBox* m_minimapCheckbox;
+    QCheckBox* m_providersCheckbox;
+    QLineEdit* m_findEdit;
+    QLineEdit* m_replaceEdit;
 
     QMenu * m_mainMenu;
     QAction * m_actionToggleComment;
     QAction * m_actionToggleBlockComment;
+    QAction * m_actionGoToMatchingBracket;
+    QAction * m_actionSelectEnclosingScope;
+    QAction * m_actionToggleFold;
+    QAction * m_actionAddCursorAbove;
+    QAction * m_actionAddCursorBelow;
+    QAction * m_actionAddNextOccurrence;
+    QAction * m_actionSplitSelectionIntoLines;
 
     QCodeEditor* m_codeEditor;
 
@@ -2,8 +2,12 @@
 #include <MainWindow.hpp>
 
 // QCodeEditor
+#include <QBufferWordProvider>
 #include <QCodeEditor>
+#include <QCompletionEngine>
+#include <QFuzzyCompleter>
 #include <QGLSLCompleter>
+#include <QKeywordProvider>
 #include <QLuaCompleter>
 #include <QPythonCompleter>
 #include <QSyntaxStyle>
@@ -24,6 +28,56 @@
 #include <QSpinBox>
 #include <QGroupBox>
 #include <QLabel>
+#include <QLineEdit>
+#include <QStatusBar>
+#include <QThread>
+
+namespace
+{
+/**
+ * @brief Class, that stands in for a language server:
+ * it answers slowly, but stops as soon as the request
+ * is cancelled.
+ */
+class SymbolServerProvider : public QCompletionProvider
+{
+  public:
+    explicit SymbolServerProvider(QObject* parent = nullptr) :
+        QCompletionProvider(parent),
+        m_symbols({"QCodeEditor", "QCompletionEngine", "QSyntaxStyle", "setSyntaxStyle", "setHighlighter",
+                   "addCompletionProvider", "findAll", "replaceAll", "toggleComment"})
+    {
+    }
+
+    QStringList complete(const Request& request) override
+    {
+        // Round trip of about 300 ms
+        for (int i = 0; i < 30; ++i)
+        {
+            if (request.isCancelled())
+            {
+                return {};
+            }
+
+            QThread::msleep(10);
+        }
+
+        QStringList result;
+        for (auto&& symbol : m_symbols)
+        {
+            if (symbol.contains(request.prefix, Qt::CaseInsensitive))
+            {
+                result.append(symbol);
+            }
+        }
+
+        return result;
+    }
+
+  private:
+    QStringList m_symbols;
+};
+}
 
 MainWindow::MainWindow(QWidget* parent) :
     QMainWindow(parent),
@@ -37,6 +91,10 @@ MainWindow::MainWindow(QWidget* parent) :
     m_tabReplaceEnabledCheckbox(nullptr),
     m_tabReplaceNumberSpinbox(nullptr),
     m_autoIndentationCheckbox(nullptr),
+    m_minimapCheckbox(nullptr),
+    m_providersCheckbox(nullptr),
+    m_findEdit(nullptr),
+    m_replaceEdit(nullptr),
     m_codeEditor(nullptr),
     m_completers(),
     m_highlighters(),
@@ -149,19 +207,51 @@ void MainWindow::createWidgets()
     m_tabReplaceEnabledCheckbox  = new QCheckBox("Tab Replace", setupGroup);
     m_tabReplaceNumberSpinbox    = new QSpinBox(setupGroup);
     m_autoIndentationCheckbox    = new QCheckBox("Auto Indentation", setupGroup);
+    m_minimapCheckbox            = new QCheckBox("Minimap", setupGroup);
+    m_providersCheckbox          = new QCheckBox("Completion Providers", setupGroup);
+    m_findEdit                   = new QLineEdit(setupGroup);
+    m_replaceEdit                = new QLineEdit(setupGroup);
 
     m_actionToggleComment      = new QAction("Toggle comment", this);
     m_actionToggleBlockComment = new QAction("Toggle block comment", this);
+    m_actionGoToMatchingBracket  = new QAction("Go to matching bracket", this);
+    m_actionSelectEnclosingScope = new QAction("Select enclosing scope", this);
+    m_actionToggleFold           = new QAction("Toggle fold", this);
+    m_actionAddCursorAbove          = new QAction("Add cursor above", this);
+    m_actionAddCursorBelow          = new QAction("Add cursor below", this);
+    m_actionAddNextOccurrence       = new QAction("Add next occurrence", this);
+    m_actionSplitSelectionIntoLines = new QAction("Split selection into lines", this);
 
     m_actionToggleComment->setShortcut(QKeySequence("Ctrl+/"));
     m_actionToggleBlockComment->setShortcut(QKeySequence("Shift+Ctrl+/"));
+    m_actionGoToMatchingBracket->setShortcut(QKeySequence("Ctrl+M"));
+    m_actionSelectEnclosingScope->setShortcut(QKeySequence("Shift+Ctrl+M"));
+    m_actionToggleFold->setShortcut(QKeySequence("Shift+Ctrl+["));
+    m_actionAddCursorAbove->setShortcut(QKeySequence("Ctrl+Alt+Up"));
+    m_actionAddCursorBelow->setShortcut(QKeySequence("Ctrl+Alt+Down"));
+    m_actionAddNextOccurrence->setShortcut(QKeySequence("Ctrl+D"));
+    m_actionSplitSelectionIntoLines->setShortcut(QKeySequence("Shift+Alt+I"));
 
     connect(m_actionToggleComment, &QAction::triggered, m_codeEditor, &QCodeEditor::toggleComment);
     connect(m_actionToggleBlockComment, &QAction::triggered, m_codeEditor, &QCodeEditor::toggleBlockComment);
+    connect(m_actionGoToMatchingBracket, &QAction::triggered, m_codeEditor, &QCodeEditor::goToMatchingBracket);
+    connect(m_actionSelectEnclosingScope, &QAction::triggered, m_codeEditor, &QCodeEditor::selectEnclosingScope);
+    connect(m_actionToggleFold, &QAction::triggered, m_codeEditor, &QCodeEditor::toggleFold);
+    connect(m_actionAddCursorAbove, &QAction::triggered, m_codeEditor, &QCodeEditor::addCursorAbove);
+    connect(m_actionAddCursorBelow, &QAction::triggered, m_codeEditor, &QCodeEditor::addCursorBelow);
+    connect(m_actionAddNextOccurrence, &QAction::triggered, m_codeEditor, &QCodeEditor::addNextOccurrence);
+    connect(m_actionSplitSelectionIntoLines, &QAction::triggered, m_codeEditor, &QCodeEditor::splitSelectionIntoLines);
 
     m_mainMenu = new QMenu("Actions", this);
     m_mainMenu->addAction(m_actionToggleComment);
     m_mainMenu->addAction(m_actionToggleBlockComment);
+    m_mainMenu->addAction(m_actionGoToMatchingBracket);
+    m_mainMenu->addAction(m_actionSelectEnclosingScope);
+    m_mainMenu->addAction(m_actionToggleFold);
+    m_mainMenu->addAction(m_actionAddCursorAbove);
+    m_mainMenu->addAction(m_actionAddCursorBelow);
+    m_mainMenu->addAction(m_actionAddNextOccurrence);
+    m_mainMenu->addAction(m_actionSplitSelectionIntoLines);
     menuBar()->addMenu(m_mainMenu);
 
     // Adding widgets
@@ -178,6 +268,12 @@ void MainWindow::createWidgets()
     m_setupLayout->addWidget(m_tabReplaceEnabledCheckbox);
     m_setupLayout->addWidget(m_tabReplaceNumberSpinbox);
     m_setupLayout->addWidget(m_autoIndentationCheckbox);
+    m_setupLayout->addWidget(m_minimapCheckbox);
+    m_setupLayout->addWidget(m_providersCheckbox);
+    m_setupLayout->addWidget(new QLabel(tr("Find"), setupGroup));
+    m_setupLayout->addWidget(m_findEdit);
+    m_setupLayout->addWidget(new QLabel(tr("Replace all"), setupGroup));
+    m_setupLayout->addWidget(m_replaceEdit);
     m_setupLayout->addSpacerItem(new QSpacerItem(1, 2, QSizePolicy::Minimum, QSizePolicy::Expanding));
 }
 
@@ -238,6 +334,7 @@ void MainWindow::setupWidgets()
     m_tabReplaceNumberSpinbox->setValue(m_codeEditor->tabReplaceSize());
     m_tabReplaceNumberSpinbox->setSuffix(tr(" spaces"));
     m_autoIndentationCheckbox->setChecked(m_codeEditor->autoIndentation());
+    m_minimapCheckbox->setChecked(m_codeEditor->isMinimapVisible());
 
     m_wordWrapCheckBox->setChecked(m_codeEditor->wordWrapMode() != QTextOption::NoWrap);
 
@@ -263,7 +360,10 @@ void MainWindow::performConnections()
         m_completerCombobox,
         QOverload<int>::of(&QComboBox::currentIndexChanged),
         [this](int index)
-        { m_codeEditor->setCompleter(m_completers[index].second); }
+        {
+            m_codeEditor->setCompleter(m_completers[index].second);
+            updateCompletionProviders();
+        }
     );
 
     connect(
@@ -316,4 +416,73 @@ void MainWindow::performConnections()
         [this](int state)
         { m_codeEditor->setAutoIndentation(state != 0); }
     );
+
+    connect(
+        m_minimapCheckbox,
+        &QCheckBox::stateChanged,
+        [this](int state)
+        { m_codeEditor->setMinimapVisible(state != 0); }
+    );
+
+    connect(
+        m_providersCheckbox,
+        &QCheckBox::stateChanged,
+        [this](int)
+        { updateCompletionProviders(); }
+    );
+
+    connect(
+        m_findEdit,
+        &QLineEdit::textChanged,
+        [this](const QString& text)
+        { m_codeEditor->findAll(text); }
+    );
+
+    connect(
+        m_findEdit,
+        &QLineEdit::returnPressed,
+        m_codeEditor,
+        &QCodeEditor::findNext
+    );
+
+    connect(
+        m_replaceEdit,
+        &QLineEdit::returnPressed,
+        [this]()
+        {
+            auto count = m_codeEditor->replaceAll(m_findEdit->text(), m_replaceEdit->text());
+            statusBar()->showMessage(tr("%1 replaced").arg(count));
+        }
+    );
+
+    connect(
+        m_codeEditor,
+        &QCodeEditor::breadcrumbsChanged,
+        [this](const QStringList& scopes)
+        { statusBar()->showMessage(scopes.join(" > ")); }
+    );
+}
+
+void MainWindow::updateCompletionProviders()
+{
+    for (auto provider : m_codeEditor->completionEngine()->providers())
+    {
+        m_codeEditor->removeCompletionProvider(provider);
+        delete provider;
+    }
+
+    if (!m_providersCheckbox->isChecked())
+    {
+        return;
+    }
+
+    // Keywords of the chosen completer, words of the document and a slow symbol server
+    auto completer = qobject_cast<QFuzzyCompleter*>(m_completers[m_completerCombobox->currentIndex()].second);
+    if (completer)
+    {
+        m_codeEditor->addCompletionProvider(new QKeywordProvider(completer->candidates()));
+    }
+
+    m_codeEditor->addCompletionProvider(new QBufferWordProvider(m_codeEditor->wordIndex()));
+    m_codeEditor->addCompletionProvider(new SymbolServerProvider);
 }
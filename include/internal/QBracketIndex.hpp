@@ -0,0 +1,154 @@
+#pragma once
+
+// QCodeEditor
+#include <QCodeBlockData>
+
+// Qt
+#include <QChar>
+#include <QObject> // Required for inheritance
+#include <QPointer>
+#include <QPair>
+#include <QStringList>
+#include <QVector>
+
+class QTextBlock;
+class QTextDocument;
+
+/**
+ * @brief Class, that describes index of the brackets of
+ * a document.
+ * @details Each block keeps its brackets and their depth
+ * change. Blocks with brackets are linked into a treap in
+ * document order, where every node sums up its subtree,
+ * so matching brackets and the depth at a block are found
+ * in O(log n) blocks instead of scanning characters.
+ * Brackets in text highlighted with the ignored syntax
+ * style formats (strings and comments by default) are
+ * skipped.
+ */
+class QBracketIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor. Indexes the current content.
+     * @param document Pointer to indexed document.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QBracketIndex(QTextDocument *document, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Detaches from the blocks.
+     */
+    ~QBracketIndex() override;
+
+    // Disable copying
+    QBracketIndex(const QBracketIndex &) = delete;
+    QBracketIndex &operator=(const QBracketIndex &) = delete;
+
+    /**
+     * @brief Method for setting bracket pairs and
+     * re-indexing the document. Pairs with the same
+     * left and right character are ignored.
+     * Default: (), [] and {}
+     */
+    void setPairs(const QVector<QPair<QChar, QChar>> &pairs);
+
+    /**
+     * @brief Method for setting names of the syntax style
+     * formats, which text contains no brackets.
+     * Default: "String" and "Comment"
+     */
+    void setIgnoredFormats(const QStringList &names);
+
+    /**
+     * @brief Method for checking if there is an opening
+     * bracket at the position.
+     */
+    bool isOpeningBracket(int position) const;
+
+    /**
+     * @brief Method for checking if there is a closing
+     * bracket at the position.
+     */
+    bool isClosingBracket(int position) const;
+
+    /**
+     * @brief Method for getting the bracket matching the
+     * bracket at the position.
+     * @param mismatch If not nullptr, set to whether the
+     * matching bracket is of another pair.
+     * @return Position, -1 if there is no bracket at the
+     * position or it's unmatched.
+     */
+    int matchingBracket(int position, bool *mismatch = nullptr) const;
+
+    /**
+     * @brief Method for getting the innermost brackets
+     * enclosing range [from, to).
+     * @return Positions of the opening and the closing
+     * bracket, -1 if there is none.
+     */
+    QPair<int, int> enclosingBrackets(int from, int to) const;
+
+    /**
+     * @brief Method for getting nesting depth at the
+     * start of the block. Costs O(log n) blocks.
+     */
+    int depth(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for getting brackets of the block,
+     * ordered by column.
+     */
+    QVector<QCodeBlockData::Bracket> brackets(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for removing a deleted block.
+     * Called by QCodeBlockData.
+     */
+    void removeBlock(QCodeBlockData *data);
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that re-indexes the changed blocks.
+     * Format changes count too, because they tell which
+     * brackets are in strings or comments.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    void indexBlocks(int from, int to);
+    void indexBlock(const QTextBlock &block);
+
+    const QCodeBlockData::Bracket *bracketAt(int position) const;
+
+    /**
+     * @brief Method for finding the closing bracket, which
+     * brings `depth` unmatched opening brackets to zero,
+     * at or after `from`.
+     */
+    int findClosing(int from, int depth) const;
+
+    /**
+     * @brief Method for finding the opening bracket, which
+     * brings `depth` unmatched closing brackets to zero,
+     * before `to`.
+     */
+    int findOpening(int to, int depth) const;
+
+    void link(QCodeBlockData *data);
+    void unlink(QCodeBlockData *data);
+
+    QCodeBlockData *firstAfter(int position) const;
+    QCodeBlockData *lastBefore(int position) const;
+
+    QPointer<QTextDocument> m_document;
+
+    QVector<QPair<QChar, QChar>> m_pairs;
+    QStringList m_ignoredFormats;
+
+    QCodeBlockData *m_root;
+    quint32 m_seed;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+// QCodeEditor
+#include <QCompletionProvider> // Required for inheritance
+
+// Qt
+#include <QPointer>
+#include <QStringList>
+
+class QWordIndex;
+
+/**
+ * @brief Class, that describes completion provider of
+ * the words of the edited document.
+ * @details The words are copied from the word index
+ * before a query, only if some were added or removed
+ * since the last copy.
+ */
+class QBufferWordProvider : public QCompletionProvider
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param index Word index of the document.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QBufferWordProvider(QWordIndex *index, QObject *parent = nullptr);
+
+    // Disable copying
+    QBufferWordProvider(const QBufferWordProvider &) = delete;
+    QBufferWordProvider &operator=(const QBufferWordProvider &) = delete;
+
+    void prepare(const Request &request) override;
+
+    QStringList complete(const Request &request) override;
+
+  private:
+    QPointer<QWordIndex> m_index;
+
+    // Copy of the words read by the worker and its revision, -1 before the first copy
+    QStringList m_words;
+    int m_revision;
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+// Qt
+#include <QColor>
+#include <QHash>
+#include <QString>
+#include <QTextBlock>
+#include <QTextBlockUserData> // Required for inheritance
+#include <QVector>
+
+// std
+#include <limits>
+
+class QBracketIndex;
+class QOverviewRuler;
+class QScopeTree;
+class QTrigramIndex;
+class QWordIndex;
+
+/**
+ * @brief Class, that describes per block data maintained
+ * by the editor's indexes. It's attached as block user
+ * data, so it's deleted together with the block.
+ */
+class QCodeBlockData : public QTextBlockUserData
+{
+  public:
+    /**
+     * @brief Constructor.
+     * @param textBlock Block the data is attached to.
+     */
+    explicit QCodeBlockData(const QTextBlock &textBlock);
+
+    /**
+     * @brief Destructor. Removes the block from the
+     * indexes.
+     */
+    ~QCodeBlockData() override;
+
+    // Disable copying
+    QCodeBlockData(const QCodeBlockData &) = delete;
+    QCodeBlockData &operator=(const QCodeBlockData &) = delete;
+
+    /**
+     * @brief Static method for getting data of the block.
+     * @param create Whether to attach new data to a block,
+     * that has none.
+     * @return Pointer to data. May be nullptr.
+     */
+    static QCodeBlockData *get(QTextBlock block, bool create = false);
+
+    /**
+     * @brief The Bracket struct, Bracket outside strings
+     * and comments.
+     */
+    struct Bracket
+    {
+        Bracket(int c = 0, int p = 0, bool o = false) : column(c), pair(p), open(o)
+        {
+        }
+
+        int column;
+
+        // Index of the bracket pair
+        int pair;
+
+        bool open;
+    };
+
+    /**
+     * @brief The BracketSummary struct, Depth change over
+     * a sequence of brackets, opening is +1.
+     */
+    struct BracketSummary
+    {
+        BracketSummary(int d = 0, int m = 0) : delta(d), minPrefix(m)
+        {
+        }
+
+        int delta;
+
+        // Lowest depth reached, never above 0
+        int minPrefix;
+    };
+
+    /**
+     * @brief The BracketNode struct, Links of the block in
+     * the bracket tree. Only blocks with brackets are linked.
+     */
+    struct BracketNode
+    {
+        BracketNode() : left(nullptr), right(nullptr), parent(nullptr), priority(0), linked(false), own(), total()
+        {
+        }
+
+        QCodeBlockData *left;
+        QCodeBlockData *right;
+        QCodeBlockData *parent;
+        quint32 priority;
+        bool linked;
+
+        // Summary of this block and of its subtree
+        BracketSummary own;
+        BracketSummary total;
+    };
+
+    /**
+     * @brief The WideCharacter struct, Columns right after
+     * a non-ASCII character, in each encoding.
+     */
+    struct WideCharacter
+    {
+        WideCharacter(int u16 = 0, int u8 = 0, int cp = 0) : utf16(u16), utf8(u8), codePoint(cp)
+        {
+        }
+
+        int utf16;
+        int utf8;
+        int codePoint;
+    };
+
+    /**
+     * @brief The ScopeSummary struct, Scope depth change
+     * over a block and the lowest depth reached, relative
+     * to the start of the block. Blocks of indentation
+     * scopes have no depth change and their indentation
+     * as the lowest depth.
+     */
+    struct ScopeSummary
+    {
+        ScopeSummary(int d = 0, int m = NoMinimum) : delta(d), minimum(m)
+        {
+        }
+
+        // Minimum of a sequence without blocks
+        static constexpr int NoMinimum = std::numeric_limits<int>::max();
+
+        int delta;
+        int minimum;
+    };
+
+    /**
+     * @brief The ScopeNode struct, Links of the block in
+     * the scope tree. Only blocks opening or closing scopes
+     * are linked.
+     */
+    struct ScopeNode
+    {
+        ScopeNode() : left(nullptr), right(nullptr), parent(nullptr), priority(0), linked(false), own(), total()
+        {
+        }
+
+        QCodeBlockData *left;
+        QCodeBlockData *right;
+        QCodeBlockData *parent;
+        quint32 priority;
+        bool linked;
+
+        // Summary of this block and of its subtree
+        ScopeSummary own;
+        ScopeSummary total;
+    };
+
+    /**
+     * @brief The MinimapRun struct, Run of characters of
+     * the same color in the minimap row of the block.
+     */
+    struct MinimapRun
+    {
+        MinimapRun(int c = 0, int l = 0, QRgb r = 0) : column(c), length(l), color(r)
+        {
+        }
+
+        int column;
+        int length;
+        QRgb color;
+    };
+
+    QTextBlock block;
+
+    // Hash of the indexed text, to skip format-only changes
+    size_t textHash;
+
+    // Columns of each word of the block
+    QHash<QString, QVector<int>> words;
+
+    QWordIndex *wordIndex;
+
+    QVector<Bracket> brackets;
+    BracketNode bracketNode;
+    QBracketIndex *bracketIndex;
+
+    // Empty for ASCII text, where all columns are equal
+    QVector<WideCharacter> wideCharacters;
+
+    ScopeNode scopeNode;
+    QScopeTree *scopeTree;
+
+    // Whether the foldable region starting after the block is folded
+    bool folded;
+
+    QVector<MinimapRun> minimapRuns;
+
+    // Rendering of the minimap the runs are made for, -1 when the block has changed
+    int minimapGeneration;
+
+    // Set once the block has been marked on the overview ruler
+    QOverviewRuler *overviewRuler;
+
+    // Case folded trigrams of the block, sorted
+    QVector<quint64> trigrams;
+    QTrigramIndex *trigramIndex;
+};
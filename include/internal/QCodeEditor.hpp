@@ -1,13 +1,41 @@
 #pragma once
 
+// QCodeEditor
+#include <QDocumentCodec>
+#include <QFindEngine>
+#include <QPositionMapper>
+#include <QTextChangeFilter>
+
 // Qt
+#include <QHash>
+#include <QStringList>
 #include <QTextEdit> // Required for inheritance
 
+// std
+#include <functional>
+
+class QBracketIndex;
 class QCompleter;
+class QCompletionEngine;
+class QCompletionProvider;
+class QDecorationManager;
+class QDiagnosticStore;
+class QFileLoader;
+class QFoldingManager;
+class QFuzzyCompleter;
+class QScopeTree;
 class QLineNumberArea;
+class QMinimap;
+class QMultiCursor;
+class QOverviewRuler;
 class QSyntaxStyle;
 class QStyleSyntaxHighlighter;
 class QFramedTextAttribute;
+class QPainter;
+class QThread;
+class QTrigramIndex;
+class QWordIndex;
+class QTimer;
 
 /**
  * @brief Class, that describes code editor.
@@ -40,12 +68,64 @@ class QCodeEditor : public QTextEdit
         }
     };
 
+    /**
+     * @brief The Diagnostic struct, Message attached to
+     * range [start, stop] of the text.
+     * @note QPair<int, int>: first -> Line number in 1-based indexing
+     *                        second -> Character number in 0-based indexing
+     * @note Diagnostics with id -1 can't be updated one by one.
+     */
+    struct Diagnostic
+    {
+        Diagnostic(SeverityLevel l = SeverityLevel::Error, QPair<int, int> s = {1, 0}, QPair<int, int> e = {1, 0},
+                   const QString &m = QString(), int i = -1)
+            : level(l), start(s), stop(e), message(m), id(i)
+        {
+        }
+
+        SeverityLevel level;
+        QPair<int, int> start;
+        QPair<int, int> stop;
+        QString message;
+        int id;
+    };
+
+    /**
+     * @brief RAII helper, that calls `beginBulkEdit` on
+     * construction and `endBulkEdit` on destruction.
+     */
+    class BulkEdit
+    {
+      public:
+        explicit BulkEdit(QCodeEditor *editor) : m_editor(editor)
+        {
+            m_editor->beginBulkEdit();
+        }
+
+        ~BulkEdit()
+        {
+            m_editor->endBulkEdit();
+        }
+
+        // Disable copying
+        BulkEdit(const BulkEdit &) = delete;
+        BulkEdit &operator=(const BulkEdit &) = delete;
+
+      private:
+        QCodeEditor *m_editor;
+    };
+
     /**
      * @brief Constructor.
      * @param widget Pointer to parent widget.
      */
     explicit QCodeEditor(QWidget *widget = nullptr);
 
+    /**
+     * @brief Destructor. Stops file loading.
+     */
+    ~QCodeEditor() override;
+
     // Disable copying
     QCodeEditor(const QCodeEditor &) = delete;
     QCodeEditor &operator=(const QCodeEditor &) = delete;
@@ -69,6 +149,18 @@ class QCodeEditor : public QTextEdit
      */
     void setSyntaxStyle(QSyntaxStyle *style);
 
+    /**
+     * @brief Method for getting syntax style.
+     * @return Pointer to syntax style.
+     */
+    QSyntaxStyle *syntaxStyle() const;
+
+    /**
+     * @brief Method for getting line number area, e.g. to
+     * add columns to it.
+     */
+    QLineNumberArea *lineNumberArea() const;
+
     /**
      * @brief Method for setting tab replacing
      * enabled.
@@ -105,6 +197,21 @@ class QCodeEditor : public QTextEdit
      */
     void setParentheses(const QVector<Parenthesis> &parentheses);
 
+    /**
+     * @brief Method for setting bracket pairs colored by
+     * nesting depth enabled. Colors are the syntax style
+     * formats "Parentheses.Level1", "Parentheses.Level2"...
+     * repeated after the last one.
+     */
+    void setRainbowBrackets(bool enabled);
+
+    /**
+     * @brief Method for getting is coloring bracket pairs
+     * by nesting depth enabled.
+     * Default: true
+     */
+    bool rainbowBrackets() const;
+
     /**
      * @brief Method for setting extra bottom margin enabled.
      */
@@ -117,7 +224,9 @@ class QCodeEditor : public QTextEdit
     bool autoIndentation() const;
 
     /**
-     * @brief Method for setting completer.
+     * @brief Method for setting completer. A QFuzzyCompleter
+     * ranks its candidates by fuzzy match, other completers
+     * filter by prefix.
      * @param completer Pointer to completer object.
      */
     void setCompleter(QCompleter *completer);
@@ -128,6 +237,206 @@ class QCodeEditor : public QTextEdit
      */
     QCompleter *completer() const;
 
+    /**
+     * @brief Method for adding a completion provider. The
+     * editor takes ownership of it. Once a provider is
+     * added, completions are taken from the providers
+     * instead of the completer: they're queried in worker
+     * threads as the word under cursor changes and the
+     * popup is updated as each of them answers.
+     */
+    void addCompletionProvider(QCompletionProvider *provider);
+
+    /**
+     * @brief Method for removing a completion provider.
+     * The caller takes ownership of it.
+     */
+    void removeCompletionProvider(QCompletionProvider *provider);
+
+    /**
+     * @brief Method for getting engine, that queries the
+     * completion providers.
+     */
+    QCompletionEngine *completionEngine() const;
+
+    /**
+     * @brief Method for getting decoration layers. Built-in
+     * layers are "CurrentLine", "RainbowBrackets", "Occurrences",
+     * "SearchResults", "Squiggles", "SecondarySelections" and
+     * "Parentheses", custom layers may be added.
+     */
+    QDecorationManager *decorations() const;
+
+    /**
+     * @brief Method for getting index of the words of
+     * the document.
+     */
+    QWordIndex *wordIndex() const;
+
+    /**
+     * @brief Method for getting index of the brackets
+     * of the document.
+     */
+    QBracketIndex *bracketIndex() const;
+
+    /**
+     * @brief Method for getting folding of the regions
+     * of the document.
+     */
+    QFoldingManager *folding() const;
+
+    /**
+     * @brief Method for getting tree of the syntactic
+     * scopes of the document. Scopes are made of what
+     * the highlighter's folding mode says.
+     */
+    QScopeTree *scopeTree() const;
+
+    /**
+     * @brief Method for setting lines opening the scopes
+     * of the top visible line stuck to the top of the
+     * viewport enabled.
+     */
+    void setStickyHeaders(bool enabled);
+
+    /**
+     * @brief Method for getting is sticking lines opening
+     * the scopes of the top visible line enabled.
+     * Default: true
+     */
+    bool stickyHeaders() const;
+
+    /**
+     * @brief Method for getting lines opening the scopes
+     * of the cursor, outermost first.
+     */
+    QStringList breadcrumbs() const;
+
+    /**
+     * @brief Method for setting minimap shown at the
+     * right side of the editor.
+     */
+    void setMinimapVisible(bool visible);
+
+    /**
+     * @brief Method for getting is minimap shown.
+     * Default: false
+     */
+    bool isMinimapVisible() const;
+
+    /**
+     * @brief Method for getting minimap of the editor.
+     */
+    QMinimap *minimap() const;
+
+    /**
+     * @brief Method for getting vertical scrollbar of the
+     * editor, which marks diagnostics, occurrences and
+     * changed lines.
+     */
+    QOverviewRuler *overviewRuler() const;
+
+    /**
+     * @brief Method for getting background search of the
+     * document, which hits are highlighted.
+     */
+    QFindEngine *findEngine() const;
+
+    /**
+     * @brief Method for searching all matches of the
+     * pattern in the background. Only the hits in the
+     * viewport are highlighted.
+     * @return false if the pattern is empty or not a valid
+     * regular expression.
+     */
+    bool findAll(const QString &pattern, const QFindEngine::Options &options = QFindEngine::Options());
+
+    /**
+     * @brief Method for dropping the search and its
+     * highlighting.
+     */
+    void clearFind();
+
+    /**
+     * @brief Method for replacing all matches of the
+     * pattern. Matches are found on a snapshot of the
+     * text and replaced as a single edit, which rewrites
+     * only the lines containing them. The highlighting
+     * and decorations are updated once afterwards. Empty
+     * matches insert the replacement. Nothing is replaced
+     * in a read-only editor, e.g. while loading a file.
+     * @param replacement Replacing text. For regular
+     * expressions, `\N` is replaced by the N-th capture.
+     * @return Number of replaced matches.
+     */
+    int replaceAll(const QString &pattern, const QString &replacement,
+                   const QFindEngine::Options &options = QFindEngine::Options());
+
+    /**
+     * @brief Method for getting trigram index of the
+     * document, which narrows the background search.
+     * It's disabled by default.
+     */
+    QTrigramIndex *trigramIndex() const;
+
+    /**
+     * @brief Method for getting secondary cursors of the
+     * editor. Typing, deleting, indenting and commenting
+     * apply to all of them and to the text cursor, as a
+     * single edit.
+     */
+    QMultiCursor *multiCursor() const;
+
+    /**
+     * @brief Method for getting converter between offsets
+     * and line/column positions of the document.
+     */
+    QPositionMapper *positionMapper() const;
+
+    /**
+     * @brief Method for setting unit of the columns given
+     * to `squiggle`, `setDiagnostics` and `updateDiagnostics`,
+     * e.g. UTF-8 for language servers counting bytes.
+     */
+    void setPositionEncoding(QPositionMapper::Encoding encoding);
+
+    /**
+     * @brief Method for getting unit of the columns given
+     * to `squiggle`, `setDiagnostics` and `updateDiagnostics`.
+     * Default: UTF-16
+     */
+    QPositionMapper::Encoding positionEncoding() const;
+
+    /**
+     * @brief Method for getting diagnostics of the document.
+     */
+    QDiagnosticStore *diagnostics() const;
+
+    /**
+     * @brief Method for replacing all diagnostics at once.
+     * Much faster than a `squiggle` call per diagnostic, only
+     * the visible ones are decorated.
+     * @param version Version of the text (see
+     * `QDiagnosticStore::version`) the positions are given
+     * for, e.g. the one sent to a language server. -1 for
+     * the current text.
+     * @return false if the version is too old, nothing
+     * is changed then.
+     */
+    bool setDiagnostics(const QVector<Diagnostic> &diagnostics, int version = -1);
+
+    /**
+     * @brief Method for changing some of the diagnostics.
+     * Diagnostics with the removed ids are removed, added
+     * ones replace diagnostics with the same id. The others
+     * keep following their text through the edits.
+     * @param version Version of the text the positions are
+     * given for, -1 for the current text.
+     * @return false if the version is too old, nothing
+     * is changed then.
+     */
+    bool updateDiagnostics(const QVector<Diagnostic> &added, const QVector<int> &removedIds, int version = -1);
+
     /**
      * @brief squiggle Puts a underline squiggle under text ranges in Editor
      * @param level defines the color of the underline depending upon the severity
@@ -142,12 +451,131 @@ class QCodeEditor : public QTextEdit
      */
     void clearSquiggle();
 
+    /**
+     * @brief Method for loading a file without blocking the GUI.
+     * The file is read and decoded on a worker thread and appended
+     * to the document chunk by chunk, so the first screen shows up
+     * immediately. The editor is read-only and has no undo history
+     * while loading. Highlighting starts once the file is loaded,
+     * with the visible lines.
+     * @param path Path to the file.
+     */
+    void loadFileAsync(const QString &path);
+
+    /**
+     * @brief Method for cancelling the current file loading.
+     * The already loaded part stays in the document.
+     */
+    void cancelLoading();
+
+    /**
+     * @brief Method for getting is a file being loaded.
+     */
+    bool isLoading() const;
+
+    /**
+     * @brief Method for starting a group of programmatic edits.
+     * Until the matching `endBulkEdit`, all edits form a single
+     * undo step, and the highlighter, extra selections, line number
+     * area width and bottom margin are not updated. Calls may be
+     * nested.
+     */
+    void beginBulkEdit();
+
+    /**
+     * @brief Method for finishing a group of programmatic edits.
+     * The outermost call highlights the changed range once and
+     * recomputes the deferred state once.
+     */
+    void endBulkEdit();
+
+    /**
+     * @brief Method for getting is a bulk edit in progress.
+     */
+    bool isInBulkEdit() const;
+
+    /**
+     * @brief Method for saving the document with the
+     * encoding and line break style of the loaded file.
+     * The text is written as it is, e.g. non-breaking
+     * spaces are kept.
+     * @param path Path to the file.
+     * @param replaceInvalid Whether to save a file, which
+     * had malformed sequences, with U+FFFD in their place.
+     * Otherwise saving it fails, see `invalidSequences`.
+     * @return Success.
+     */
+    bool saveFile(const QString &path, bool replaceInvalid = false);
+
+    /**
+     * @brief Method for setting encoding used by `saveFile`.
+     */
+    void setEncoding(QDocumentCodec::Encoding encoding);
+
+    /**
+     * @brief Method for getting encoding detected by
+     * `loadFileAsync`.
+     * Default: UTF-8
+     */
+    QDocumentCodec::Encoding encoding() const;
+
+    /**
+     * @brief Method for setting line break style used
+     * by `saveFile`. The document itself always uses '\n'.
+     */
+    void setLineEnding(QDocumentCodec::LineEnding lineEnding);
+
+    /**
+     * @brief Method for getting line break style detected
+     * by `loadFileAsync`.
+     * Default: LF
+     */
+    QDocumentCodec::LineEnding lineEnding() const;
+
+    /**
+     * @brief Method for getting number of malformed
+     * sequences replaced by U+FFFD while loading the file.
+     * The encoding is detected from the beginning of the
+     * file, malformed bytes later on can't be restored,
+     * so `saveFile` refuses to save it unless asked to.
+     * It's 0 again after such a save.
+     */
+    int invalidSequences() const;
+
   Q_SIGNALS:
     /**
      * @brief Signal, the font is changed by the wheel event.
      */
     void fontChanged(const QFont &newFont);
 
+    /**
+     * @brief Signal, the word, which occurrences are
+     * highlighted, has changed.
+     * @param word Selected word, empty if the selection
+     * isn't a single word.
+     * @param count Number of occurrences in the document.
+     */
+    void occurrencesChanged(const QString &word, int count);
+
+    /**
+     * @brief Signal, a chunk of the loaded file has been appended.
+     */
+    void loadProgress(qint64 bytesRead, qint64 bytesTotal);
+
+    /**
+     * @brief Signal, the file loading is over.
+     * @param success False if the file couldn't be read or
+     * the loading has been cancelled.
+     */
+    void loadFinished(bool success);
+
+    /**
+     * @brief Signal, the scopes of the cursor have changed.
+     * @param scopes Lines opening the scopes, outermost
+     * first.
+     */
+    void breadcrumbsChanged(const QStringList &scopes);
+
   public Q_SLOTS:
 
     /**
@@ -158,7 +586,7 @@ class QCodeEditor : public QTextEdit
     void insertCompletion(const QString &s);
 
     /**
-     * @brief Slot, that performs update of
+     * @brief Slot, that schedules update of
      * internal editor viewport based on line
      * number area width.
      */
@@ -172,8 +600,9 @@ class QCodeEditor : public QTextEdit
     void updateLineNumberArea(QRect rect);
 
     /**
-     * @brief Slot, that will proceed extra selection
-     * for current cursor position.
+     * @brief Slot, that will schedule extra selection
+     * for current cursor position (1) and for
+     * occurrences of the selection (2).
      */
     void updateExtraSelection1();
     void updateExtraSelection2();
@@ -224,6 +653,69 @@ class QCodeEditor : public QTextEdit
      */
     void toggleBlockComment();
 
+    /**
+     * @brief Slot, that moves the cursor to the bracket
+     * matching the one at the cursor, or to the enclosing
+     * opening bracket.
+     */
+    void goToMatchingBracket();
+
+    /**
+     * @brief Slot, that selects the content of the
+     * enclosing brackets, then the brackets too, then
+     * the outer scope.
+     */
+    void selectEnclosingScope();
+
+    /**
+     * @brief Slot, that folds or unfolds the region
+     * starting after the current line.
+     */
+    void toggleFold();
+
+    /**
+     * @brief Slot, that selects the next hit of the search
+     * after the cursor, wrapping around the document.
+     */
+    void findNext();
+
+    /**
+     * @brief Slot, that selects the previous hit of the
+     * search before the cursor, wrapping around the
+     * document.
+     */
+    void findPrevious();
+
+    /**
+     * @brief Slot, that adds a cursor on the line above
+     * the topmost cursor.
+     */
+    void addCursorAbove();
+
+    /**
+     * @brief Slot, that adds a cursor on the line below
+     * the bottommost cursor.
+     */
+    void addCursorBelow();
+
+    /**
+     * @brief Slot, that selects the word under the cursor,
+     * or, if there's a selection, adds a cursor selecting
+     * its next occurrence.
+     */
+    void addNextOccurrence();
+
+    /**
+     * @brief Slot, that replaces each selection spanning
+     * several lines by a cursor per line.
+     */
+    void splitSelectionIntoLines();
+
+    /**
+     * @brief Slot, that removes the secondary cursors.
+     */
+    void clearSecondaryCursors();
+
   protected:
     /**
      * @brief Method, that's called on any text insertion of
@@ -250,6 +742,13 @@ class QCodeEditor : public QTextEdit
      */
     void changeEvent(QEvent *e) override;
 
+    /**
+     * @brief Method, that's called when the viewport is
+     * scrolled. The line number area is scrolled along, so
+     * only the exposed rows are painted.
+     */
+    void scrollContentsBy(int dx, int dy) override;
+
     /**
      * @brief Method, update the font size when the wheel is rotated with Ctrl pressed
      */
@@ -266,6 +765,12 @@ class QCodeEditor : public QTextEdit
      */
     void keyPressEvent(QKeyEvent *e) override;
 
+    /**
+     * @brief Method, that's called on mouse press. Alt+click
+     * adds a cursor, a click removes the secondary ones.
+     */
+    void mousePressEvent(QMouseEvent *e) override;
+
     /**
      * @brief Method, that's called on focus into widget.
      * It's required for setting this widget to set
@@ -280,11 +785,67 @@ class QCodeEditor : public QTextEdit
 
   private Q_SLOTS:
     /**
-     * @brief Slot, that updates the bottom margin.
+     * @brief Slot, that schedules update of the bottom margin.
      */
     void updateBottomMargin();
 
+    /**
+     * @brief Slot, that appends a chunk of the loaded file
+     * and requests the next one.
+     */
+    void appendLoadedChunk(const QString &text, qint64 bytesRead, qint64 bytesTotal);
+
+    /**
+     * @brief Slot, that restores the editor state after loading.
+     */
+    void finishLoading(bool success);
+
+    /**
+     * @brief Slot, that highlights the next blocks, which
+     * haven't been highlighted since loading.
+     */
+    void highlightNextBlocks();
+
+    /**
+     * @brief Slot, that recomputes the dirty derived state.
+     */
+    void flushUpdates();
+
+    /**
+     * @brief Slot, that takes the word to highlight from
+     * the selection, after it has settled.
+     */
+    void updateOccurrenceWord();
+
+    /**
+     * @brief Slot, that shows the completions of the
+     * providers, if the word under cursor is still the
+     * completed one.
+     */
+    void updateProviderCompletions(const QString &prefix, const QStringList &results);
+
   private:
+    /**
+     * @brief The DirtyState enum, Derived state recomputed
+     * by `flushUpdates`.
+     */
+    enum DirtyState
+    {
+        CurrentLineDirty = 0x01,
+        OccurrencesDirty = 0x02,
+        LineNumberAreaWidthDirty = 0x04,
+        BottomMarginDirty = 0x08,
+        DecorationsDirty = 0x10,
+        VisibleOccurrencesDirty = 0x20,
+        VisibleBracketsDirty = 0x40,
+        VisibleDiagnosticsDirty = 0x80,
+        ScopesDirty = 0x100,
+        OverviewDiagnosticsDirty = 0x200,
+        VisibleSearchResultsDirty = 0x400,
+        VisibleSecondaryCursorsDirty = 0x800,
+        VisibleHighlightingDirty = 0x1000
+    };
+
     /**
      * @brief Method for initializing default
      * monospace font.
@@ -311,6 +872,19 @@ class QCodeEditor : public QTextEdit
     bool proceedCompleterBegin(QKeyEvent *e);
     void proceedCompleterEnd(QKeyEvent *e);
 
+    /**
+     * @brief Method for getting completer in use: the one
+     * of the providers if there are any, otherwise the
+     * one set by `setCompleter`.
+     */
+    QCompleter *activeCompleter() const;
+
+    /**
+     * @brief Method for showing popup of the completer
+     * under cursor, or hiding it if nothing matches.
+     */
+    void showCompleterPopup(QCompleter *completer);
+
     /**
      * @brief Method for getting character under
      * cursor.
@@ -325,23 +899,188 @@ class QCodeEditor : public QTextEdit
      */
     QString wordUnderCursor() const;
 
+    /**
+     * @brief Method for marking derived state dirty. It's
+     * recomputed once, when control returns to the event
+     * loop, or when the bulk edit ends.
+     * @param state Combination of DirtyState flags.
+     */
+    void scheduleUpdate(int state);
+
+    /**
+     * @brief Method for showing changed decoration layers.
+     * Only extra selection layers are passed to QTextEdit,
+     * painted layers just repaint.
+     */
+    void applyDecorations();
+
+    /**
+     * @brief Method for painting the visible part of painted
+     * decoration layers.
+     * @param underlines Backgrounds are painted below the text,
+     * underlines above it.
+     */
+    void paintDecorations(QPainter &painter, const QRect &rect, bool underlines);
+
+    /**
+     * @brief Method for painting carets of the visible
+     * secondary cursors.
+     */
+    void paintSecondaryCursors(QPainter &painter, const QRect &rect);
+
+    /**
+     * @brief Method for painting the sticky headers over
+     * the top of the viewport.
+     */
+    void paintStickyHeaders(QPainter &painter);
+
+    /**
+     * @brief Method for getting viewport rectangles of
+     * range [start, end], one per visual line.
+     */
+    QVector<QRectF> decorationRects(int start, int end, bool fullWidth) const;
+
+    /**
+     * @brief Method for getting bounding rectangle of the
+     * visible decorations of a painted layer, in document
+     * coordinates.
+     */
+    QRect layerBoundingRect(const QString &layer) const;
+
     /**
      * @brief Method, that adds highlighting of
      * currently selected line to extra selection list.
      */
     void highlightCurrentLine();
 
+    /**
+     * @brief Method for getting position of the bracket
+     * after the cursor if it's opening, or before the
+     * cursor if it's closing.
+     * @return Position, -1 if there is none.
+     */
+    int bracketUnderCursor() const;
+
     /**
      * @brief Method, that adds highlighting of
      * parenthesis if available.
      */
     void highlightParenthesis();
 
+    /**
+     * @brief Method, that colors the visible brackets
+     * by their nesting depth. The depth is known at the
+     * first visible block, so nothing above the viewport
+     * is scanned.
+     */
+    void highlightBracketLevels();
+
+    /**
+     * @brief Method, that updates the sticky headers and
+     * the breadcrumbs. Each costs O(log n) blocks per
+     * enclosing scope, nothing is scanned.
+     */
+    void updateScopes();
+
+    /**
+     * @brief Method for getting the line naming the scope
+     * opened by the block. It's the line before, if the
+     * block has nothing but brackets.
+     */
+    QTextBlock scopeTitle(const QTextBlock &block) const;
+
+    /**
+     * @brief Method, that underlines the visible
+     * diagnostics.
+     */
+    void highlightDiagnostics();
+
+    /**
+     * @brief Method, that marks lines of the errors and
+     * warnings on the overview ruler.
+     */
+    void markDiagnostics();
+
+    /**
+     * @brief Method, that highlights the visible hits
+     * of the search.
+     */
+    void highlightSearchResults();
+
+    /**
+     * @brief Method for selecting the hit of the search
+     * next to the selection.
+     */
+    void selectNextHit(bool backward);
+
+    /**
+     * @brief Method for getting squiggle format of
+     * the severity level.
+     */
+    QTextCharFormat diagnosticFormat(SeverityLevel level) const;
+
+    /**
+     * @brief Method for getting document offset of
+     * a line and column pair of the version, clamped
+     * to the document.
+     */
+    int diagnosticOffset(QPair<int, int> position, int version = -1) const;
+
+    /**
+     * @brief Method, that highlights the visible
+     * occurrences of the selected word.
+     */
     void highlightOccurrences();
 
+    /**
+     * @brief Method, that highlights the selections of
+     * the visible secondary cursors.
+     */
+    void highlightSecondarySelections();
+
+    /**
+     * @brief Method for attaching the highlighter to the
+     * loaded text. The visible blocks are highlighted
+     * right away, the others in the background.
+     */
+    void startHighlighting();
+
+    /**
+     * @brief Method, that highlights the visible blocks,
+     * which the background highlighting hasn't reached.
+     */
+    void highlightVisibleBlocks();
+
+    /**
+     * @brief Method for applying an edit to each cursor
+     * and to the text cursor, as a single bulk edit.
+     * Cursors, that the edit made overlap, are merged.
+     */
+    void editCursors(const std::function<void(QTextCursor &)> &edit);
+
+    /**
+     * @brief Method for handling keys, which apply to all
+     * cursors, while there are secondary cursors.
+     * @return true if the key has been handled.
+     */
+    bool multiCursorKeyPress(QKeyEvent *e);
+
+    /**
+     * @brief Method for adding a cursor next to the
+     * outermost cursor.
+     * @param operation QTextCursor::Up or QTextCursor::Down.
+     */
+    void addCursorVertically(QTextCursor::MoveOperation operation);
+
+    /**
+     * @brief Method for getting the blocks of the cursors
+     * and their selections, sorted and unique.
+     */
+    QVector<QTextBlock> selectedBlocks() const;
+
     /**
      * @brief Method for remove the first group of regex
-     * in each line of the selection.
+     * in each line of the selections of all cursors.
      * @param regex remove its first group
      * @param force if true, remove regardless of whether
      * all lines are begun with regex; if false remove
@@ -352,42 +1091,85 @@ class QCodeEditor : public QTextEdit
 
     /**
      * @brief Method for add the str at the begin of regex
-     * in each line of the selection.
+     * in each line of the selections of all cursors.
      * @param regex add at the begin of its match
      * @param str string to add
      */
     void addInEachLineOfSelection(const QRegularExpression &regex, const QString &str);
 
-    /**
-     * @brief The SquiggleInformation struct, Line number will be index of vector+1;
-     */
-    struct SquiggleInformation
-    {
-        SquiggleInformation() = default;
-
-        SquiggleInformation(QPair<int, int> start, QPair<int, int> stop, const QString &text)
-            : m_startPos(start), m_stopPos(stop), m_tooltipText(text)
-        {
-        }
-
-        QPair<int, int> m_startPos;
-        QPair<int, int> m_stopPos;
-        QString m_tooltipText;
-    };
-
     QStyleSyntaxHighlighter *m_highlighter;
     QSyntaxStyle *m_syntaxStyle;
     QLineNumberArea *m_lineNumberArea;
     QCompleter *m_completer;
 
+    // Block, which number is highlighted in the line number area
+    int m_currentLineBlock;
+
     bool m_autoIndentation;
     bool m_replaceTab;
     bool m_extraBottomMargin;
     QString m_tabReplace;
 
-    QList<QTextEdit::ExtraSelection> extra1, extra2, extra_squiggles;
+    QDecorationManager *m_decorations;
 
-    QVector<SquiggleInformation> m_squiggler;
+    // Last painted bounding rectangles of the painted layers
+    QHash<QString, QRect> m_layerRects;
+    QDiagnosticStore *m_diagnostics;
+    QPositionMapper *m_positionMapper;
+    QPositionMapper::Encoding m_positionEncoding;
 
     QVector<Parenthesis> m_parentheses;
+
+    QThread *m_loadThread;
+    QFileLoader *m_loader;
+    bool m_loadReadOnly;
+
+    // Number of the block highlighted next in the background, -1 if all are
+    int m_highlightBlock;
+    QTimer *m_highlightTimer;
+
+    QDocumentCodec::Encoding m_encoding;
+    QDocumentCodec::LineEnding m_lineEnding;
+    int m_invalidSequences;
+
+    int m_bulkEditDepth;
+    QTextCursor m_bulkEditCursor;
+
+    // Combination of DirtyState flags
+    int m_dirtyState;
+    QTimer *m_updateTimer;
+
+    QWordIndex *m_wordIndex;
+    QTimer *m_occurrenceTimer;
+    QString m_occurrenceWord;
+
+    QBracketIndex *m_bracketIndex;
+    bool m_rainbowBrackets;
+    QVector<QTextCharFormat> m_bracketLevelFormats;
+
+    QScopeTree *m_scopeTree;
+    QFoldingManager *m_folding;
+
+    bool m_stickyHeaders;
+
+    // Numbers of the blocks shown as sticky headers
+    QVector<int> m_stickyHeaderBlocks;
+    int m_stickyHeaderHeight;
+
+    QStringList m_breadcrumbs;
+
+    QMinimap *m_minimap;
+    QOverviewRuler *m_overviewRuler;
+
+    // Tells edits from format changes for the changes lane
+    QTextChangeFilter m_changeFilter;
+
+    QFindEngine *m_findEngine;
+    QTrigramIndex *m_trigramIndex;
+    QMultiCursor *m_multiCursor;
+
+    QCompletionEngine *m_completionEngine;
+
+    // Ranks the completions of the providers, created with the first one
+    QFuzzyCompleter *m_providerCompleter;
 };
@@ -0,0 +1,163 @@
+#pragma once
+
+// QCodeEditor
+#include <QCompletionProvider>
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// std
+#include <atomic>
+#include <memory>
+
+class QThreadPool;
+
+/**
+ * @brief Class, that describes concurrent querying of
+ * several completion providers.
+ * @details Each request queries all providers in a thread
+ * pool. Their results are merged, without duplicates, and
+ * streamed back as each provider answers. A new request
+ * cancels the previous one: its pending results are
+ * dropped, and a provider still busy with it is queried
+ * again once it's done.
+ */
+class QCompletionEngine : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QCompletionEngine(QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Cancels the request and waits
+     * for the workers.
+     */
+    ~QCompletionEngine() override;
+
+    // Disable copying
+    QCompletionEngine(const QCompletionEngine &) = delete;
+    QCompletionEngine &operator=(const QCompletionEngine &) = delete;
+
+    /**
+     * @brief Method for adding a provider. The engine
+     * takes ownership of it.
+     */
+    void addProvider(QCompletionProvider *provider);
+
+    /**
+     * @brief Method for removing a provider. Cancels the
+     * request and waits for the workers, the caller takes
+     * ownership of the provider.
+     */
+    void removeProvider(QCompletionProvider *provider);
+
+    /**
+     * @brief Method for getting providers, in the order
+     * their results are merged.
+     */
+    QVector<QCompletionProvider *> providers() const;
+
+    /**
+     * @brief Method for querying all providers. The
+     * previous request is cancelled.
+     */
+    void request(const QCompletionProvider::Request &request);
+
+    /**
+     * @brief Method for cancelling the request. Results
+     * not merged yet are dropped.
+     */
+    void cancel();
+
+    /**
+     * @brief Method for getting the last request, an
+     * empty one after cancelling.
+     */
+    QCompletionProvider::Request currentRequest() const;
+
+    /**
+     * @brief Method for getting is a provider still
+     * answering the request.
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Method for getting results merged so far.
+     */
+    QStringList results() const;
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, a provider has answered the request.
+     * @param prefix Prefix of the request.
+     * @param results All results merged so far.
+     */
+    void resultsChanged(const QString &prefix, const QStringList &results);
+
+    /**
+     * @brief Signal, all providers have answered the
+     * request.
+     */
+    void finished(const QString &prefix);
+
+  private:
+    class Task;
+
+    /**
+     * @brief The Entry struct, Provider and its query.
+     */
+    struct Entry
+    {
+        Entry(QCompletionProvider *p = nullptr) : provider(p), running(false), pending(false)
+        {
+        }
+
+        QCompletionProvider *provider;
+
+        // Queried by a worker, maybe for an older request
+        bool running;
+
+        // To be queried once the running query is done
+        bool pending;
+    };
+
+    /**
+     * @brief Method for querying a provider with the
+     * current request.
+     */
+    void start(int index);
+
+    /**
+     * @brief Method for merging results of a provider.
+     * Called in the GUI thread.
+     */
+    void taskDone(QCompletionProvider *provider, int requestId, const QStringList &results);
+
+    /**
+     * @brief Method for getting index of the provider,
+     * -1 if it's been removed.
+     */
+    int indexOf(QCompletionProvider *provider) const;
+
+    QThreadPool *m_pool;
+    QVector<Entry> m_entries;
+
+    QCompletionProvider::Request m_request;
+    int m_requestId;
+    std::shared_ptr<std::atomic<bool>> m_cancelled;
+
+    // Providers, that haven't answered the request yet
+    int m_pendingCount;
+
+    QStringList m_results;
+    QSet<QString> m_merged;
+};
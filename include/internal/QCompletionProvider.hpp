@@ -0,0 +1,80 @@
+#pragma once
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QString>
+#include <QStringList>
+
+// std
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief Class, that describes a source of completions,
+ * which QCompletionEngine queries in a worker thread.
+ * @details `prepare` is called in the GUI thread right
+ * before each query, to copy the state `complete` needs,
+ * since `complete` runs concurrently with the editor and
+ * the other providers. A provider is never queried by
+ * two workers at once.
+ */
+class QCompletionProvider : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The Request struct, Word being completed
+     * and its context.
+     */
+    struct Request
+    {
+        Request(const QString &p = QString(), const QString &l = QString(), int c = 0)
+            : prefix(p), line(l), column(c), cancelled()
+        {
+        }
+
+        /**
+         * @brief Method for checking if the request is
+         * stale. Long queries should check it regularly
+         * and return early.
+         */
+        bool isCancelled() const
+        {
+            return cancelled && *cancelled;
+        }
+
+        QString prefix;
+
+        // Text of the line and column of the cursor in it
+        QString line;
+        int column;
+
+        // Set by the engine, when the prefix changes
+        std::shared_ptr<const std::atomic<bool>> cancelled;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QCompletionProvider(QObject *parent = nullptr);
+
+    // Disable copying
+    QCompletionProvider(const QCompletionProvider &) = delete;
+    QCompletionProvider &operator=(const QCompletionProvider &) = delete;
+
+    /**
+     * @brief Method for preparing a query. Called in the
+     * GUI thread, while the provider isn't queried.
+     */
+    virtual void prepare(const Request &request);
+
+    /**
+     * @brief Method for getting completions of the
+     * request. Called in a worker thread.
+     * @return Completions in any order, they're ranked
+     * by the editor.
+     */
+    virtual QStringList complete(const Request &request) = 0;
+};
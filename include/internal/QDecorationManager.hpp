@@ -0,0 +1,180 @@
+#pragma once
+
+// QCodeEditor
+#include <QTextChangeFilter>
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QString>
+#include <QStringList>
+#include <QTextCharFormat>
+#include <QVector>
+
+class QTextDocument;
+
+/**
+ * @brief Class, that describes named layers of text
+ * decorations (current line, occurrences, squiggles...).
+ * @details Each layer keeps its decorations as document
+ * offsets sorted by start, so decorations intersecting a
+ * range are found by binary search. Offsets follow the
+ * document edits. Changing a layer marks only that layer
+ * dirty, so the editor re-processes only what has changed.
+ */
+class QDecorationManager : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The Rendering enum, How the editor shows a layer.
+     */
+    enum class Rendering
+    {
+        // Background and underline are painted by the editor
+        // for the visible part only, foreground is ignored.
+        Painted,
+
+        // Passed to QTextEdit as extra selections, for the few
+        // decorations, that change the text format itself.
+        ExtraSelection
+    };
+
+    /**
+     * @brief The Decoration struct, Range [start, end] of
+     * document offsets.
+     * @note A decoration with the FullWidthSelection property
+     * covers the whole width of the line containing start.
+     */
+    struct Decoration
+    {
+        Decoration(int s = 0, int e = 0, const QTextCharFormat &f = QTextCharFormat(), const QString &tip = QString())
+            : start(s), end(e), format(f), toolTip(tip)
+        {
+        }
+
+        int start;
+        int end;
+        QTextCharFormat format;
+        QString toolTip;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param document Pointer to document, which edits
+     * decorations follow.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QDecorationManager(QTextDocument *document, QObject *parent = nullptr);
+
+    // Disable copying
+    QDecorationManager(const QDecorationManager &) = delete;
+    QDecorationManager &operator=(const QDecorationManager &) = delete;
+
+    /**
+     * @brief Method for adding a layer. Layers with bigger
+     * z are shown above. Does nothing if the layer exists.
+     */
+    void addLayer(const QString &name, int z, Rendering rendering = Rendering::Painted);
+
+    /**
+     * @brief Method for checking if the layer exists.
+     */
+    bool hasLayer(const QString &name) const;
+
+    /**
+     * @brief Method for getting layer names, bottom first.
+     */
+    QStringList layers() const;
+
+    /**
+     * @brief Method for getting how the layer is shown.
+     */
+    Rendering rendering(const QString &layer) const;
+
+    /**
+     * @brief Method for replacing all decorations of
+     * the layer.
+     */
+    void setDecorations(const QString &layer, QVector<Decoration> decorations);
+
+    /**
+     * @brief Method for adding a single decoration
+     * to the layer.
+     */
+    void addDecoration(const QString &layer, const Decoration &decoration);
+
+    /**
+     * @brief Method for removing all decorations of
+     * the layer.
+     */
+    void clear(const QString &layer);
+
+    /**
+     * @brief Method for getting number of decorations
+     * in the layer.
+     */
+    int count(const QString &layer) const;
+
+    /**
+     * @brief Method for getting all decorations of the
+     * layer, sorted by start.
+     */
+    QVector<Decoration> decorations(const QString &layer) const;
+
+    /**
+     * @brief Method for getting decorations of the layer,
+     * that intersect [from, to].
+     */
+    QVector<Decoration> decorations(const QString &layer, int from, int to) const;
+
+    /**
+     * @brief Method for taking the layers changed since the
+     * last call, bottom first. They are clean afterwards.
+     */
+    QStringList takeDirtyLayers();
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, decorations of the layer have been
+     * replaced, added or removed.
+     */
+    void layerChanged(const QString &layer);
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that moves decorations after an edit.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    struct Layer
+    {
+        Layer() : name(), z(0), rendering(Rendering::Painted), decorations(), maxLength(0), dirty(false)
+        {
+        }
+
+        QString name;
+        int z;
+        Rendering rendering;
+
+        // Sorted by start
+        QVector<Decoration> decorations;
+
+        // Upper bound of end - start, bounds the search for
+        // decorations starting before a range
+        int maxLength;
+
+        bool dirty;
+    };
+
+    Layer *findLayer(const QString &name);
+    const Layer *findLayer(const QString &name) const;
+
+    void markDirty(Layer *layer);
+
+    // Sorted by z
+    QVector<Layer> m_layers;
+
+    QTextChangeFilter m_changeFilter;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+// QCodeEditor
+#include <QGutterColumn>
+
+// Qt
+#include <QVector>
+
+/**
+ * @brief Class, that describes gutter column with
+ * markers of the lines having diagnostics.
+ * @details The diagnostics of the painted lines are
+ * queried once per paint and clipped to those lines,
+ * however many lines they span.
+ */
+class QDiagnosticColumn : public QGutterColumn
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param editor Pointer to editor.
+     */
+    explicit QDiagnosticColumn(QCodeEditor *editor);
+
+    int computeWidth() const override;
+
+    void beginPaint(const QTextBlock &first, const QTextBlock &last) override;
+
+    void paintRow(QPainter &painter, const QRect &rect, const QTextBlock &block, int blockNumber) override;
+
+  private:
+    int m_firstBlockNumber;
+
+    // Highest severity of each painted line, -1 for none
+    QVector<int> m_severities;
+};
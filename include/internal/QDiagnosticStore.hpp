@@ -0,0 +1,278 @@
+#pragma once
+
+// QCodeEditor
+#include <QCodeEditor>
+#include <QPositionMapper>
+#include <QTextChangeFilter>
+
+// Qt
+#include <QHash>
+#include <QObject> // Required for inheritance
+#include <QString>
+#include <QVector>
+
+class QTextDocument;
+
+/**
+ * @brief Class, that describes storage of the diagnostics
+ * (squiggles) of a document.
+ * @details Diagnostics are kept as document offsets in a
+ * treap ordered by start, where every node knows the biggest
+ * end in its subtree. Diagnostics intersecting a range are
+ * found in O(log n + k). An edit shifts everything after it
+ * with a single lazy offset, so it costs O(log n) plus the
+ * diagnostics touching the changed text, and diagnostics
+ * stay anchored to their text without being re-published.
+ *
+ * Every text change increases the version. Diagnostics may
+ * be given for an older version: their offsets are mapped
+ * through the edits made since then, as long as it's one of
+ * the last `MaxJournalSize` versions. Edits also remember
+ * the lines they replaced, so line/column positions of an
+ * older version are mapped the same way.
+ */
+class QDiagnosticStore : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Number of recent edits, which diagnostics for
+     * older versions are mapped through.
+     */
+    static constexpr int MaxJournalSize = 1024;
+
+    /**
+     * @brief The Range struct, Diagnostic covering
+     * document offsets [start, end].
+     * @note Diagnostics with id -1 can't be removed
+     * one by one.
+     */
+    struct Range
+    {
+        Range(int s = 0, int e = 0, QCodeEditor::SeverityLevel l = QCodeEditor::SeverityLevel::Error,
+              const QString &m = QString(), int i = -1)
+            : start(s), end(e), level(l), message(m), id(i)
+        {
+        }
+
+        int start;
+        int end;
+        QCodeEditor::SeverityLevel level;
+        QString message;
+        int id;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param document Pointer to document, which edits
+     * diagnostics follow.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QDiagnosticStore(QTextDocument *document, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor.
+     */
+    ~QDiagnosticStore() override;
+
+    // Disable copying
+    QDiagnosticStore(const QDiagnosticStore &) = delete;
+    QDiagnosticStore &operator=(const QDiagnosticStore &) = delete;
+
+    /**
+     * @brief Method for getting the version of the text.
+     * It's increased by every text change.
+     */
+    int version() const;
+
+    /**
+     * @brief Method for checking if positions of the
+     * version can still be mapped to the current text.
+     * @param version Version, -1 for the current one.
+     */
+    bool isMappable(int version) const;
+
+    /**
+     * @brief Method for mapping a line/column position
+     * of the version to the current text. Columns are in
+     * UTF-16 code units, positions in text removed since
+     * then move to the start of the removal.
+     * @param version Version the position is given for,
+     * -1 for the current one. Must be mappable.
+     */
+    QPositionMapper::Position mapPosition(QPositionMapper::Position position, int version) const;
+
+    /**
+     * @brief Method for replacing all diagnostics.
+     * Costs O(n log n) once, instead of an insertion
+     * per diagnostic.
+     * @param version Version the offsets are given for,
+     * -1 for the current one.
+     * @return false if the version is too old, nothing
+     * is changed then.
+     */
+    bool setDiagnostics(QVector<Range> ranges, int version = -1);
+
+    /**
+     * @brief Method for changing some of the diagnostics.
+     * Diagnostics with the removed ids are removed first,
+     * added ones replace diagnostics with the same id.
+     * Costs O(log n) per changed diagnostic.
+     * @param version Version the offsets are given for,
+     * -1 for the current one.
+     * @return false if the version is too old, nothing
+     * is changed then.
+     */
+    bool updateDiagnostics(const QVector<Range> &added, const QVector<int> &removedIds, int version = -1);
+
+    /**
+     * @brief Method for adding a single diagnostic.
+     */
+    void addDiagnostic(const Range &range);
+
+    /**
+     * @brief Method for removing all diagnostics.
+     */
+    void clear();
+
+    /**
+     * @brief Method for getting number of diagnostics.
+     */
+    int count() const;
+
+    /**
+     * @brief Method for getting all diagnostics,
+     * sorted by start.
+     */
+    QVector<Range> diagnostics() const;
+
+    /**
+     * @brief Method for getting diagnostics, that
+     * intersect [from, to], sorted by start.
+     */
+    QVector<Range> diagnostics(int from, int to) const;
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, diagnostics have been replaced,
+     * added or removed.
+     */
+    void changed();
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that moves diagnostics after an edit.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    struct Node
+    {
+        explicit Node(const Range &r)
+            : range(r), priority(0), shift(0), maxEnd(r.end), left(nullptr), right(nullptr), parent(nullptr)
+        {
+        }
+
+        Range range;
+        quint32 priority;
+
+        // Offset not yet added to the children
+        int shift;
+
+        // Biggest end in the subtree
+        int maxEnd;
+
+        Node *left;
+        Node *right;
+        Node *parent;
+    };
+
+    struct Edit
+    {
+        Edit(int p = 0, int r = 0, int a = 0)
+            : position(p), charsRemoved(r), charsAdded(a), start(), removedEnd(), addedEnd()
+        {
+        }
+
+        int position;
+        int charsRemoved;
+        int charsAdded;
+
+        // Line/column positions of the edit, ends are before and after it
+        QPositionMapper::Position start;
+        QPositionMapper::Position removedEnd;
+        QPositionMapper::Position addedEnd;
+    };
+
+    static int map(int offset, const Edit &edit);
+    static QPositionMapper::Position map(const QPositionMapper::Position &position, const Edit &edit);
+
+    static void shift(Node *node, int delta);
+    static void push(Node *node);
+    static void pull(Node *node);
+    static void pullAll(Node *node);
+    static Node *merge(Node *a, Node *b);
+
+    /**
+     * @brief Method for splitting into nodes starting
+     * before position and the rest.
+     */
+    static void split(Node *node, int position, Node *&left, Node *&right);
+
+    static void destroy(Node *node);
+
+    /**
+     * @brief Method for collecting ranges intersecting
+     * [from, to], `offset` is the pending shift of the
+     * ancestors.
+     */
+    static void collect(const Node *node, int from, int to, int offset, QVector<Range> &result);
+
+    /**
+     * @brief Method for mapping ends of the nodes reaching
+     * `position`, all of them start before it.
+     */
+    static void mapEnds(Node *node, int position, const Edit &edit);
+
+    /**
+     * @brief Method for mapping both offsets of all nodes.
+     */
+    static void mapAll(Node *node, const Edit &edit);
+
+    /**
+     * @brief Method for mapping offset through the edits
+     * made since the version.
+     */
+    int mapOffset(int offset, int version) const;
+
+    /**
+     * @brief Method for filling line/column positions of
+     * the edit and updating the line lengths.
+     */
+    void mapLines(Edit &edit);
+
+    void indexLines();
+
+    Node *createNode(const Range &range);
+    void insertNode(Node *node);
+    void removeNode(Node *node);
+
+    QTextDocument *m_document;
+
+    Node *m_root;
+    int m_count;
+    quint32 m_seed;
+
+    QHash<int, Node *> m_ids;
+
+    int m_version;
+
+    // Edits leading to the current version, oldest first
+    QVector<Edit> m_journal;
+
+    // Lengths of the lines before the next edit, without separators
+    QVector<int> m_lineLengths;
+
+    QTextChangeFilter m_changeFilter;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+// Qt
+#include <QByteArray>
+#include <QString>
+
+/**
+ * @brief Class, that describes conversion between file
+ * bytes and document text.
+ * @details Decoding detects the encoding, validates UTF-8,
+ * converts to UTF-16, normalises line breaks to '\n' and
+ * counts the original line break styles, all in a single
+ * pass. The lines are indexed by the blocks of the
+ * document the text is inserted into.
+ * Pure ASCII runs without line breaks are converted
+ * 16 bytes at a time with SSE2 where available.
+ */
+class QDocumentCodec
+{
+  public:
+    /**
+     * @brief The Encoding enum
+     */
+    enum class Encoding
+    {
+        Utf8,
+        Utf8Bom,
+        Utf16LE,
+        Utf16BE,
+        Latin1
+    };
+
+    /**
+     * @brief The LineEnding enum
+     */
+    enum class LineEnding
+    {
+        LF,
+        CRLF,
+        CR
+    };
+
+    /**
+     * @brief The DecodeResult struct, Result of decoding.
+     */
+    struct DecodeResult
+    {
+        DecodeResult() : text(), invalidSequences(0), lf(0), crlf(0), cr(0)
+        {
+        }
+
+        QString text;
+
+        // Number of malformed sequences replaced by U+FFFD
+        int invalidSequences;
+
+        // Number of line breaks of each style
+        int lf, crlf, cr;
+    };
+
+    /**
+     * @brief Static method for detecting encoding. A BOM wins,
+     * otherwise the data is UTF-8 if it's valid UTF-8 (an
+     * incomplete sequence at the very end is tolerated, so a
+     * prefix of a file can be passed) and Latin-1 if it's not.
+     * @param data Beginning of the file.
+     */
+    static Encoding detectEncoding(const QByteArray &data);
+
+    /**
+     * @brief Static method for getting length of the BOM
+     * written for the encoding.
+     */
+    static int bomLength(Encoding encoding);
+
+    /**
+     * @brief Static method for checking UTF-8 validity.
+     * @param allowTruncated Whether an incomplete sequence
+     * at the end is considered valid.
+     */
+    static bool isValidUtf8(const char *data, int size, bool allowTruncated = false);
+
+    /**
+     * @brief Static method for finding where to cut data
+     * into chunks of whole lines.
+     * @param from Offset to search from, the data before
+     * it is known to have no line break.
+     * @return Offset after the last line break, 0 if there
+     * is no line break.
+     */
+    static int lastLineBreak(const QByteArray &data, Encoding encoding, int from = 0);
+
+    /**
+     * @brief Static method for decoding data without BOM.
+     */
+    static DecodeResult decode(const char *data, int size, Encoding encoding);
+
+    /**
+     * @brief Static method for getting the prevailing line
+     * break style. LF if there are no line breaks.
+     */
+    static LineEnding dominantLineEnding(int lf, int crlf, int cr);
+
+    /**
+     * @brief Static method for encoding document text,
+     * converting '\n' to the requested line break and
+     * prepending a BOM if the encoding has one.
+     */
+    static QByteArray encode(const QString &text, Encoding encoding, LineEnding lineEnding);
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+// Qt
+#include <QFile>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Class, that describes a read-only memory mapped
+ * file with a sparse index of line start offsets.
+ * @details The file is never copied into memory. Building
+ * the index scans the mapping once for '\n' (vectorised,
+ * split over several threads for big files) and keeps the
+ * start offset of only every `CheckpointInterval`-th line,
+ * so the memory cost of the index stays small even for
+ * multi-gigabyte files.
+ */
+class QFileLineIndex
+{
+  public:
+    /**
+     * @brief Distance in lines between two stored line
+     * start offsets.
+     */
+    static constexpr int CheckpointInterval = 256;
+
+    /**
+     * @brief Constructor.
+     */
+    QFileLineIndex();
+
+    /**
+     * @brief Destructor. Unmaps the file.
+     */
+    ~QFileLineIndex();
+
+    // Disable copying
+    QFileLineIndex(const QFileLineIndex &) = delete;
+    QFileLineIndex &operator=(const QFileLineIndex &) = delete;
+
+    /**
+     * @brief Method for mapping a file and building its
+     * line index.
+     * @param path Path to the file.
+     * @return Success.
+     */
+    bool open(const QString &path);
+
+    /**
+     * @brief Method for unmapping the current file.
+     */
+    void close();
+
+    /**
+     * @brief Method for getting is a file mapped.
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Method for getting file size in bytes.
+     */
+    qint64 size() const;
+
+    /**
+     * @brief Method for getting number of lines.
+     * A file ending with a line break has an empty last line,
+     * just like QTextDocument.
+     */
+    qint64 lineCount() const;
+
+    /**
+     * @brief Method for getting byte offset of line start.
+     * @param line Line number in 0-based indexing.
+     * @return Offset or -1 if line is out of range.
+     */
+    qint64 lineStart(qint64 line) const;
+
+    /**
+     * @brief Method for getting byte offset of the line
+     * start following the line starting at `offset`.
+     * @return Offset after the line break or `size() + 1`
+     * if this is the last line.
+     */
+    qint64 nextLineStart(qint64 offset) const;
+
+    /**
+     * @brief Method for getting line text, decoded from
+     * UTF-8 without its line break.
+     * @param lineNumber Line number in 0-based indexing.
+     * @param maxLength Maximum number of bytes to decode.
+     */
+    QString line(qint64 lineNumber, int maxLength = 4096) const;
+
+    /**
+     * @brief Method for decoding raw bytes between two
+     * offsets, stripping a trailing line break.
+     */
+    QString text(qint64 from, qint64 to, int maxLength = 4096) const;
+
+    /**
+     * @brief Method for getting mapped data.
+     */
+    const uchar *data() const;
+
+    /**
+     * @brief Method for getting approximate heap memory
+     * used by the index in bytes.
+     */
+    qint64 memoryCost() const;
+
+  private:
+    QFile m_file;
+
+    uchar *m_data;
+
+    qint64 m_size;
+
+    qint64 m_lineCount;
+
+    // Pairs of line number and its start offset, sorted by line number
+    QVector<QPair<qint64, qint64>> m_checkpoints;
+};
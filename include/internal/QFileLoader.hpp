@@ -0,0 +1,112 @@
+#pragma once
+
+// QCodeEditor
+#include <QDocumentCodec>
+
+// Qt
+#include <QByteArray>
+#include <QFile>
+#include <QObject> // Required for inheritance
+#include <QString>
+
+// std
+#include <atomic>
+
+/**
+ * @brief Class, that describes worker reading and decoding
+ * a file chunk by chunk. It's meant to live in a worker
+ * thread and to be driven by queued `readChunk` calls,
+ * so that at most one decoded chunk is in flight.
+ * The encoding is detected from the first chunk, malformed
+ * sequences found later are replaced and counted.
+ */
+class QFileLoader : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param path Path to the file.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QFileLoader(const QString &path, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor.
+     */
+    ~QFileLoader() override;
+
+    // Disable copying
+    QFileLoader(const QFileLoader &) = delete;
+    QFileLoader &operator=(const QFileLoader &) = delete;
+
+    /**
+     * @brief Method for cancelling the loading. May be
+     * called from any thread.
+     */
+    void cancel();
+
+    /**
+     * @brief Method for getting is loading cancelled.
+     */
+    bool isCancelled() const;
+
+    /**
+     * @brief Method for getting detected encoding.
+     * Valid after `finished` has been emitted.
+     */
+    QDocumentCodec::Encoding encoding() const;
+
+    /**
+     * @brief Method for getting prevailing line break
+     * style of the file. Valid after `finished` has been
+     * emitted.
+     */
+    QDocumentCodec::LineEnding lineEnding() const;
+
+    /**
+     * @brief Method for getting number of malformed
+     * sequences replaced while decoding.
+     */
+    int invalidSequences() const;
+
+  public Q_SLOTS:
+    /**
+     * @brief Slot, that reads and decodes the next chunk.
+     * The chunk is cut after the last line break, the rest
+     * is carried over to the next chunk, so the cut never
+     * splits a character or a CRLF pair.
+     * @param maxBytes Number of bytes to read.
+     */
+    void readChunk(int maxBytes);
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, a chunk of whole lines has been decoded.
+     * @param text Decoded text, line breaks are '\n'.
+     * @param bytesRead Number of bytes read so far.
+     * @param bytesTotal File size.
+     */
+    void chunkRead(const QString &text, qint64 bytesRead, qint64 bytesTotal);
+
+    /**
+     * @brief Signal, the file has been read completely or
+     * couldn't be opened.
+     */
+    void finished(bool success);
+
+  private:
+    QFile m_file;
+
+    // Bytes after the last line break of the previous chunk
+    QByteArray m_carry;
+
+    bool m_encodingDetected;
+    QDocumentCodec::Encoding m_encoding;
+
+    int m_lf, m_crlf, m_cr;
+    int m_invalidSequences;
+
+    std::atomic<bool> m_cancelled;
+};
@@ -0,0 +1,307 @@
+#pragma once
+
+// QCodeEditor
+#include <QTextChangeFilter>
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QRegularExpression>
+#include <QString>
+#include <QVector>
+
+// std
+#include <atomic>
+#include <memory>
+
+class QTextDocument;
+class QThreadPool;
+class QTrigramIndex;
+class QTimer;
+
+/**
+ * @brief Class, that describes search of all matches of a
+ * pattern in a document, run in the background.
+ * @details A search runs on a snapshot of the text, split
+ * into chunks of whole lines, which are searched in
+ * parallel by a thread pool. Hits of a chunk are streamed
+ * back as soon as it's done, tagged with the revision of
+ * the searched text. Patterns, which may match a line
+ * break, are searched as a single chunk. Edits move the
+ * found hits along with the text (a single offset per
+ * chunk after the edit) and the search is run again once
+ * typing pauses, a search still running for an older
+ * revision is cancelled.
+ *
+ * With a built trigram index, only the lines containing
+ * the text (or the longest plain run of the expression)
+ * are copied and searched, each line on its own. Patterns
+ * matching line breaks search the whole text instead.
+ */
+class QFindEngine : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The Options struct, How the pattern is matched.
+     */
+    struct Options
+    {
+        Options(bool cs = false, bool ww = false, bool re = false)
+            : caseSensitive(cs), wholeWords(ww), regularExpression(re)
+        {
+        }
+
+        bool caseSensitive;
+        bool wholeWords;
+
+        // Pattern is a regular expression instead of plain text
+        bool regularExpression;
+    };
+
+    /**
+     * @brief The Hit struct, Match covering document
+     * offsets [start, start + length).
+     */
+    struct Hit
+    {
+        Hit(int s = 0, int l = 0) : start(s), length(l)
+        {
+        }
+
+        int start;
+        int length;
+    };
+
+    /**
+     * @brief Constructor.
+     * @param document Pointer to searched document.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QFindEngine(QTextDocument *document, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Cancels the search and waits for
+     * the workers.
+     */
+    ~QFindEngine() override;
+
+    // Disable copying
+    QFindEngine(const QFindEngine &) = delete;
+    QFindEngine &operator=(const QFindEngine &) = delete;
+
+    /**
+     * @brief Static method for getting expression matching
+     * the pattern with the options.
+     * @return Expression, invalid if the pattern is not a
+     * valid regular expression.
+     */
+    static QRegularExpression regularExpression(const QString &pattern, const Options &options = Options());
+
+    /**
+     * @brief Static method for checking if matches of the
+     * pattern may contain a line break, as far as it can
+     * be told without parsing the expression.
+     * @return false only if no match spans lines.
+     */
+    static bool canMatchLineBreak(const QString &pattern, const Options &options = Options());
+
+    /**
+     * @brief Method for starting search of all matches of
+     * the pattern. Hits of the previous search are dropped.
+     * @return false if the pattern is empty or not a valid
+     * regular expression, nothing is searched then.
+     */
+    bool start(const QString &pattern, const Options &options = Options());
+
+    /**
+     * @brief Method for cancelling the search and dropping
+     * all hits.
+     */
+    void clear();
+
+    /**
+     * @brief Method for setting index narrowing the lines
+     * to search. It's used once it's built.
+     * @param index Pointer to trigram index of the
+     * document, may be nullptr.
+     */
+    void setTrigramIndex(QTrigramIndex *index);
+
+    /**
+     * @brief Method for getting index narrowing the lines
+     * to search.
+     */
+    QTrigramIndex *trigramIndex() const;
+
+    /**
+     * @brief Method for getting searched pattern, empty
+     * if there is no search.
+     */
+    QString pattern() const;
+
+    /**
+     * @brief Method for getting options of the search.
+     */
+    Options options() const;
+
+    /**
+     * @brief Method for getting revision of the text.
+     * It's increased by every text change.
+     */
+    int revision() const;
+
+    /**
+     * @brief Method for getting is a search running.
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Method for getting number of hits found.
+     */
+    int count() const;
+
+    /**
+     * @brief Method for getting all hits, sorted by start.
+     */
+    QVector<Hit> hits() const;
+
+    /**
+     * @brief Method for getting hits starting in [from, to],
+     * sorted by start. The cost depends on the range and
+     * the number of chunks, not on the number of hits.
+     */
+    QVector<Hit> hits(int from, int to) const;
+
+    /**
+     * @brief Method for getting the first hit starting
+     * after the position, or the last one starting before
+     * it. The search wraps around the document.
+     * @return Hit, with length 0 if there is none.
+     */
+    Hit nextHit(int position, bool backward = false) const;
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, a chunk has been searched.
+     * @param revision Revision of the searched text.
+     * @param hits Hits of the chunk, sorted by start.
+     */
+    void hitsAdded(int revision, const QVector<QFindEngine::Hit> &hits);
+
+    /**
+     * @brief Signal, all hits have been replaced or
+     * dropped.
+     */
+    void hitsReset(int revision);
+
+    /**
+     * @brief Signal, the search has been completed.
+     * @param count Number of hits.
+     */
+    void finished(int revision, int count);
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that moves the hits after an edit and
+     * schedules the search of the new text.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief Slot, that searches the current text again.
+     */
+    void refresh();
+
+  private:
+    class Task;
+
+    /**
+     * @brief The Chunk struct, Lines [start, end) of the
+     * snapshot and their hits. Offsets after an edit are
+     * moved by `shift`.
+     */
+    struct Chunk
+    {
+        Chunk(int s = 0, int e = 0) : start(s), end(e), shift(0), hits()
+        {
+        }
+
+        int start;
+        int end;
+        int shift;
+        QVector<Hit> hits;
+    };
+
+    /**
+     * @brief The Run struct, State shared with the workers
+     * of a search. The text isn't changed once the workers
+     * are started.
+     */
+    struct Run
+    {
+        Run(int i, const QRegularExpression &re)
+            : id(i), snapshot(), positions(), lines(), regex(re), cancelled(false)
+        {
+        }
+
+        int id;
+
+        // Whole text, or the candidate lines and their positions
+        QString snapshot;
+        QVector<int> positions;
+        QVector<QString> lines;
+
+        const QRegularExpression regex;
+        std::atomic<bool> cancelled;
+    };
+
+    /**
+     * @brief Method for searching the current text in
+     * the background.
+     * @param streamed Whether hits are shown as chunks are
+     * done, or all at once, when the search is completed.
+     */
+    void run(bool streamed);
+
+    /**
+     * @brief Method for cancelling the running search.
+     */
+    void cancel();
+
+    /**
+     * @brief Method for taking hits of a searched chunk.
+     * Called in the GUI thread.
+     */
+    void chunkDone(int runId, int index, const QVector<Hit> &hits);
+
+    /**
+     * @brief Method for getting index of the chunk
+     * containing the offset.
+     */
+    int chunkAt(int offset) const;
+
+    QTextDocument *m_document;
+    QThreadPool *m_pool;
+    QTimer *m_refreshTimer;
+    QTrigramIndex *m_trigramIndex;
+
+    QString m_pattern;
+    Options m_options;
+    QRegularExpression m_regex;
+
+    int m_revision;
+    QTextChangeFilter m_changeFilter;
+
+    std::shared_ptr<Run> m_run;
+    int m_nextRunId;
+    bool m_streamed;
+
+    // Chunks of the running search, until they're shown
+    QVector<Chunk> m_pendingChunks;
+    int m_pendingCount;
+
+    // Shown hits, per chunk
+    QVector<Chunk> m_chunks;
+    int m_count;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+// QCodeEditor
+#include <QGutterColumn>
+
+/**
+ * @brief Class, that describes gutter column with
+ * markers of the foldable regions. Clicking a marker
+ * folds or unfolds its region.
+ */
+class QFoldColumn : public QGutterColumn
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param editor Pointer to editor.
+     */
+    explicit QFoldColumn(QCodeEditor *editor);
+
+    int computeWidth() const override;
+
+    void paintRow(QPainter &painter, const QRect &rect, const QTextBlock &block, int blockNumber) override;
+
+    bool mousePressed(const QTextBlock &block, QMouseEvent *event) override;
+};
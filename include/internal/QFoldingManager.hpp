@@ -0,0 +1,128 @@
+#pragma once
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QTextBlock>
+
+class QScopeTree;
+class QTextDocument;
+
+/**
+ * @brief Class, that describes folding of the regions
+ * of a document.
+ * @details A region is the scope opened by its header
+ * block, without the header and the closing line.
+ * Folded blocks are made invisible, so the layout skips
+ * them entirely. The folded state is kept in the header
+ * block, so it moves along with the header when the text
+ * is edited, and the hidden blocks are recomputed around
+ * the edit.
+ */
+class QFoldingManager : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param document Pointer to folded document.
+     * @param scopes Pointer to scope tree of the document,
+     * which gives the regions.
+     * @param parent Pointer to parent QObject.
+     */
+    QFoldingManager(QTextDocument *document, QScopeTree *scopes, QObject *parent = nullptr);
+
+    // Disable copying
+    QFoldingManager(const QFoldingManager &) = delete;
+    QFoldingManager &operator=(const QFoldingManager &) = delete;
+
+    /**
+     * @brief Method for checking if a region starts
+     * after the block.
+     */
+    bool isFoldable(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for getting last block of the region
+     * starting after the block.
+     * @return Block, invalid if there is no region.
+     */
+    QTextBlock regionEnd(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for checking if the region starting
+     * after the block is folded.
+     */
+    bool isFolded(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for folding the region starting after
+     * the block.
+     */
+    void fold(const QTextBlock &block);
+
+    /**
+     * @brief Method for unfolding the region starting
+     * after the block. Nested folded regions stay folded.
+     */
+    void unfold(const QTextBlock &block);
+
+    /**
+     * @brief Method for folding or unfolding the region
+     * starting after the block.
+     */
+    void toggleFold(const QTextBlock &block);
+
+    /**
+     * @brief Method for folding all regions.
+     */
+    void foldAll();
+
+    /**
+     * @brief Method for unfolding all regions.
+     */
+    void unfoldAll();
+
+    /**
+     * @brief Method for unfolding the regions hiding
+     * the block.
+     */
+    void reveal(const QTextBlock &block);
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, blocks have been hidden or shown.
+     */
+    void foldingChanged();
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that recomputes hidden blocks around
+     * the change.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    /**
+     * @brief Method for making visibility of the blocks
+     * from the block to at least the last one match the
+     * folded regions, and relaying them out.
+     */
+    void applyFolds(QTextBlock block, int lastBlockNumber);
+
+    /**
+     * @brief Method for setting folded state of the block.
+     */
+    void setFolded(const QTextBlock &block, bool folded);
+
+    /**
+     * @brief Method for relaying out blocks [first, last]
+     * after their visibility changed. Unlike marking the
+     * contents dirty, it doesn't look like an edit to the
+     * highlighter and the indices.
+     */
+    void relayout(const QTextBlock &first, const QTextBlock &last);
+
+    QTextDocument *m_document;
+    QScopeTree *m_scopes;
+};
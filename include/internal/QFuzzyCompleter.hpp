@@ -0,0 +1,98 @@
+#pragma once
+
+// Qt
+#include <QCompleter> // Required for inheritance
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QStringListModel;
+
+/**
+ * @brief Class, that describes completer ranking its
+ * candidates by fuzzy match with the typed prefix.
+ * @details The prefix has to be a subsequence of a
+ * candidate, ignoring case, starting at one of its
+ * words (`gvi` matches `getValueIndex` and `get_value_id`).
+ * Matches at word starts, consecutive matches and
+ * matching case score higher. The candidates are indexed
+ * by the first letters of their words, so only the ones
+ * with a word starting like the prefix are scored; while
+ * the prefix grows, only the previous matches are. Just
+ * the best ones are passed to the popup, unfiltered.
+ */
+class QFuzzyCompleter : public QCompleter
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QFuzzyCompleter(QObject *parent = nullptr);
+
+    // Disable copying
+    QFuzzyCompleter(const QFuzzyCompleter &) = delete;
+    QFuzzyCompleter &operator=(const QFuzzyCompleter &) = delete;
+
+    /**
+     * @brief Static method for scoring the match of the
+     * pattern with the candidate.
+     * @return Score, bigger is better, -1 if they don't
+     * match.
+     */
+    static int score(const QString &pattern, const QString &candidate);
+
+    /**
+     * @brief Method for setting completed words.
+     * Duplicates are dropped.
+     */
+    void setCandidates(const QStringList &candidates);
+
+    /**
+     * @brief Method for getting completed words.
+     */
+    QStringList candidates() const;
+
+    /**
+     * @brief Method for setting number of results shown
+     * at most.
+     * Default: 100
+     */
+    void setMaxResults(int count);
+
+    /**
+     * @brief Method for getting number of results shown
+     * at most.
+     */
+    int maxResults() const;
+
+    /**
+     * @brief Method for ranking the candidates matching
+     * the prefix and showing the best ones. It also sets
+     * the completion prefix.
+     */
+    void filter(const QString &prefix);
+
+  private:
+    /**
+     * @brief Static method for checking if a word starts
+     * at the index: after a separator, at a capital after
+     * a lowercase letter, or at the beginning.
+     */
+    static bool isWordStart(const QString &text, int index);
+
+    QStringList m_candidates;
+
+    // Candidates by the case folded first letters of their words
+    QHash<QChar, QVector<int>> m_wordStarts;
+
+    // Filtered pattern and the candidates it matches, unranked
+    QString m_pattern;
+    QVector<int> m_matches;
+
+    int m_maxResults;
+    QStringListModel *m_model;
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QString>
+
+class QCodeEditor;
+class QMouseEvent;
+class QPainter;
+class QRect;
+class QTextBlock;
+
+/**
+ * @brief Class, that describes a column of the line
+ * number area (gutter), e.g. line numbers, diagnostic
+ * markers or fold markers.
+ * @details The width is computed only when the column
+ * says it has changed, rows are painted one by one and
+ * only for the damaged part of the gutter.
+ */
+class QGutterColumn : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param name Name the column is found by.
+     * @param editor Pointer to editor, which gutter shows
+     * the column.
+     */
+    QGutterColumn(const QString &name, QCodeEditor *editor);
+
+    // Disable copying
+    QGutterColumn(const QGutterColumn &) = delete;
+    QGutterColumn &operator=(const QGutterColumn &) = delete;
+
+    /**
+     * @brief Method for getting name of the column.
+     */
+    QString name() const;
+
+    /**
+     * @brief Method for getting editor of the column.
+     */
+    QCodeEditor *editor() const;
+
+    /**
+     * @brief Method for computing width of the column.
+     * The result is cached until `widthChanged` is emitted
+     * or the font changes.
+     */
+    virtual int computeWidth() const = 0;
+
+    /**
+     * @brief Method called before the rows of
+     * [first, last] blocks are painted, e.g. to query
+     * data for all of them at once.
+     */
+    virtual void beginPaint(const QTextBlock &first, const QTextBlock &last);
+
+    /**
+     * @brief Method for painting the first line of the
+     * block.
+     * @param rect Rectangle of the row in this column.
+     * @param blockNumber Number of the block.
+     */
+    virtual void paintRow(QPainter &painter, const QRect &rect, const QTextBlock &block, int blockNumber) = 0;
+
+    /**
+     * @brief Method for handling a click in the row
+     * of the block.
+     * @return If the event has been handled.
+     */
+    virtual bool mousePressed(const QTextBlock &block, QMouseEvent *event);
+
+    /**
+     * @brief Method called when the syntax style or
+     * the font changes, to drop cached rendering.
+     */
+    virtual void styleChanged();
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, the width has to be computed again.
+     */
+    void widthChanged();
+
+    /**
+     * @brief Signal, the column has to be repainted.
+     */
+    void updateRequest();
+
+  private:
+    QString m_name;
+    QCodeEditor *m_editor;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+// QCodeEditor
+#include <QCompletionProvider> // Required for inheritance
+
+// Qt
+#include <QStringList>
+
+class QLanguage;
+
+/**
+ * @brief Class, that describes completion provider of
+ * a fixed list of words, like keywords of a language.
+ */
+class QKeywordProvider : public QCompletionProvider
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param keywords Completed words.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QKeywordProvider(const QStringList &keywords, QObject *parent = nullptr);
+
+    /**
+     * @brief Constructor.
+     * @param language Language, whose names of all keys
+     * are completed.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QKeywordProvider(QLanguage *language, QObject *parent = nullptr);
+
+    // Disable copying
+    QKeywordProvider(const QKeywordProvider &) = delete;
+    QKeywordProvider &operator=(const QKeywordProvider &) = delete;
+
+    /**
+     * @brief Method for getting completed words.
+     */
+    QStringList keywords() const;
+
+    QStringList complete(const Request &request) override;
+
+  private:
+    // Not changed after construction, so it's read by workers without locking
+    QStringList m_keywords;
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+// QCodeEditor
+#include <QFileLineIndex>
+
+// Qt
+#include <QAbstractScrollArea> // Required for inheritance
+#include <QStringList>
+#include <QTextLayout>
+#include <QVector>
+
+class QStyleSyntaxHighlighter;
+class QSyntaxStyle;
+class QTextDocument;
+class QTimer;
+
+/**
+ * @brief Class, that describes read-only viewer for
+ * files too big to be loaded into a QTextDocument.
+ * @details The file is memory mapped by QFileLineIndex.
+ * Only the lines in (and around) the viewport are decoded
+ * and highlighted, in a small scratch document. The
+ * highlighter state at every `StateCheckpointInterval`-th
+ * line is cached, so multi-line constructs (block comments,
+ * multi-line strings) are highlighted correctly without
+ * re-highlighting the file from the top on every scroll.
+ */
+class QLargeFileViewer : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Distance in lines between two cached
+     * highlighter states.
+     */
+    static constexpr int StateCheckpointInterval = 512;
+
+    /**
+     * @brief Constructor.
+     * @param widget Pointer to parent widget.
+     */
+    explicit QLargeFileViewer(QWidget *widget = nullptr);
+
+    // Disable copying
+    QLargeFileViewer(const QLargeFileViewer &) = delete;
+    QLargeFileViewer &operator=(const QLargeFileViewer &) = delete;
+
+    /**
+     * @brief Method for opening a file.
+     * @param path Path to the file.
+     * @return Success.
+     */
+    bool openFile(const QString &path);
+
+    /**
+     * @brief Method for closing the current file.
+     */
+    void closeFile();
+
+    /**
+     * @brief Method for getting line index of the
+     * opened file.
+     */
+    const QFileLineIndex &lineIndex() const;
+
+    /**
+     * @brief Method for setting highlighter. The highlighter
+     * is attached to an internal scratch document.
+     * @param highlighter Pointer to syntax highlighter.
+     */
+    void setHighlighter(QStyleSyntaxHighlighter *highlighter);
+
+    /**
+     * @brief Method for setting syntax style.
+     * @param style Pointer to syntax style.
+     */
+    void setSyntaxStyle(QSyntaxStyle *style);
+
+    /**
+     * @brief Method for getting first visible line.
+     * @return Line number in 0-based indexing.
+     */
+    qint64 firstVisibleLine() const;
+
+    /**
+     * @brief Method for scrolling the line to the
+     * top of the viewport.
+     * @param line Line number in 0-based indexing.
+     */
+    void scrollToLine(qint64 line);
+
+  protected:
+    /**
+     * @brief Method, that paints the visible lines and
+     * line numbers.
+     */
+    void paintEvent(QPaintEvent *e) override;
+
+    /**
+     * @brief Method, that updates scroll bar ranges.
+     */
+    void resizeEvent(QResizeEvent *e) override;
+
+    /**
+     * @brief Method, that resets cached metrics when
+     * the font changes.
+     */
+    void changeEvent(QEvent *e) override;
+
+    /**
+     * @brief Method, that provides keyboard navigation.
+     */
+    void keyPressEvent(QKeyEvent *e) override;
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that computes some more highlighter
+     * state checkpoints towards the requested line.
+     */
+    void advanceStateCheckpoints();
+
+  private:
+    /**
+     * @brief Method for updating scroll bar ranges.
+     */
+    void updateScrollBars();
+
+    /**
+     * @brief Method for getting number of lines fitting
+     * into the viewport.
+     */
+    int visibleLineCount() const;
+
+    /**
+     * @brief Method for getting width of line number area.
+     */
+    int gutterWidth() const;
+
+    /**
+     * @brief Method for dropping highlighted window
+     * and state checkpoints.
+     */
+    void invalidateHighlighting();
+
+    /**
+     * @brief Method for making sure lines [first, first + count)
+     * are decoded and highlighted.
+     */
+    void ensureWindow(qint64 first, int count);
+
+    /**
+     * @brief Method for highlighting lines in the scratch
+     * document.
+     * @param lines Lines to highlight.
+     * @param previousState Highlighter state before first line.
+     * @param formats Output formats per line. May be nullptr.
+     * @return Highlighter state after each line.
+     */
+    QVector<int> highlightLines(const QStringList &lines, int previousState,
+                                QVector<QVector<QTextLayout::FormatRange>> *formats);
+
+    QFileLineIndex m_index;
+
+    QStyleSyntaxHighlighter *m_highlighter;
+    QSyntaxStyle *m_syntaxStyle;
+
+    QTextDocument *m_highlightDocument;
+
+    // Highlighter state before line `i * StateCheckpointInterval`
+    QVector<int> m_stateCheckpoints;
+    qint64 m_checkpointTarget;
+    QTimer *m_checkpointTimer;
+
+    qint64 m_windowFirst;
+    bool m_windowExact;
+    QStringList m_windowLines;
+    QVector<QVector<QTextLayout::FormatRange>> m_windowFormats;
+
+    int m_maxLineWidth;
+};
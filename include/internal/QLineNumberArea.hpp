@@ -1,14 +1,21 @@
 #pragma once
 
 // Qt
+#include <QVector>
 #include <QWidget> // Required for inheritance
 
 #include <QCodeEditor>
 
+class QGutterColumn;
 class QSyntaxStyle;
+class QTextBlock;
 
 /**
  * @brief Class, that describes line number area widget.
+ * @details The area is made of columns (line numbers,
+ * diagnostic markers, ...), painted from left to right.
+ * Widths of the columns are cached and only the damaged
+ * rows are painted.
  */
 class QLineNumberArea : public QWidget
 {
@@ -43,17 +50,61 @@ class QLineNumberArea : public QWidget
      */
     QSyntaxStyle *syntaxStyle() const;
 
-    void lint(QCodeEditor::SeverityLevel level, int from, int to);
+    /**
+     * @brief Method for adding column to the area.
+     * @param column Pointer to column.
+     * @param index Position of the column, -1 to add it
+     * as the last one.
+     */
+    void addColumn(QGutterColumn *column, int index = -1);
+
+    /**
+     * @brief Method for removing and deleting column.
+     * @return If there was a column with the name.
+     */
+    bool removeColumn(const QString &name);
+
+    /**
+     * @brief Method for getting column by name.
+     * @return Pointer to column or nullptr.
+     */
+    QGutterColumn *column(const QString &name) const;
+
+    /**
+     * @brief Method for getting columns from left to
+     * right.
+     */
+    QVector<QGutterColumn *> columns() const;
 
-    void clearLint();
+    /**
+     * @brief Method for computing widths of all columns
+     * again and dropping their cached rendering, e.g.
+     * after the font changes.
+     */
+    void invalidate();
+
+    /**
+     * @brief Method for repainting the rows of the block.
+     */
+    void updateBlock(const QTextBlock &block);
 
   protected:
     void paintEvent(QPaintEvent *event) override;
 
+    void mousePressEvent(QMouseEvent *event) override;
+
   private:
+    /**
+     * @brief Method for computing width of the column
+     * again.
+     */
+    void updateWidth(QGutterColumn *column);
+
     QSyntaxStyle *m_syntaxStyle;
 
     QCodeEditor *m_codeEditParent;
 
-    QMap<int, QCodeEditor::SeverityLevel> m_squiggles;
+    QVector<QGutterColumn *> m_columns;
+    QVector<int> m_widths;
+    int m_width;
 };
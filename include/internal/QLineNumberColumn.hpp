@@ -0,0 +1,52 @@
+#pragma once
+
+// QCodeEditor
+#include <QGutterColumn>
+
+// Qt
+#include <QPixmap>
+
+/**
+ * @brief Class, that describes gutter column with
+ * line numbers.
+ * @details Digits are rendered once into a pixmap for
+ * both the current and the other lines, numbers are
+ * then copied digit by digit instead of laying out text
+ * for every row. The width changes only when the number
+ * of digits of the line count does.
+ */
+class QLineNumberColumn : public QGutterColumn
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param editor Pointer to editor.
+     */
+    explicit QLineNumberColumn(QCodeEditor *editor);
+
+    int computeWidth() const override;
+
+    void beginPaint(const QTextBlock &first, const QTextBlock &last) override;
+
+    void paintRow(QPainter &painter, const QRect &rect, const QTextBlock &block, int blockNumber) override;
+
+    void styleChanged() override;
+
+  private:
+    /**
+     * @brief Method for rendering the digits for the
+     * device pixel ratio.
+     */
+    void updateAtlas(qreal ratio);
+
+    int m_digits;
+
+    // Digits 0-9 of the other lines, then of the current line
+    QPixmap m_atlas;
+    int m_cellWidth;
+    int m_cellHeight;
+
+    int m_currentBlockNumber;
+};
@@ -0,0 +1,211 @@
+#pragma once
+
+// QCodeEditor
+#include <QCodeEditor>
+#include <QTextChangeFilter>
+
+// Qt
+#include <QHash>
+#include <QObject> // Required for inheritance
+#include <QPointer>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+class QProcess;
+class QTimer;
+
+/**
+ * @brief Class, that describes runner of an external
+ * linter, which results are shown as the diagnostics of
+ * an editor.
+ * @details The linter is run on a snapshot of the text,
+ * debounced while typing. A run is asynchronous and is
+ * killed when a newer one starts, results of a run for
+ * text, which has changed since, are discarded. The output
+ * is parsed line by line with the adapter's expression and
+ * applied in a single batch.
+ */
+class QLinterRunner : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The Input enum, How the linter gets the text.
+     */
+    enum class Input
+    {
+        // Written to the standard input
+        StandardInput,
+
+        // Saved to a temporary file, which path replaces
+        // `FilePlaceholder` in the arguments
+        TemporaryFile
+    };
+
+    /**
+     * @brief Placeholder for the temporary file path
+     * in the arguments.
+     */
+    static constexpr auto FilePlaceholder = "{file}";
+
+    /**
+     * @brief The Adapter struct, Parser of a linter output.
+     * @details Output lines are matched against `pattern`,
+     * which named groups are used: "file", "line" (required),
+     * "column", "endLine", "endColumn", "severity" and
+     * "message". Lines of other files than the linted one,
+     * e.g. of included headers, are skipped. Lines and
+     * columns are 1-based unless `lineBase` or `columnBase`
+     * say otherwise, columns count UTF-8 bytes unless
+     * `columnEncoding` says otherwise. Severities are
+     * looked up lower case, the rest are warnings.
+     */
+    struct Adapter
+    {
+        Adapter(const QRegularExpression &p = QRegularExpression(),
+                const QHash<QString, QCodeEditor::SeverityLevel> &s = {})
+            : pattern(p), severities(s), lineBase(1), columnBase(1), columnEncoding(QPositionMapper::Encoding::Utf8),
+              standardInputNames({"-", "<stdin>", "stdin"})
+        {
+        }
+
+        QRegularExpression pattern;
+        QHash<QString, QCodeEditor::SeverityLevel> severities;
+        int lineBase;
+        int columnBase;
+        QPositionMapper::Encoding columnEncoding;
+
+        // Names the linter reports the standard input as
+        QStringList standardInputNames;
+    };
+
+    /**
+     * @brief Static method for getting adapter of the
+     * "file:line:column: severity: message" output of
+     * GCC, Clang and clang-tidy.
+     */
+    static Adapter compilerAdapter();
+
+    /**
+     * @brief Static method for getting adapter of the
+     * "file:line:column: code: message" output of pylint.
+     */
+    static Adapter pylintAdapter();
+
+    /**
+     * @brief Static method for getting adapter of the
+     * "file:line:column-endColumn: (code) message" output
+     * of luacheck with `--formatter plain --ranges`.
+     */
+    static Adapter luacheckAdapter();
+
+    /**
+     * @brief Constructor.
+     * @param editor Pointer to editor, which text is linted
+     * and which diagnostics are replaced.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QLinterRunner(QCodeEditor *editor, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Kills the running linter.
+     */
+    ~QLinterRunner() override;
+
+    // Disable copying
+    QLinterRunner(const QLinterRunner &) = delete;
+    QLinterRunner &operator=(const QLinterRunner &) = delete;
+
+    /**
+     * @brief Method for setting linter to run. The text
+     * is linted after every change from now on.
+     * @param program Linter executable.
+     * @param arguments Arguments, may contain `FilePlaceholder`.
+     * @param fileSuffix Suffix of the temporary file, e.g.
+     * ".cpp", linters choose the language by the extension.
+     */
+    void setProgram(const QString &program, const QStringList &arguments, Input input = Input::StandardInput,
+                    const QString &fileSuffix = QString());
+
+    /**
+     * @brief Method for setting parser of the output.
+     * Default: `compilerAdapter()`
+     */
+    void setAdapter(const Adapter &adapter);
+
+    /**
+     * @brief Method for setting delay after the last
+     * change before the linter is run.
+     * Default: 500 ms
+     */
+    void setDelay(int msec);
+
+    /**
+     * @brief Method for getting delay after the last
+     * change before the linter is run.
+     */
+    int delay() const;
+
+    /**
+     * @brief Method for getting is the linter running.
+     */
+    bool isRunning() const;
+
+  public Q_SLOTS:
+    /**
+     * @brief Slot, that runs the linter now, killing
+     * the previous run.
+     */
+    void run();
+
+    /**
+     * @brief Slot, that kills the running linter and
+     * drops the pending run.
+     */
+    void cancel();
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, results of a run have been applied.
+     * @param count Number of diagnostics.
+     */
+    void finished(int count);
+
+    /**
+     * @brief Signal, the linter could not be run.
+     */
+    void failed(const QString &error);
+
+  private Q_SLOTS:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    /**
+     * @brief Method for applying output of the finished
+     * run, if the text is still the linted one.
+     * @param revision Revision of the linted document.
+     * @param version Version of the diagnostics at the run.
+     */
+    void processFinished(QProcess *process, const QString &text, int revision, int version);
+
+    /**
+     * @brief Method for checking if the reported file is
+     * the linted text. An empty name is taken as it is.
+     */
+    bool isLintedFile(QProcess *process, const QString &file) const;
+
+    QPointer<QCodeEditor> m_editor;
+
+    QString m_program;
+    QStringList m_arguments;
+    Input m_input;
+    QString m_fileSuffix;
+    Adapter m_adapter;
+
+    QTimer *m_timer;
+    QProcess *m_process;
+
+    QTextChangeFilter m_changeFilter;
+};
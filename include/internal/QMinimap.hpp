@@ -0,0 +1,99 @@
+#pragma once
+
+// Qt
+#include <QPixmap>
+#include <QWidget> // Required for inheritance
+
+class QCodeEditor;
+class QTextBlock;
+
+/**
+ * @brief Class, that describes minimap widget showing
+ * a scaled-down, syntax colored overview of the document
+ * of the editor, a row per block.
+ * @details Each block keeps the colored runs of its row
+ * until its text or highlighting changes. The painted
+ * rows are kept in a pixmap, which is scrolled along with
+ * the editor, so only the exposed and the changed rows
+ * are painted again. Nothing is laid out for the rows.
+ */
+class QMinimap : public QWidget
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param editor Pointer to editor, which document
+     * is shown.
+     */
+    explicit QMinimap(QCodeEditor *editor);
+
+    // Disable copying
+    QMinimap(const QMinimap &) = delete;
+    QMinimap &operator=(const QMinimap &) = delete;
+
+    /**
+     * @brief Overridden method for getting minimap size.
+     */
+    QSize sizeHint() const override;
+
+    /**
+     * @brief Method for dropping all cached rows, e.g.
+     * after the syntax style changes.
+     */
+    void invalidate();
+
+  protected:
+    void paintEvent(QPaintEvent *event) override;
+
+    void mousePressEvent(QMouseEvent *event) override;
+
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that drops cached rows of the changed
+     * blocks.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    /**
+     * @brief Method for getting number of the block shown
+     * in the top row.
+     */
+    int firstRow() const;
+
+    /**
+     * @brief Method for painting rows [from, to) of the
+     * pixmap, starting from the block.
+     */
+    void paintRows(QPainter &painter, QTextBlock block, int from, int to);
+
+    /**
+     * @brief Method for building colored runs of the block,
+     * if they aren't up to date.
+     */
+    void updateRuns(const QTextBlock &block);
+
+    /**
+     * @brief Method for scrolling the editor, so the
+     * block of the row is centered.
+     */
+    void scrollToRow(int y);
+
+    QCodeEditor *m_editor;
+
+    // Increased when all cached runs become outdated
+    int m_generation;
+    int m_blockCount;
+
+    QPixmap m_pixmap;
+    bool m_pixmapValid;
+    int m_pixmapFirstRow;
+
+    // Numbers of the changed blocks painted in the pixmap, [from, to]
+    int m_dirtyFrom;
+    int m_dirtyTo;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QTextCursor>
+#include <QVector>
+
+/**
+ * @brief Class, that describes secondary cursors of an
+ * editor, besides its text cursor.
+ * @details Cursors are kept sorted by position and never
+ * overlap, so the ones in a range are found by binary
+ * search. The document moves them along with its edits,
+ * which keeps them sorted, though edits may make them
+ * touch, until they're normalized again.
+ */
+class QMultiCursor : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QMultiCursor(QObject *parent = nullptr);
+
+    // Disable copying
+    QMultiCursor(const QMultiCursor &) = delete;
+    QMultiCursor &operator=(const QMultiCursor &) = delete;
+
+    /**
+     * @brief Method for checking if there are no
+     * secondary cursors.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Method for getting number of secondary
+     * cursors.
+     */
+    int count() const;
+
+    /**
+     * @brief Method for getting all cursors, sorted by
+     * position.
+     */
+    QVector<QTextCursor> cursors() const;
+
+    /**
+     * @brief Method for getting cursors, which cursor
+     * or selection intersects [from, to], sorted by
+     * position.
+     */
+    QVector<QTextCursor> cursors(int from, int to) const;
+
+    /**
+     * @brief Method for adding a cursor. It's merged
+     * with the cursors it overlaps.
+     */
+    void addCursor(const QTextCursor &cursor);
+
+    /**
+     * @brief Method for replacing all cursors.
+     * Overlapping cursors are merged.
+     */
+    void setCursors(QVector<QTextCursor> cursors);
+
+    /**
+     * @brief Method for removing all cursors.
+     */
+    void clear();
+
+    /**
+     * @brief Method for merging the cursors, which edits
+     * made overlap, and removing the ones overlapping
+     * the primary cursor.
+     */
+    void normalize(const QTextCursor &primary);
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, cursors have been added, removed or
+     * moved.
+     */
+    void changed();
+
+  private:
+    /**
+     * @brief Static method for checking if the cursors
+     * overlap. Carets at the same position overlap,
+     * selections only touching each other don't.
+     */
+    static bool overlap(const QTextCursor &a, const QTextCursor &b);
+
+    /**
+     * @brief Method for merging overlapping neighbours
+     * of the sorted cursors.
+     */
+    void merge();
+
+    QVector<QTextCursor> m_cursors;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+// Qt
+#include <QHash>
+#include <QRect>
+#include <QScrollBar> // Required for inheritance
+#include <QVector>
+
+class QCodeBlockData;
+class QCodeEditor;
+class QTextBlock;
+
+/**
+ * @brief Class, that describes vertical scrollbar of the
+ * editor showing markers of the lines with diagnostics,
+ * search results, occurrences and changes.
+ * @details Markers are counted per block, and the counts
+ * are summed up in buckets, one per pixel row of the
+ * groove. Adding or removing a marker changes a single
+ * bucket, and painting walks the buckets only, so its
+ * cost doesn't depend on the number of markers. Buckets
+ * are rebuilt from the marked blocks when the number of
+ * blocks or the height of the groove changes.
+ */
+class QOverviewRuler : public QScrollBar
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Kinds of markers, each painted in its own
+     * color, later ones over the earlier ones.
+     */
+    enum class Lane
+    {
+        Changes,
+        Occurrences,
+        SearchResults,
+        Warnings,
+        Errors
+    };
+
+    static constexpr int LaneCount = 5;
+
+    /**
+     * @brief Constructor.
+     * @param editor Pointer to editor, which document is
+     * marked.
+     */
+    explicit QOverviewRuler(QCodeEditor *editor);
+
+    /**
+     * @brief Destructor. Detaches from the blocks.
+     */
+    ~QOverviewRuler() override;
+
+    // Disable copying
+    QOverviewRuler(const QOverviewRuler &) = delete;
+    QOverviewRuler &operator=(const QOverviewRuler &) = delete;
+
+    /**
+     * @brief Method for adding a marker to the block.
+     */
+    void addMarker(Lane lane, const QTextBlock &block);
+
+    /**
+     * @brief Method for removing a marker from the block.
+     */
+    void removeMarker(Lane lane, const QTextBlock &block);
+
+    /**
+     * @brief Method for adding a marker per document
+     * position, e.g. a batch of streamed search results.
+     */
+    void addMarkers(Lane lane, const QVector<int> &positions);
+
+    /**
+     * @brief Method for replacing markers of the lane with
+     * a marker per document position. Only the blocks,
+     * which count changes, touch the buckets.
+     */
+    void setMarkers(Lane lane, const QVector<int> &positions);
+
+    /**
+     * @brief Method for removing all markers of the lane.
+     */
+    void clearMarkers(Lane lane);
+
+    /**
+     * @brief Method for getting number of markers of the
+     * block.
+     */
+    int markerCount(Lane lane, const QTextBlock &block) const;
+
+    /**
+     * @brief Method for removing a deleted block.
+     * Called by QCodeBlockData.
+     */
+    void removeBlock(QCodeBlockData *data);
+
+  protected:
+    void paintEvent(QPaintEvent *event) override;
+
+    void resizeEvent(QResizeEvent *event) override;
+
+  private:
+    /**
+     * @brief Method for getting groove of the scrollbar,
+     * which the buckets cover.
+     */
+    QRect grooveRect() const;
+
+    /**
+     * @brief Method for getting bucket of the block.
+     */
+    int bucket(int blockNumber) const;
+
+    /**
+     * @brief Method for changing bucket count of the block.
+     * @return Rectangle of the bucket, empty if the
+     * buckets have to be rebuilt anyway.
+     */
+    QRect changeBucket(Lane lane, QCodeBlockData *data, int delta);
+
+    /**
+     * @brief Method for counting all markers into the
+     * buckets again.
+     */
+    void rebuildBuckets();
+
+    /**
+     * @brief Method for getting color of the lane markers
+     * from the editor's syntax style.
+     */
+    QColor laneColor(Lane lane) const;
+
+    QCodeEditor *m_editor;
+
+    // Number of markers of each marked block, per lane
+    QVector<QHash<QCodeBlockData *, int>> m_markers;
+
+    // Number of markers in each pixel row of the groove, per lane
+    QVector<QVector<int>> m_buckets;
+    bool m_bucketsValid;
+    int m_bucketBlockCount;
+    QRect m_groove;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QPointer>
+#include <QVector>
+
+class QTextBlock;
+class QTextDocument;
+
+/**
+ * @brief Class, that describes conversion between document
+ * offsets and line/column positions, with columns counted
+ * in UTF-16 code units, UTF-8 bytes or code points.
+ * @details Lines are found through the block map of the
+ * document in O(log n). Every block keeps the columns after
+ * each of its non-ASCII characters, updated when the block
+ * changes, so a column is converted by a binary search,
+ * and ASCII lines need no work at all.
+ */
+class QPositionMapper : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The Encoding enum, Unit of columns.
+     */
+    enum class Encoding
+    {
+        // QString and QTextDocument columns
+        Utf16,
+        Utf8,
+        CodePoint
+    };
+
+    /**
+     * @brief The Position struct, Line and column,
+     * both 0-based.
+     */
+    struct Position
+    {
+        Position(int l = 0, int c = 0) : line(l), column(c)
+        {
+        }
+
+        int line;
+        int column;
+    };
+
+    /**
+     * @brief Constructor. Indexes the current content.
+     * @param document Pointer to document.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QPositionMapper(QTextDocument *document, QObject *parent = nullptr);
+
+    // Disable copying
+    QPositionMapper(const QPositionMapper &) = delete;
+    QPositionMapper &operator=(const QPositionMapper &) = delete;
+
+    /**
+     * @brief Method for getting document offset of the
+     * position. Lines and columns out of range are
+     * clamped to the document and the line.
+     */
+    int toOffset(const Position &position, Encoding encoding = Encoding::Utf16) const;
+
+    /**
+     * @brief Method for getting position of the document
+     * offset.
+     */
+    Position toPosition(int offset, Encoding encoding = Encoding::Utf16) const;
+
+    /**
+     * @brief Method for converting column of the line
+     * between encodings.
+     */
+    int convertColumn(int line, int column, Encoding from, Encoding to) const;
+
+    /**
+     * @brief Method for getting length of the line.
+     */
+    int lineLength(int line, Encoding encoding = Encoding::Utf16) const;
+
+    /**
+     * @brief Method for converting many positions at once.
+     * Positions close to the previous one don't search
+     * for their line, so sorted input is the fastest.
+     */
+    QVector<int> toOffsets(const QVector<Position> &positions, Encoding encoding = Encoding::Utf16) const;
+
+    /**
+     * @brief Method for converting many offsets at once.
+     * Offsets close to the previous one don't search
+     * for their line, so sorted input is the fastest.
+     */
+    QVector<Position> toPositions(const QVector<int> &offsets, Encoding encoding = Encoding::Utf16) const;
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that re-indexes the changed blocks.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    void indexBlocks(int from, int to);
+
+    /**
+     * @brief Method for getting block of the line,
+     * starting the search at `hint` if it's close.
+     */
+    QTextBlock findLine(int line, const QTextBlock &hint) const;
+
+    /**
+     * @brief Method for getting block of the offset,
+     * starting the search at `hint` if it's close.
+     */
+    QTextBlock findOffset(int offset, const QTextBlock &hint) const;
+
+    static int convert(const QTextBlock &block, int column, Encoding from, Encoding to);
+
+    QPointer<QTextDocument> m_document;
+};
@@ -1,13 +1,13 @@
 #pragma once
 
-// Qt
-#include <QCompleter> // Required for inheritance
+// QCodeEditor
+#include <QFuzzyCompleter> // Required for inheritance
 
 /**
  * @brief Class, that describes completer with
  * glsl specific types and functions.
  */
-class QPythonCompleter : public QCompleter
+class QPythonCompleter : public QFuzzyCompleter
 {
     Q_OBJECT
 
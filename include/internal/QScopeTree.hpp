@@ -0,0 +1,123 @@
+#pragma once
+
+// QCodeEditor
+#include <QCodeBlockData>
+#include <QStyleSyntaxHighlighter>
+
+// Qt
+#include <QObject> // Required for inheritance
+#include <QPointer>
+#include <QTextBlock>
+#include <QVector>
+
+class QBracketIndex;
+class QTextDocument;
+
+/**
+ * @brief Class, that describes tree of the syntactic
+ * scopes of a document: brackets of C-like languages and
+ * JSON, indented blocks of Python, elements of XML.
+ * @details Each block stores how it changes the scope
+ * depth, and the blocks are kept in a treap aggregating
+ * these changes. An edit re-indexes the changed blocks
+ * only, the scopes enclosing a line are found in
+ * O(log n) blocks per scope and the end of a scope in
+ * O(log n) blocks.
+ */
+class QScopeTree : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param document Pointer to indexed document.
+     * @param brackets Pointer to bracket index of the
+     * document, used for the Brackets mode.
+     * @param parent Pointer to parent QObject.
+     */
+    QScopeTree(QTextDocument *document, QBracketIndex *brackets, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Detaches from the blocks.
+     */
+    ~QScopeTree() override;
+
+    // Disable copying
+    QScopeTree(const QScopeTree &) = delete;
+    QScopeTree &operator=(const QScopeTree &) = delete;
+
+    /**
+     * @brief Method for setting what the scopes are made
+     * of and re-indexing the document.
+     * Default: None
+     */
+    void setMode(QStyleSyntaxHighlighter::FoldingMode mode);
+
+    /**
+     * @brief Method for getting what the scopes are made
+     * of.
+     */
+    QStyleSyntaxHighlighter::FoldingMode mode() const;
+
+    /**
+     * @brief Method for getting blocks opening the scopes,
+     * which enclose the block, outermost first.
+     */
+    QVector<QTextBlock> enclosingScopes(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for getting last block of the scope
+     * opened by the block, without the line closing it.
+     * @return Block, invalid if the block opens no scope
+     * or the scope has no lines besides the opening and
+     * the closing one.
+     */
+    QTextBlock scopeEnd(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for removing a deleted block.
+     * Called by QCodeBlockData.
+     */
+    void removeBlock(QCodeBlockData *data);
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, scopes of the blocks in range
+     * [from, to] have changed.
+     */
+    void scopesChanged(int from, int to);
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that re-indexes the changed blocks.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    void indexBlocks(int from, int to);
+
+    /**
+     * @brief Method for indexing the block.
+     * @return If its summary has changed.
+     */
+    bool indexBlock(const QTextBlock &block);
+
+    QCodeBlockData::ScopeSummary summary(const QTextBlock &block) const;
+
+    /**
+     * @brief Method for getting the depth at the start
+     * of the block.
+     */
+    int depth(int position) const;
+
+    void link(QCodeBlockData *data);
+    void unlink(QCodeBlockData *data);
+
+    QPointer<QTextDocument> m_document;
+    QBracketIndex *m_brackets;
+    QStyleSyntaxHighlighter::FoldingMode m_mode;
+
+    QCodeBlockData *m_root;
+    quint32 m_seed;
+};
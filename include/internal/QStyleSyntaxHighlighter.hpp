@@ -14,6 +14,24 @@ class QStyleSyntaxHighlighter : public QSyntaxHighlighter
     Q_OBJECT
 
   public:
+    /**
+     * @brief The FoldingMode enum, What the foldable
+     * regions of the language are made of.
+     */
+    enum class FoldingMode
+    {
+        None,
+
+        // Lines between a bracket and its matching one, C-like languages
+        Brackets,
+
+        // Lines indented deeper than the line before them, e.g. Python
+        Indentation,
+
+        // Lines between an opening and a closing tag, e.g. XML
+        Tags,
+    };
+
     /**
      * @brief Constructor.
      * @param document Pointer to text document.
@@ -78,6 +96,19 @@ class QStyleSyntaxHighlighter : public QSyntaxHighlighter
      */
     void setEndCommentBlockSequence(const QString &endCommentBlockSequence);
 
+    /**
+     * @brief Method for getting what the foldable regions
+     * of the language are made of.
+     * Default: Brackets
+     */
+    FoldingMode foldingMode() const;
+
+    /**
+     * @brief Method for setting what the foldable regions
+     * of the language are made of.
+     */
+    void setFoldingMode(FoldingMode mode);
+
   private:
     QSyntaxStyle *m_syntaxStyle;
 
@@ -85,4 +116,5 @@ class QStyleSyntaxHighlighter : public QSyntaxHighlighter
     QString m_commentLineSequence;
     QString m_startCommentBlockSequence;
     QString m_endCommentBlockSequence;
+    FoldingMode m_foldingMode;
 };
@@ -15,6 +15,13 @@ class QSyntaxStyle : public QObject
     Q_OBJECT
 
   public:
+    /**
+     * @brief Format property holding the name the format
+     * has been loaded for, so highlighted text can be
+     * classified (e.g. "String", "Comment").
+     */
+    static constexpr int FormatNameProperty = QTextFormat::UserProperty + 1;
+
     /**
      * @brief Constructor.
      * @param parent Pointer to parent QObject
@@ -49,6 +56,13 @@ class QSyntaxStyle : public QObject
      */
     QTextCharFormat getFormat(const QString &name) const;
 
+    /**
+     * @brief Method for checking if the style has format
+     * for property name.
+     * @param name Property name.
+     */
+    bool hasFormat(const QString &name) const;
+
     /**
      * @brief Static method for getting default style.
      * @return Pointer to default style.
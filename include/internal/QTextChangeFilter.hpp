@@ -0,0 +1,39 @@
+#pragma once
+
+// Qt
+#include <QPointer>
+
+class QTextDocument;
+
+/**
+ * @brief Class, that tells text edits from the format
+ * changes, which QTextDocument reports the same way.
+ * @details The highlighter reports new formats as the
+ * text replaced by itself, so the number of removed and
+ * added characters can't tell them from a same length
+ * edit. Edits change the revision of the document,
+ * format changes don't. Without undo the revision isn't
+ * kept, then only edits changing the length are seen.
+ */
+class QTextChangeFilter
+{
+  public:
+    /**
+     * @brief Constructor.
+     * @param document Pointer to watched document.
+     */
+    explicit QTextChangeFilter(QTextDocument *document);
+
+    /**
+     * @brief Method for checking if the reported change
+     * has edited the text. To be called once for each
+     * `contentsChange` signal.
+     */
+    bool isTextChange(int charsRemoved, int charsAdded);
+
+  private:
+    QPointer<QTextDocument> m_document;
+
+    // Revision of the document at the last change
+    int m_revision;
+};
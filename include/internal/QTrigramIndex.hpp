@@ -0,0 +1,155 @@
+#pragma once
+
+// Qt
+#include <QHash>
+#include <QObject> // Required for inheritance
+#include <QPointer>
+#include <QSet>
+#include <QString>
+#include <QTextBlock>
+#include <QVector>
+
+class QCodeBlockData;
+class QTextDocument;
+class QTimer;
+
+/**
+ * @brief Class, that describes index of the trigrams
+ * (case folded runs of three characters) of the blocks of
+ * a document, narrowing the blocks, which may contain a
+ * text, before they're searched.
+ * @details The index is optional and is built while the
+ * event loop is idle, a few milliseconds at a time, since
+ * blocks can't be read from other threads. Changed blocks
+ * are indexed again on each edit, so once built, the index
+ * stays up to date. It may enable itself, when the
+ * document grows above a threshold.
+ */
+class QTrigramIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor.
+     * @param document Pointer to indexed document.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QTrigramIndex(QTextDocument *document, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Detaches from the blocks.
+     */
+    ~QTrigramIndex() override;
+
+    // Disable copying
+    QTrigramIndex(const QTrigramIndex &) = delete;
+    QTrigramIndex &operator=(const QTrigramIndex &) = delete;
+
+    /**
+     * @brief Static method for getting a text, which every
+     * match of the regular expression contains, as long
+     * as it can be told without parsing the expression.
+     * @return Longest plain run of the expression, empty
+     * if there's an alternation.
+     */
+    static QString requiredLiteral(const QString &pattern);
+
+    /**
+     * @brief Method for enabling the index. It's built in
+     * the background, disabling drops it.
+     * Default: false
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Method for getting is the index enabled.
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Method for setting number of characters of
+     * the document, above which the index is enabled
+     * automatically. -1 disables it.
+     * Default: -1
+     */
+    void setThreshold(int characters);
+
+    /**
+     * @brief Method for getting number of characters of
+     * the document, above which the index is enabled.
+     */
+    int threshold() const;
+
+    /**
+     * @brief Method for getting is the index built.
+     */
+    bool isReady() const;
+
+    /**
+     * @brief Method for getting time spent building the
+     * index, in ms.
+     */
+    qint64 buildTime() const;
+
+    /**
+     * @brief Method for getting estimated memory used by
+     * the index, in bytes.
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @brief Method for getting blocks containing all
+     * trigrams of the text, sorted by position. They
+     * may contain the text, other blocks don't.
+     * @note The text has to be 3 characters at least and
+     * the index has to be built.
+     */
+    QVector<QTextBlock> candidates(const QString &text) const;
+
+    /**
+     * @brief Method for removing a deleted block.
+     * Called by QCodeBlockData.
+     */
+    void removeBlock(QCodeBlockData *data);
+
+  Q_SIGNALS:
+    /**
+     * @brief Signal, the index has been built.
+     */
+    void ready();
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that indexes the changed blocks.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+    /**
+     * @brief Slot, that indexes the blocks for a while.
+     */
+    void buildSlice();
+
+  private:
+    /**
+     * @brief Static method for getting trigrams of the
+     * text, sorted and unique.
+     */
+    static QVector<quint64> trigrams(const QString &text);
+
+    void indexBlock(const QTextBlock &block);
+
+    QPointer<QTextDocument> m_document;
+    QTimer *m_buildTimer;
+
+    bool m_enabled;
+    int m_threshold;
+
+    // Number of the first block, which may not be indexed yet
+    int m_buildBlock;
+    bool m_ready;
+    qint64 m_buildTime;
+
+    QHash<quint64, QSet<QCodeBlockData *>> m_postings;
+    qint64 m_postingCount;
+};
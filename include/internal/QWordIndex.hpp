@@ -0,0 +1,111 @@
+#pragma once
+
+// Qt
+#include <QHash>
+#include <QObject> // Required for inheritance
+#include <QPointer>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QCodeBlockData;
+class QTextDocument;
+
+/**
+ * @brief Class, that describes index of the words of a
+ * document. A word is a run of letters, digits and '_'.
+ * @details Changed blocks are re-tokenized on each edit,
+ * so the index is always up to date and the occurrences
+ * of a word are found without scanning the document.
+ */
+class QWordIndex : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief Constructor. Indexes the current content.
+     * @param document Pointer to indexed document.
+     * @param parent Pointer to parent QObject.
+     */
+    explicit QWordIndex(QTextDocument *document, QObject *parent = nullptr);
+
+    /**
+     * @brief Destructor. Detaches from the blocks.
+     */
+    ~QWordIndex() override;
+
+    // Disable copying
+    QWordIndex(const QWordIndex &) = delete;
+    QWordIndex &operator=(const QWordIndex &) = delete;
+
+    /**
+     * @brief Static method for checking if the text
+     * is a single word.
+     */
+    static bool isWord(const QString &text);
+
+    /**
+     * @brief Method for getting number of occurrences
+     * of the word.
+     */
+    int count(const QString &word) const;
+
+    /**
+     * @brief Method for getting document positions of
+     * all occurrences of the word, ascending.
+     */
+    QVector<int> occurrences(const QString &word) const;
+
+    /**
+     * @brief Method for getting document positions of
+     * occurrences of the word in blocks intersecting
+     * [from, to], ascending. The cost depends on the
+     * range, not on the document.
+     */
+    QVector<int> occurrences(const QString &word, int from, int to) const;
+
+    /**
+     * @brief Method for getting all words of the
+     * document, unordered.
+     */
+    QStringList words() const;
+
+    /**
+     * @brief Method for getting revision of the word
+     * list. It's increased, when a word is added or
+     * removed.
+     */
+    int revision() const;
+
+    /**
+     * @brief Method for removing a deleted block.
+     * Called by QCodeBlockData.
+     */
+    void removeBlock(QCodeBlockData *data);
+
+  private Q_SLOTS:
+    /**
+     * @brief Slot, that re-tokenizes the changed blocks.
+     */
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+  private:
+    struct Entry
+    {
+        Entry() : blocks(), count(0)
+        {
+        }
+
+        QSet<QCodeBlockData *> blocks;
+        int count;
+    };
+
+    void indexBlocks(int from, int to);
+
+    QPointer<QTextDocument> m_document;
+
+    QHash<QString, Entry> m_entries;
+    int m_revision;
+};
@@ -0,0 +1,680 @@
+// QCodeEditor
+#include <QBracketIndex>
+#include <QSyntaxStyle>
+
+// Qt
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+
+// std
+#include <algorithm>
+
+namespace
+{
+using Summary = QCodeBlockData::BracketSummary;
+
+Summary concat(const Summary &a, const Summary &b)
+{
+    return {a.delta + b.delta, qMin(a.minPrefix, a.delta + b.minPrefix)};
+}
+
+// Highest depth reached going backwards, never below 0
+int maxSuffix(const Summary &s)
+{
+    return s.delta - s.minPrefix;
+}
+
+const Summary &own(const QCodeBlockData *node)
+{
+    return node->bracketNode.own;
+}
+
+Summary total(const QCodeBlockData *node)
+{
+    return node ? node->bracketNode.total : Summary();
+}
+
+void pull(QCodeBlockData *node)
+{
+    auto &links = node->bracketNode;
+
+    links.total = concat(concat(total(links.left), links.own), total(links.right));
+
+    if (links.left)
+    {
+        links.left->bracketNode.parent = node;
+    }
+
+    if (links.right)
+    {
+        links.right->bracketNode.parent = node;
+    }
+}
+
+QCodeBlockData *merge(QCodeBlockData *a, QCodeBlockData *b)
+{
+    if (!a || !b)
+    {
+        return a ? a : b;
+    }
+
+    if (a->bracketNode.priority > b->bracketNode.priority)
+    {
+        a->bracketNode.right = merge(a->bracketNode.right, b);
+        pull(a);
+        return a;
+    }
+
+    b->bracketNode.left = merge(a, b->bracketNode.left);
+    pull(b);
+    return b;
+}
+
+// Splits into blocks before position and the rest
+void split(QCodeBlockData *node, int position, QCodeBlockData *&left, QCodeBlockData *&right)
+{
+    if (!node)
+    {
+        left = right = nullptr;
+        return;
+    }
+
+    if (node->block.position() < position)
+    {
+        split(node->bracketNode.right, position, node->bracketNode.right, right);
+        left = node;
+        pull(left);
+    }
+    else
+    {
+        split(node->bracketNode.left, position, left, node->bracketNode.left);
+        right = node;
+        pull(right);
+    }
+}
+
+// First node of the subtree, where acc + prefix depth reaches need
+QCodeBlockData *descendForward(QCodeBlockData *node, int &acc, int need)
+{
+    while (node)
+    {
+        auto left = node->bracketNode.left;
+
+        if (left && acc + total(left).minPrefix <= need)
+        {
+            node = left;
+            continue;
+        }
+
+        acc += total(left).delta;
+
+        if (acc + own(node).minPrefix <= need)
+        {
+            return node;
+        }
+
+        acc += own(node).delta;
+        node = node->bracketNode.right;
+    }
+
+    return nullptr;
+}
+
+// First node after `node`, where acc + prefix depth reaches need
+QCodeBlockData *searchForward(QCodeBlockData *node, int &acc, int need)
+{
+    auto right = node->bracketNode.right;
+
+    if (right && acc + total(right).minPrefix <= need)
+    {
+        return descendForward(right, acc, need);
+    }
+
+    acc += total(right).delta;
+
+    for (auto child = node, parent = node->bracketNode.parent; parent;
+         child = parent, parent = parent->bracketNode.parent)
+    {
+        if (parent->bracketNode.left != child)
+        {
+            continue;
+        }
+
+        if (acc + own(parent).minPrefix <= need)
+        {
+            return parent;
+        }
+
+        acc += own(parent).delta;
+
+        right = parent->bracketNode.right;
+
+        if (right && acc + total(right).minPrefix <= need)
+        {
+            return descendForward(right, acc, need);
+        }
+
+        acc += total(right).delta;
+    }
+
+    return nullptr;
+}
+
+// Last node of the subtree, where acc + suffix depth reaches need
+QCodeBlockData *descendBackward(QCodeBlockData *node, int &acc, int need)
+{
+    while (node)
+    {
+        auto right = node->bracketNode.right;
+
+        if (right && acc + maxSuffix(total(right)) >= need)
+        {
+            node = right;
+            continue;
+        }
+
+        acc += total(right).delta;
+
+        if (acc + maxSuffix(own(node)) >= need)
+        {
+            return node;
+        }
+
+        acc += own(node).delta;
+        node = node->bracketNode.left;
+    }
+
+    return nullptr;
+}
+
+// Last node before `node`, where acc + suffix depth reaches need
+QCodeBlockData *searchBackward(QCodeBlockData *node, int &acc, int need)
+{
+    auto left = node->bracketNode.left;
+
+    if (left && acc + maxSuffix(total(left)) >= need)
+    {
+        return descendBackward(left, acc, need);
+    }
+
+    acc += total(left).delta;
+
+    for (auto child = node, parent = node->bracketNode.parent; parent;
+         child = parent, parent = parent->bracketNode.parent)
+    {
+        if (parent->bracketNode.right != child)
+        {
+            continue;
+        }
+
+        if (acc + maxSuffix(own(parent)) >= need)
+        {
+            return parent;
+        }
+
+        acc += own(parent).delta;
+
+        left = parent->bracketNode.left;
+
+        if (left && acc + maxSuffix(total(left)) >= need)
+        {
+            return descendBackward(left, acc, need);
+        }
+
+        acc += total(left).delta;
+    }
+
+    return nullptr;
+}
+} // namespace
+
+QBracketIndex::QBracketIndex(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_document(document), m_pairs({{'(', ')'}, {'[', ']'}, {'{', '}'}}),
+      m_ignoredFormats({"String", "Comment"}), m_root(nullptr), m_seed(2463534242u)
+{
+    connect(document, &QTextDocument::contentsChange, this, &QBracketIndex::onContentsChange);
+
+    indexBlocks(0, m_document->characterCount());
+}
+
+QBracketIndex::~QBracketIndex()
+{
+    // The document may have been deleted first
+    if (!m_document)
+    {
+        return;
+    }
+
+    for (auto block = m_document->begin(); block.isValid(); block = block.next())
+    {
+        auto data = QCodeBlockData::get(block);
+        if (data && data->bracketIndex == this)
+        {
+            data->bracketIndex = nullptr;
+            data->brackets.clear();
+            data->bracketNode = QCodeBlockData::BracketNode();
+        }
+    }
+}
+
+void QBracketIndex::setPairs(const QVector<QPair<QChar, QChar>> &pairs)
+{
+    m_pairs.clear();
+
+    for (auto &pair : pairs)
+    {
+        if (pair.first != pair.second)
+        {
+            m_pairs.append(pair);
+        }
+    }
+
+    indexBlocks(0, m_document->characterCount());
+}
+
+void QBracketIndex::setIgnoredFormats(const QStringList &names)
+{
+    m_ignoredFormats = names;
+
+    indexBlocks(0, m_document->characterCount());
+}
+
+bool QBracketIndex::isOpeningBracket(int position) const
+{
+    auto bracket = bracketAt(position);
+    return bracket && bracket->open;
+}
+
+bool QBracketIndex::isClosingBracket(int position) const
+{
+    auto bracket = bracketAt(position);
+    return bracket && !bracket->open;
+}
+
+int QBracketIndex::matchingBracket(int position, bool *mismatch) const
+{
+    auto bracket = bracketAt(position);
+    if (!bracket)
+    {
+        return -1;
+    }
+
+    auto match = bracket->open ? findClosing(position + 1, 1) : findOpening(position, 1);
+
+    if (mismatch && match >= 0)
+    {
+        *mismatch = bracketAt(match)->pair != bracket->pair;
+    }
+
+    return match;
+}
+
+QPair<int, int> QBracketIndex::enclosingBrackets(int from, int to) const
+{
+    for (auto open = findOpening(from, 1); open >= 0; open = findOpening(open, 1))
+    {
+        auto close = findClosing(open + 1, 1);
+
+        if (close >= to && close >= from)
+        {
+            return {open, close};
+        }
+    }
+
+    return {-1, -1};
+}
+
+int QBracketIndex::depth(const QTextBlock &block) const
+{
+    const int position = block.position();
+    int result = 0;
+
+    for (auto node = m_root; node;)
+    {
+        if (node->block.position() < position)
+        {
+            result += total(node->bracketNode.left).delta + own(node).delta;
+            node = node->bracketNode.right;
+        }
+        else
+        {
+            node = node->bracketNode.left;
+        }
+    }
+
+    return result;
+}
+
+QVector<QCodeBlockData::Bracket> QBracketIndex::brackets(const QTextBlock &block) const
+{
+    auto data = QCodeBlockData::get(block);
+    return data && data->bracketIndex == this ? data->brackets : QVector<QCodeBlockData::Bracket>();
+}
+
+void QBracketIndex::removeBlock(QCodeBlockData *data)
+{
+    if (data->bracketNode.linked)
+    {
+        unlink(data);
+    }
+
+    data->brackets.clear();
+}
+
+void QBracketIndex::onContentsChange(int position, int, int charsAdded)
+{
+    // Removed blocks are dropped by QCodeBlockData
+    indexBlocks(position, position + charsAdded);
+}
+
+void QBracketIndex::indexBlocks(int from, int to)
+{
+    for (auto block = m_document->findBlock(from); block.isValid() && block.position() <= to; block = block.next())
+    {
+        indexBlock(block);
+    }
+}
+
+void QBracketIndex::indexBlock(const QTextBlock &block)
+{
+    QVector<QPair<int, int>> ignored;
+
+    if (auto layout = block.layout())
+    {
+#if QT_VERSION >= 0x050600
+        const auto formats = layout->formats();
+#else
+        const auto formats = layout->additionalFormats();
+#endif
+
+        for (auto &range : formats)
+        {
+            if (m_ignoredFormats.contains(range.format.property(QSyntaxStyle::FormatNameProperty).toString()))
+            {
+                ignored.append({range.start, range.start + range.length});
+            }
+        }
+    }
+
+    auto text = block.text();
+    QVector<QCodeBlockData::Bracket> brackets;
+    QCodeBlockData::BracketSummary summary;
+
+    for (int i = 0; i < text.size(); ++i)
+    {
+        for (int pair = 0; pair < m_pairs.size(); ++pair)
+        {
+            auto open = m_pairs[pair].first == text[i];
+            if (!open && m_pairs[pair].second != text[i])
+            {
+                continue;
+            }
+
+            auto skipped = std::any_of(ignored.begin(), ignored.end(),
+                                       [i](const QPair<int, int> &r) { return i >= r.first && i < r.second; });
+
+            if (!skipped)
+            {
+                brackets.append({i, pair, open});
+
+                summary.delta += open ? 1 : -1;
+                summary.minPrefix = qMin(summary.minPrefix, summary.delta);
+            }
+
+            break;
+        }
+    }
+
+    auto data = QCodeBlockData::get(block, !brackets.isEmpty());
+    if (!data)
+    {
+        return;
+    }
+
+    data->brackets = brackets;
+    data->bracketNode.own = summary;
+    data->bracketIndex = this;
+
+    if (brackets.isEmpty())
+    {
+        if (data->bracketNode.linked)
+        {
+            unlink(data);
+        }
+    }
+    else if (!data->bracketNode.linked)
+    {
+        link(data);
+    }
+    else
+    {
+        for (auto node = data; node; node = node->bracketNode.parent)
+        {
+            pull(node);
+        }
+    }
+}
+
+const QCodeBlockData::Bracket *QBracketIndex::bracketAt(int position) const
+{
+    auto block = m_document->findBlock(position);
+    auto data = QCodeBlockData::get(block);
+    if (!data)
+    {
+        return nullptr;
+    }
+
+    const int column = position - block.position();
+    auto it = std::lower_bound(data->brackets.cbegin(), data->brackets.cend(), column,
+                               [](const QCodeBlockData::Bracket &b, int c) { return b.column < c; });
+
+    return it != data->brackets.cend() && it->column == column ? &*it : nullptr;
+}
+
+int QBracketIndex::findClosing(int from, int depth) const
+{
+    auto block = m_document->findBlock(from);
+    if (!block.isValid())
+    {
+        return -1;
+    }
+
+    if (auto data = QCodeBlockData::get(block))
+    {
+        for (auto &bracket : qAsConst(data->brackets))
+        {
+            if (bracket.column < from - block.position())
+            {
+                continue;
+            }
+
+            depth += bracket.open ? 1 : -1;
+            if (depth == 0)
+            {
+                return block.position() + bracket.column;
+            }
+        }
+    }
+
+    auto node = firstAfter(block.position());
+    if (!node)
+    {
+        return -1;
+    }
+
+    int acc = 0;
+    if (own(node).minPrefix > -depth)
+    {
+        acc = own(node).delta;
+        node = searchForward(node, acc, -depth);
+    }
+
+    if (!node)
+    {
+        return -1;
+    }
+
+    depth += acc;
+
+    for (auto &bracket : qAsConst(node->brackets))
+    {
+        depth += bracket.open ? 1 : -1;
+        if (depth == 0)
+        {
+            return node->block.position() + bracket.column;
+        }
+    }
+
+    return -1;
+}
+
+int QBracketIndex::findOpening(int to, int depth) const
+{
+    auto block = m_document->findBlock(to);
+    if (!block.isValid())
+    {
+        block = m_document->lastBlock();
+    }
+
+    if (auto data = QCodeBlockData::get(block))
+    {
+        for (auto it = data->brackets.crbegin(); it != data->brackets.crend(); ++it)
+        {
+            if (it->column >= to - block.position())
+            {
+                continue;
+            }
+
+            depth += it->open ? -1 : 1;
+            if (depth == 0)
+            {
+                return block.position() + it->column;
+            }
+        }
+    }
+
+    auto node = lastBefore(block.position());
+    if (!node)
+    {
+        return -1;
+    }
+
+    int acc = 0;
+    if (maxSuffix(own(node)) < depth)
+    {
+        acc = own(node).delta;
+        node = searchBackward(node, acc, depth);
+    }
+
+    if (!node)
+    {
+        return -1;
+    }
+
+    depth -= acc;
+
+    for (auto it = node->brackets.crbegin(); it != node->brackets.crend(); ++it)
+    {
+        depth += it->open ? -1 : 1;
+        if (depth == 0)
+        {
+            return node->block.position() + it->column;
+        }
+    }
+
+    return -1;
+}
+
+void QBracketIndex::link(QCodeBlockData *data)
+{
+    // xorshift32
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    auto &links = data->bracketNode;
+    links.left = links.right = links.parent = nullptr;
+    links.priority = m_seed;
+    links.linked = true;
+    links.total = links.own;
+
+    QCodeBlockData *left;
+    QCodeBlockData *right;
+    split(m_root, data->block.position(), left, right);
+
+    m_root = merge(merge(left, data), right);
+    m_root->bracketNode.parent = nullptr;
+}
+
+void QBracketIndex::unlink(QCodeBlockData *data)
+{
+    auto &links = data->bracketNode;
+    auto parent = links.parent;
+    auto child = merge(links.left, links.right);
+
+    if (child)
+    {
+        child->bracketNode.parent = parent;
+    }
+
+    if (!parent)
+    {
+        m_root = child;
+    }
+    else if (parent->bracketNode.left == data)
+    {
+        parent->bracketNode.left = child;
+    }
+    else
+    {
+        parent->bracketNode.right = child;
+    }
+
+    for (auto node = parent; node; node = node->bracketNode.parent)
+    {
+        pull(node);
+    }
+
+    links = QCodeBlockData::BracketNode();
+}
+
+QCodeBlockData *QBracketIndex::firstAfter(int position) const
+{
+    QCodeBlockData *result = nullptr;
+
+    for (auto node = m_root; node;)
+    {
+        if (node->block.position() > position)
+        {
+            result = node;
+            node = node->bracketNode.left;
+        }
+        else
+        {
+            node = node->bracketNode.right;
+        }
+    }
+
+    return result;
+}
+
+QCodeBlockData *QBracketIndex::lastBefore(int position) const
+{
+    QCodeBlockData *result = nullptr;
+
+    for (auto node = m_root; node;)
+    {
+        if (node->block.position() < position)
+        {
+            result = node;
+            node = node->bracketNode.right;
+        }
+        else
+        {
+            node = node->bracketNode.left;
+        }
+    }
+
+    return result;
+}
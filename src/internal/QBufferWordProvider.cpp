@@ -0,0 +1,51 @@
+// QCodeEditor
+#include <QBufferWordProvider>
+#include <QFuzzyCompleter>
+#include <QWordIndex>
+
+namespace
+{
+// Words matched between checks of cancellation
+constexpr int CancelCheckInterval = 256;
+} // namespace
+
+QBufferWordProvider::QBufferWordProvider(QWordIndex *index, QObject *parent)
+    : QCompletionProvider(parent), m_index(index), m_words(), m_revision(-1)
+{
+}
+
+void QBufferWordProvider::prepare(const Request &)
+{
+    if (m_index.isNull())
+    {
+        m_words.clear();
+        return;
+    }
+
+    if (m_index->revision() != m_revision)
+    {
+        m_words = m_index->words();
+        m_revision = m_index->revision();
+    }
+}
+
+QStringList QBufferWordProvider::complete(const Request &request)
+{
+    QStringList result;
+
+    for (int i = 0; i < m_words.size(); ++i)
+    {
+        if (i % CancelCheckInterval == 0 && request.isCancelled())
+        {
+            return {};
+        }
+
+        // The word being typed is in the document too
+        if (m_words[i] != request.prefix && QFuzzyCompleter::score(request.prefix, m_words[i]) >= 0)
+        {
+            result.append(m_words[i]);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,56 @@
+// QCodeEditor
+#include <QBracketIndex>
+#include <QCodeBlockData>
+#include <QOverviewRuler>
+#include <QScopeTree>
+#include <QTrigramIndex>
+#include <QWordIndex>
+
+QCodeBlockData::QCodeBlockData(const QTextBlock &textBlock)
+    : QTextBlockUserData(), block(textBlock), textHash(0), words(), wordIndex(nullptr), brackets(),
+      bracketNode(), bracketIndex(nullptr), wideCharacters(), scopeNode(), scopeTree(nullptr), folded(false),
+      minimapRuns(), minimapGeneration(-1), overviewRuler(nullptr),
+      trigrams(), trigramIndex(nullptr)
+{
+}
+
+QCodeBlockData::~QCodeBlockData()
+{
+    if (wordIndex)
+    {
+        wordIndex->removeBlock(this);
+    }
+
+    if (bracketIndex)
+    {
+        bracketIndex->removeBlock(this);
+    }
+
+    if (scopeTree)
+    {
+        scopeTree->removeBlock(this);
+    }
+
+    if (overviewRuler)
+    {
+        overviewRuler->removeBlock(this);
+    }
+
+    if (trigramIndex)
+    {
+        trigramIndex->removeBlock(this);
+    }
+}
+
+QCodeBlockData *QCodeBlockData::get(QTextBlock block, bool create)
+{
+    auto data = dynamic_cast<QCodeBlockData *>(block.userData());
+
+    if (!data && create)
+    {
+        data = new QCodeBlockData(block);
+        block.setUserData(data);
+    }
+
+    return data;
+}
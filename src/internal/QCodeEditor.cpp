@@ -1,12 +1,28 @@
 // QCodeEditor
+#include <QBracketIndex>
 #include <QCXXHighlighter>
 #include <QCodeEditor>
+#include <QCompletionEngine>
+#include <QDecorationManager>
+#include <QDiagnosticStore>
+#include <QDiagnosticColumn>
+#include <QFileLoader>
+#include <QFoldColumn>
+#include <QFoldingManager>
+#include <QFuzzyCompleter>
 #include <QJSHighlighter>
 #include <QJavaHighlighter>
 #include <QLineNumberArea>
+#include <QLineNumberColumn>
+#include <QMinimap>
+#include <QMultiCursor>
+#include <QOverviewRuler>
 #include <QPythonHighlighter>
+#include <QScopeTree>
 #include <QStyleSyntaxHighlighter>
 #include <QSyntaxStyle>
+#include <QTrigramIndex>
+#include <QWordIndex>
 
 // Qt
 #include <QAbstractItemView>
@@ -14,22 +30,172 @@
 #include <QCompleter>
 #include <QCursor>
 #include <QDebug>
+#include <QFile>
 #include <QFontDatabase>
 #include <QMimeData>
 #include <QPaintEvent>
+#include <QPainter>
+#include <QPainterPath>
 #include <QScrollBar>
 #include <QShortcut>
 #include <QTextBlock>
 #include <QTextCharFormat>
-#include <QTextStream>
+#include <QTextLayout>
+#include <QThread>
+#include <QTimer>
 #include <QToolTip>
 
+// std
+#include <algorithm>
+
+namespace
+{
+// The first chunk is small so that the first screen shows up immediately
+constexpr int FirstLoadChunkSize = 64 * 1024;
+constexpr int LoadChunkSize = 1024 * 1024;
+
+// Blocks highlighted at once in the background after loading
+constexpr int HighlightChunkBlocks = 1000;
+
+// Delay of occurrence highlighting after the selection changes, ms
+constexpr int OccurrenceDelay = 150;
+
+// Scopes stuck to the top of the viewport at most
+constexpr int MaxStickyHeaders = 5;
+
+// Built-in decoration layers
+constexpr auto CurrentLineLayer = "CurrentLine";
+constexpr auto RainbowBracketsLayer = "RainbowBrackets";
+constexpr auto OccurrencesLayer = "Occurrences";
+constexpr auto SearchResultsLayer = "SearchResults";
+constexpr auto SquigglesLayer = "Squiggles";
+constexpr auto SecondarySelectionsLayer = "SecondarySelections";
+constexpr auto ParenthesesLayer = "Parentheses";
+
+/**
+ * @brief The ReplacementPart struct, Literal text or a
+ * capture of the match, if `capture` isn't negative.
+ */
+struct ReplacementPart
+{
+    ReplacementPart(const QString &t = QString(), int c = -1) : text(t), capture(c)
+    {
+    }
+
+    QString text;
+    int capture;
+};
+
+/**
+ * @brief The ReplacementSpan struct, Text replacing
+ * [start, end) of the document.
+ */
+struct ReplacementSpan
+{
+    ReplacementSpan(int s = 0) : start(s), end(s), text()
+    {
+    }
+
+    int start;
+    int end;
+    QString text;
+};
+
+// Splits the replacement at `\N` references, taking two digits if there are that many captures
+QVector<ReplacementPart> replacementParts(const QString &replacement, int captureCount)
+{
+    QVector<ReplacementPart> parts;
+    QString text;
+
+    for (int i = 0; i < replacement.size(); ++i)
+    {
+        if (replacement[i] == '\\' && i + 1 < replacement.size() && replacement[i + 1].isDigit())
+        {
+            auto capture = replacement[i + 1].digitValue();
+            auto digits = 1;
+
+            if (i + 2 < replacement.size() && replacement[i + 2].isDigit() &&
+                capture * 10 + replacement[i + 2].digitValue() <= captureCount)
+            {
+                capture = capture * 10 + replacement[i + 2].digitValue();
+                digits = 2;
+            }
+
+            if (capture <= captureCount)
+            {
+                if (!text.isEmpty())
+                {
+                    parts.append(ReplacementPart(text));
+                    text.clear();
+                }
+
+                parts.append(ReplacementPart(QString(), capture));
+                i += digits;
+                continue;
+            }
+        }
+
+        text.append(replacement[i]);
+    }
+
+    if (!text.isEmpty())
+    {
+        parts.append(ReplacementPart(text));
+    }
+
+    return parts;
+}
+} // namespace
+
 QCodeEditor::QCodeEditor(QWidget *widget)
     : QTextEdit(widget), m_highlighter(nullptr), m_syntaxStyle(nullptr), m_lineNumberArea(new QLineNumberArea(this)),
-      m_completer(nullptr), m_autoIndentation(true), m_replaceTab(true), m_extraBottomMargin(true),
-      m_tabReplace(QString(4, ' ')), extra1(), extra2(), extra_squiggles(), m_squiggler(),
-      m_parentheses({{'(', ')'}, {'{', '}'}, {'[', ']'}, {'\"', '\"'}, {'\'', '\''}})
+      m_completer(nullptr), m_currentLineBlock(-1), m_autoIndentation(true), m_replaceTab(true),
+      m_extraBottomMargin(true), m_tabReplace(QString(4, ' ')), m_decorations(new QDecorationManager(document(), this)),
+      m_layerRects(), m_diagnostics(new QDiagnosticStore(document(), this)),
+      m_positionMapper(new QPositionMapper(document(), this)), m_positionEncoding(QPositionMapper::Encoding::Utf16),
+      m_parentheses({{'(', ')'}, {'{', '}'}, {'[', ']'}, {'\"', '\"'}, {'\'', '\''}}), m_loadThread(nullptr),
+      m_loader(nullptr), m_loadReadOnly(false), m_highlightBlock(-1),
+      m_highlightTimer(new QTimer(this)), m_encoding(QDocumentCodec::Encoding::Utf8),
+      m_lineEnding(QDocumentCodec::LineEnding::LF), m_invalidSequences(0), m_bulkEditDepth(0), m_bulkEditCursor(),
+      m_dirtyState(0), m_updateTimer(new QTimer(this)), m_wordIndex(new QWordIndex(document(), this)),
+      m_occurrenceTimer(new QTimer(this)), m_occurrenceWord(), m_bracketIndex(new QBracketIndex(document(), this)),
+      m_rainbowBrackets(true), m_bracketLevelFormats(), m_scopeTree(new QScopeTree(document(), m_bracketIndex, this)),
+      m_folding(new QFoldingManager(document(), m_scopeTree, this)), m_stickyHeaders(true), m_stickyHeaderBlocks(),
+      m_stickyHeaderHeight(0), m_breadcrumbs(), m_minimap(new QMinimap(this)),
+      m_overviewRuler(new QOverviewRuler(this)), m_changeFilter(document()),
+      m_findEngine(new QFindEngine(document(), this)), m_trigramIndex(new QTrigramIndex(document(), this)),
+      m_multiCursor(new QMultiCursor(this)), m_completionEngine(new QCompletionEngine(this)),
+      m_providerCompleter(nullptr)
 {
+    // Fires when the pending events are processed, so a burst of changes is handled once
+    m_updateTimer->setSingleShot(true);
+    m_updateTimer->setInterval(0);
+
+    m_occurrenceTimer->setSingleShot(true);
+    m_occurrenceTimer->setInterval(OccurrenceDelay);
+
+    // A chunk per pass of the event loop, input is handled in between
+    m_highlightTimer->setInterval(0);
+
+    m_decorations->addLayer(CurrentLineLayer, 0);
+    m_decorations->addLayer(RainbowBracketsLayer, 5, QDecorationManager::Rendering::ExtraSelection);
+    m_decorations->addLayer(OccurrencesLayer, 10);
+    m_decorations->addLayer(SearchResultsLayer, 15);
+    m_decorations->addLayer(SquigglesLayer, 20);
+    m_decorations->addLayer(SecondarySelectionsLayer, 25);
+    // Changes the text color, so it's left to QTextEdit
+    m_decorations->addLayer(ParenthesesLayer, 30, QDecorationManager::Rendering::ExtraSelection);
+
+    setParentheses(m_parentheses);
+
+    m_lineNumberArea->addColumn(new QDiagnosticColumn(this));
+    m_lineNumberArea->addColumn(new QLineNumberColumn(this));
+    m_lineNumberArea->addColumn(new QFoldColumn(this));
+
+    m_minimap->setVisible(false);
+
+    setVerticalScrollBar(m_overviewRuler);
+
     initFont();
     performConnections();
     setMouseTracking(true);
@@ -37,6 +203,16 @@ QCodeEditor::QCodeEditor(QWidget *widget)
     setSyntaxStyle(QSyntaxStyle::defaultStyle());
 }
 
+QCodeEditor::~QCodeEditor()
+{
+    if (m_loadThread)
+    {
+        auto thread = m_loadThread;
+        cancelLoading();
+        thread->wait();
+    }
+}
+
 void QCodeEditor::initFont()
 {
     auto fnt = QFontDatabase::systemFont(QFontDatabase::FixedFont);
@@ -48,13 +224,131 @@ void QCodeEditor::initFont()
 
 void QCodeEditor::performConnections()
 {
-    connect(document(), &QTextDocument::blockCountChanged, this, &QCodeEditor::updateLineNumberAreaWidth);
     connect(document(), &QTextDocument::blockCountChanged, this, &QCodeEditor::updateBottomMargin);
 
-    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int) { m_lineNumberArea->update(); });
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this](int) {
+        scheduleUpdate(VisibleOccurrencesDirty | VisibleBracketsDirty | VisibleDiagnosticsDirty | ScopesDirty |
+                       VisibleSearchResultsDirty | VisibleSecondaryCursorsDirty | VisibleHighlightingDirty);
+        m_minimap->update();
+    });
+
+    connect(m_scopeTree, &QScopeTree::scopesChanged, this, [this](int, int) { scheduleUpdate(ScopesDirty); });
+    connect(m_folding, &QFoldingManager::foldingChanged, this, [this]() { scheduleUpdate(ScopesDirty); });
+
+    // Rows of the line number area are repainted along with the relaid out text
+    connect(document()->documentLayout(), &QAbstractTextDocumentLayout::update, this, [this](const QRectF &rect) {
+        auto offset = verticalScrollBar()->value();
+        auto top = qMax(rect.top() - offset, 0.0);
+        auto bottom = qMin(rect.bottom() - offset, static_cast<qreal>(viewport()->height()));
+
+        if (top <= bottom)
+        {
+            m_lineNumberArea->update(0, static_cast<int>(top), m_lineNumberArea->width(),
+                                     static_cast<int>(bottom - top) + 2);
+        }
+    });
+
+    // Brackets change with the text and with the highlighting
+    connect(document(), &QTextDocument::contentsChange, this, [this](int, int, int) {
+        if (m_rainbowBrackets)
+        {
+            scheduleUpdate(VisibleBracketsDirty);
+        }
+    });
 
     connect(this, &QTextEdit::cursorPositionChanged, this, &QCodeEditor::updateExtraSelection1);
+    connect(this, &QTextEdit::cursorPositionChanged, this, [this]() { scheduleUpdate(ScopesDirty); });
+
+    // The cursor can't stay in a folded region
+    connect(this, &QTextEdit::cursorPositionChanged, this, [this]() {
+        auto block = textCursor().block();
+        if (!block.isVisible())
+        {
+            m_folding->reveal(block);
+        }
+    });
     connect(this, &QTextEdit::selectionChanged, this, &QCodeEditor::updateExtraSelection2);
+
+    connect(m_decorations, &QDecorationManager::layerChanged, this,
+            [this](const QString &) { scheduleUpdate(DecorationsDirty); });
+
+    connect(m_diagnostics, &QDiagnosticStore::changed, this, [this]() {
+        m_lineNumberArea->update();
+        scheduleUpdate(VisibleDiagnosticsDirty | OverviewDiagnosticsDirty);
+    });
+
+    // Lines changed since the document was last unmodified
+    connect(document(), &QTextDocument::contentsChange, this, [this](int position, int charsRemoved, int charsAdded) {
+        // Format changes (e.g. by the highlighter) are reported this way too
+        if (!m_changeFilter.isTextChange(charsRemoved, charsAdded))
+        {
+            return;
+        }
+
+        auto last = document()->findBlock(position + charsAdded);
+        for (auto block = document()->findBlock(position); block.isValid(); block = block.next())
+        {
+            if (m_overviewRuler->markerCount(QOverviewRuler::Lane::Changes, block) == 0)
+            {
+                m_overviewRuler->addMarker(QOverviewRuler::Lane::Changes, block);
+            }
+
+            if (block == last)
+            {
+                break;
+            }
+        }
+    });
+
+    connect(document(), &QTextDocument::modificationChanged, this, [this](bool modified) {
+        if (!modified)
+        {
+            m_overviewRuler->clearMarkers(QOverviewRuler::Lane::Changes);
+        }
+    });
+
+    m_findEngine->setTrigramIndex(m_trigramIndex);
+
+    // Hits are streamed in while the search runs
+    connect(m_findEngine, &QFindEngine::hitsAdded, this, [this](int, const QVector<QFindEngine::Hit> &hits) {
+        QVector<int> positions;
+        positions.reserve(hits.size());
+
+        for (auto &hit : hits)
+        {
+            positions.append(hit.start);
+        }
+
+        m_overviewRuler->addMarkers(QOverviewRuler::Lane::SearchResults, positions);
+        scheduleUpdate(VisibleSearchResultsDirty);
+    });
+
+    connect(m_findEngine, &QFindEngine::hitsReset, this, [this](int) {
+        QVector<int> positions;
+
+        for (auto &hit : m_findEngine->hits())
+        {
+            positions.append(hit.start);
+        }
+
+        m_overviewRuler->setMarkers(QOverviewRuler::Lane::SearchResults, positions);
+        scheduleUpdate(VisibleSearchResultsDirty);
+    });
+
+    // Carets aren't decorations, they're painted over the text
+    connect(m_multiCursor, &QMultiCursor::changed, this, [this]() {
+        viewport()->update();
+        scheduleUpdate(VisibleSecondaryCursorsDirty);
+    });
+
+    // Completions are streamed in while the providers answer
+    connect(m_completionEngine, &QCompletionEngine::resultsChanged, this, &QCodeEditor::updateProviderCompletions);
+
+    connect(m_updateTimer, &QTimer::timeout, this, &QCodeEditor::flushUpdates);
+    connect(m_occurrenceTimer, &QTimer::timeout, this, &QCodeEditor::updateOccurrenceWord);
+    connect(m_highlightTimer, &QTimer::timeout, this, &QCodeEditor::highlightNextBlocks);
+
+    scheduleUpdate(LineNumberAreaWidthDirty);
 }
 
 void QCodeEditor::setHighlighter(QStyleSyntaxHighlighter *highlighter)
@@ -66,11 +360,23 @@ void QCodeEditor::setHighlighter(QStyleSyntaxHighlighter *highlighter)
 
     m_highlighter = highlighter;
 
+    // The new highlighter goes over the whole document itself
+    m_highlightTimer->stop();
+    m_highlightBlock = -1;
+
     if (m_highlighter)
     {
         m_highlighter->setSyntaxStyle(m_syntaxStyle);
-        m_highlighter->setDocument(document());
+
+        // Attached once the file is loaded
+        if (!isLoading())
+        {
+            m_highlighter->setDocument(document());
+        }
     }
+
+    m_folding->unfoldAll();
+    m_scopeTree->setMode(m_highlighter ? m_highlighter->foldingMode() : QStyleSyntaxHighlighter::FoldingMode::None);
 }
 
 void QCodeEditor::setSyntaxStyle(QSyntaxStyle *style)
@@ -84,9 +390,21 @@ void QCodeEditor::setSyntaxStyle(QSyntaxStyle *style)
         m_highlighter->setSyntaxStyle(m_syntaxStyle);
     }
 
+    m_minimap->invalidate();
+
     updateStyle();
 }
 
+QSyntaxStyle *QCodeEditor::syntaxStyle() const
+{
+    return m_syntaxStyle;
+}
+
+QLineNumberArea *QCodeEditor::lineNumberArea() const
+{
+    return m_lineNumberArea;
+}
+
 void QCodeEditor::updateStyle()
 {
     if (m_highlighter)
@@ -94,8 +412,15 @@ void QCodeEditor::updateStyle()
         m_highlighter->rehighlight();
     }
 
+    m_bracketLevelFormats.clear();
+
     if (m_syntaxStyle)
     {
+        for (int level = 1; m_syntaxStyle->hasFormat(QString("Parentheses.Level%1").arg(level)); ++level)
+        {
+            m_bracketLevelFormats.append(m_syntaxStyle->getFormat(QString("Parentheses.Level%1").arg(level)));
+        }
+
         QString backgroundColor = m_syntaxStyle->getFormat("Text").background().color().name();
         QString textColor = m_syntaxStyle->getFormat("Text").foreground().color().name();
         QString selectionBackground = m_syntaxStyle->getFormat("Selection").background().color().name();
@@ -106,6 +431,7 @@ void QCodeEditor::updateStyle()
 
     updateExtraSelection1();
     updateExtraSelection2();
+    scheduleUpdate(VisibleBracketsDirty | VisibleDiagnosticsDirty | VisibleSearchResultsDirty);
 }
 
 void QCodeEditor::resizeEvent(QResizeEvent *e)
@@ -113,14 +439,34 @@ void QCodeEditor::resizeEvent(QResizeEvent *e)
     QTextEdit::resizeEvent(e);
 
     updateLineGeometry();
-    updateBottomMargin();
+    scheduleUpdate(BottomMarginDirty | VisibleOccurrencesDirty | VisibleBracketsDirty | VisibleDiagnosticsDirty |
+                   ScopesDirty | VisibleSearchResultsDirty);
 }
 
 void QCodeEditor::changeEvent(QEvent *e)
 {
     QTextEdit::changeEvent(e);
     if (e->type() == QEvent::FontChange)
-        updateBottomMargin();
+    {
+        m_lineNumberArea->invalidate();
+        scheduleUpdate(BottomMarginDirty | LineNumberAreaWidthDirty);
+    }
+}
+
+void QCodeEditor::scrollContentsBy(int dx, int dy)
+{
+    QTextEdit::scrollContentsBy(dx, dy);
+
+    if (dy != 0)
+    {
+        m_lineNumberArea->scroll(0, dy);
+
+        // The headers have been scrolled along with the text
+        if (m_stickyHeaderHeight > 0)
+        {
+            viewport()->update(0, 0, viewport()->width(), m_stickyHeaderHeight + qAbs(dy));
+        }
+    }
 }
 
 void QCodeEditor::wheelEvent(QWheelEvent *e)
@@ -154,12 +500,74 @@ void QCodeEditor::updateLineGeometry()
 {
     QRect cr = contentsRect();
     m_lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), m_lineNumberArea->sizeHint().width(), cr.height()));
+
+    if (!m_minimap->isHidden())
+    {
+        m_minimap->setGeometry(
+            QRect(viewport()->geometry().right() + 1, cr.top(), m_minimap->sizeHint().width(), cr.height()));
+    }
 }
 
 void QCodeEditor::updateBottomMargin()
 {
+    scheduleUpdate(BottomMarginDirty);
+}
+
+void QCodeEditor::updateLineNumberAreaWidth(int)
+{
+    scheduleUpdate(LineNumberAreaWidthDirty);
+}
+
+void QCodeEditor::updateLineNumberArea(QRect rect)
+{
+    m_lineNumberArea->update(0, rect.y(), m_lineNumberArea->width(), rect.height());
+}
+
+void QCodeEditor::updateExtraSelection1()
+{
+    scheduleUpdate(CurrentLineDirty);
+}
+
+void QCodeEditor::updateExtraSelection2()
+{
+    scheduleUpdate(OccurrencesDirty);
+}
+
+void QCodeEditor::scheduleUpdate(int state)
+{
+    m_dirtyState |= state;
+
+    // A bulk edit flushes when it ends
+    if (m_bulkEditDepth == 0 && !m_updateTimer->isActive())
+    {
+        m_updateTimer->start();
+    }
+}
+
+void QCodeEditor::flushUpdates()
+{
+    if (m_bulkEditDepth > 0)
+    {
+        return;
+    }
+
+    auto state = m_dirtyState;
+    m_dirtyState = 0;
+
+    if (state & LineNumberAreaWidthDirty)
+    {
+        auto width = m_lineNumberArea->sizeHint().width();
+        auto minimapWidth = m_minimap->isHidden() ? 0 : m_minimap->sizeHint().width();
+        if (viewportMargins().left() != width || viewportMargins().right() != minimapWidth)
+        {
+            setViewportMargins(width, 0, minimapWidth, 0);
+        }
+
+        updateLineGeometry();
+    }
+
     auto doc = document();
-    if (doc->blockCount() > 1)
+    if ((state & BottomMarginDirty) && doc->blockCount() > 1)
     {
         // calling QTextFrame::setFrameFormat with an empty document makes the application crash
         auto rf = doc->rootFrame();
@@ -174,41 +582,168 @@ void QCodeEditor::updateBottomMargin()
             rf->setFrameFormat(format);
         }
     }
+
+    if (state & CurrentLineDirty)
+    {
+        highlightCurrentLine();
+        highlightParenthesis();
+    }
+
+    if ((state & OccurrencesDirty) && !textCursor().hasSelection())
+    {
+        // Clearing is cheap, no reason to wait
+        m_occurrenceTimer->stop();
+        if (!m_occurrenceWord.isEmpty())
+        {
+            updateOccurrenceWord();
+        }
+    }
+    else if (state & OccurrencesDirty)
+    {
+        // Restarted on each change, so a fast selection only looks up its final word
+        m_occurrenceTimer->start();
+    }
+    else if ((state & VisibleOccurrencesDirty) && !m_occurrenceWord.isEmpty())
+    {
+        highlightOccurrences();
+    }
+
+    if (state & VisibleBracketsDirty)
+    {
+        highlightBracketLevels();
+    }
+
+    if (state & VisibleDiagnosticsDirty)
+    {
+        highlightDiagnostics();
+    }
+
+    if (state & ScopesDirty)
+    {
+        updateScopes();
+    }
+
+    if (state & OverviewDiagnosticsDirty)
+    {
+        markDiagnostics();
+    }
+
+    if (state & VisibleSearchResultsDirty)
+    {
+        highlightSearchResults();
+    }
+
+    if (state & VisibleSecondaryCursorsDirty)
+    {
+        highlightSecondarySelections();
+    }
+
+    if (state & VisibleHighlightingDirty)
+    {
+        highlightVisibleBlocks();
+    }
+
+    // Layers changed above are applied in this pass as well
+    if ((state | m_dirtyState) & DecorationsDirty)
+    {
+        m_dirtyState &= ~DecorationsDirty;
+        applyDecorations();
+    }
+
+    if (m_dirtyState == 0)
+    {
+        m_updateTimer->stop();
+    }
 }
 
-void QCodeEditor::updateLineNumberAreaWidth(int)
+void QCodeEditor::applyDecorations()
 {
-    setViewportMargins(m_lineNumberArea->sizeHint().width(), 0, 0, 0);
+    bool extraSelections = false;
+
+    // Rectangles are kept in document coordinates, so they stay valid while scrolling
+    QPoint offset(horizontalScrollBar()->value(), verticalScrollBar()->value());
+
+    for (auto &layer : m_decorations->takeDirtyLayers())
+    {
+        if (m_decorations->rendering(layer) == QDecorationManager::Rendering::ExtraSelection)
+        {
+            extraSelections = true;
+            continue;
+        }
+
+        // Only the area the layer covered before and covers now is repainted
+        auto rect = layerBoundingRect(layer);
+        auto dirty = m_layerRects.value(layer).united(rect);
+
+        if (rect.isNull())
+        {
+            m_layerRects.remove(layer);
+        }
+        else
+        {
+            m_layerRects.insert(layer, rect);
+        }
+
+        if (!dirty.isNull())
+        {
+            viewport()->update(dirty.translated(-offset));
+        }
+    }
+
+    if (extraSelections)
+    {
+        QList<QTextEdit::ExtraSelection> selections;
+
+        for (auto &layer : m_decorations->layers())
+        {
+            if (m_decorations->rendering(layer) != QDecorationManager::Rendering::ExtraSelection)
+            {
+                continue;
+            }
+
+            for (auto &decoration : m_decorations->decorations(layer))
+            {
+                QTextEdit::ExtraSelection selection{};
+                selection.cursor = QTextCursor(document());
+                selection.cursor.setPosition(decoration.start);
+                selection.cursor.setPosition(decoration.end, QTextCursor::KeepAnchor);
+                selection.format = decoration.format;
+                selections.append(selection);
+            }
+        }
+
+        setExtraSelections(selections);
+    }
 }
 
-void QCodeEditor::updateLineNumberArea(QRect rect)
+void QCodeEditor::beginBulkEdit()
 {
-    m_lineNumberArea->update(0, rect.y(), m_lineNumberArea->sizeHint().width(), rect.height());
-    updateLineGeometry();
-
-    if (rect.contains(viewport()->rect()))
+    if (m_bulkEditDepth++ == 0)
     {
-        updateLineNumberAreaWidth(0);
+        // Within an edit block the document coalesces its change signals,
+        // so the highlighter runs once over the union of changed ranges
+        m_bulkEditCursor = QTextCursor(document());
+        m_bulkEditCursor.beginEditBlock();
     }
 }
 
-void QCodeEditor::updateExtraSelection1()
+void QCodeEditor::endBulkEdit()
 {
-    extra1.clear();
+    if (m_bulkEditDepth == 0 || --m_bulkEditDepth > 0)
+    {
+        return;
+    }
 
-    highlightCurrentLine();
-    highlightParenthesis();
+    m_bulkEditCursor.endEditBlock();
+    m_bulkEditCursor = QTextCursor();
 
-    setExtraSelections(extra1 + extra2 + extra_squiggles);
+    // Recompute what has been marked dirty during the edit once
+    flushUpdates();
 }
 
-void QCodeEditor::updateExtraSelection2()
+bool QCodeEditor::isInBulkEdit() const
 {
-    extra2.clear();
-
-    highlightOccurrences();
-
-    setExtraSelections(extra1 + extra2 + extra_squiggles);
+    return m_bulkEditDepth > 0;
 }
 
 void QCodeEditor::indent()
@@ -224,23 +759,30 @@ void QCodeEditor::unindent()
 void QCodeEditor::swapLineUp()
 {
     auto cursor = textCursor();
-    auto lines = toPlainText().remove('\r').split('\n');
     int selectionStart = cursor.selectionStart();
     int selectionEnd = cursor.selectionEnd();
     bool cursorAtEnd = cursor.position() == selectionEnd;
-    cursor.setPosition(selectionStart);
-    int lineStart = cursor.blockNumber();
-    cursor.setPosition(selectionEnd);
-    int lineEnd = cursor.blockNumber();
+    auto firstBlock = document()->findBlock(selectionStart);
+    auto lastBlock = document()->findBlock(selectionEnd);
 
-    if (lineStart == 0)
+    auto previous = firstBlock.previous();
+    if (!previous.isValid())
         return;
-    selectionStart -= lines[lineStart - 1].length() + 1;
-    selectionEnd -= lines[lineStart - 1].length() + 1;
-    lines.move(lineStart - 1, lineEnd);
 
-    cursor.select(QTextCursor::Document);
-    cursor.insertText(lines.join('\n'));
+    // Move the line above the selection below it, only these blocks are touched
+    auto text = previous.text();
+    int lastBlockEnd = lastBlock.position() + lastBlock.length() - 1 - (text.length() + 1);
+
+    cursor.beginEditBlock();
+    cursor.setPosition(previous.position());
+    cursor.setPosition(firstBlock.position(), QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    cursor.setPosition(lastBlockEnd);
+    cursor.insertText("\n" + text);
+    cursor.endEditBlock();
+
+    selectionStart -= text.length() + 1;
+    selectionEnd -= text.length() + 1;
 
     if (cursorAtEnd)
     {
@@ -259,23 +801,30 @@ void QCodeEditor::swapLineUp()
 void QCodeEditor::swapLineDown()
 {
     auto cursor = textCursor();
-    auto lines = toPlainText().remove('\r').split('\n');
     int selectionStart = cursor.selectionStart();
     int selectionEnd = cursor.selectionEnd();
     bool cursorAtEnd = cursor.position() == selectionEnd;
-    cursor.setPosition(selectionStart);
-    int lineStart = cursor.blockNumber();
-    cursor.setPosition(selectionEnd);
-    int lineEnd = cursor.blockNumber();
+    auto firstBlock = document()->findBlock(selectionStart);
+    auto lastBlock = document()->findBlock(selectionEnd);
 
-    if (lineEnd == document()->blockCount() - 1)
+    auto next = lastBlock.next();
+    if (!next.isValid())
         return;
-    selectionStart += lines[lineEnd + 1].length() + 1;
-    selectionEnd += lines[lineEnd + 1].length() + 1;
-    lines.move(lineEnd + 1, lineStart);
 
-    cursor.select(QTextCursor::Document);
-    cursor.insertText(lines.join('\n'));
+    // Move the line below the selection above it, only these blocks are touched
+    auto text = next.text();
+    int firstBlockStart = firstBlock.position();
+
+    cursor.beginEditBlock();
+    cursor.setPosition(next.position() - 1);
+    cursor.setPosition(next.position() + next.length() - 1, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    cursor.setPosition(firstBlockStart);
+    cursor.insertText(text + "\n");
+    cursor.endEditBlock();
+
+    selectionStart += text.length() + 1;
+    selectionEnd += text.length() + 1;
 
     if (cursorAtEnd)
     {
@@ -414,284 +963,830 @@ void QCodeEditor::toggleBlockComment()
     setTextCursor(cursor);
 }
 
-void QCodeEditor::highlightParenthesis()
+int QCodeEditor::bracketUnderCursor() const
 {
-    auto currentSymbol = charUnderCursor();
-    auto prevSymbol = charUnderCursor(-1);
+    auto position = textCursor().position();
 
-    for (auto &p : m_parentheses)
+    if (m_bracketIndex->isOpeningBracket(position))
     {
-        int direction;
+        return position;
+    }
 
-        QChar counterSymbol;
-        QChar activeSymbol;
-        auto position = textCursor().position();
+    if (position > 0 && m_bracketIndex->isClosingBracket(position - 1))
+    {
+        return position - 1;
+    }
 
-        if (p.left == currentSymbol)
-        {
-            direction = 1;
-            counterSymbol = p.right;
-            activeSymbol = currentSymbol;
-        }
-        else if (p.right == prevSymbol)
+    return -1;
+}
+
+void QCodeEditor::highlightParenthesis()
+{
+    QVector<QDecorationManager::Decoration> decorations;
+
+    auto bracket = bracketUnderCursor();
+
+    if (bracket >= 0)
+    {
+        bool mismatch = false;
+        auto match = m_bracketIndex->matchingBracket(bracket, &mismatch);
+
+        auto format = m_syntaxStyle->getFormat(match < 0 || mismatch ? "ParenthesesMismatch" : "Parentheses");
+
+        decorations.append({bracket, bracket + 1, format});
+
+        if (match >= 0)
         {
-            direction = -1;
-            counterSymbol = p.left;
-            activeSymbol = prevSymbol;
-            position--;
+            decorations.append({match, match + 1, format});
         }
-        else
+    }
+
+    m_decorations->setDecorations(ParenthesesLayer, decorations);
+}
+
+void QCodeEditor::highlightBracketLevels()
+{
+    QVector<QDecorationManager::Decoration> decorations;
+
+    if (m_rainbowBrackets && !m_bracketLevelFormats.isEmpty())
+    {
+        auto from = cursorForPosition(QPoint(0, 0)).block();
+        auto to = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).position();
+
+        auto depth = m_bracketIndex->depth(from);
+
+        for (auto block = from; block.isValid() && block.position() <= to; block = block.next())
         {
-            continue;
+            for (auto &bracket : m_bracketIndex->brackets(block))
+            {
+                auto level = bracket.open ? depth++ : --depth;
+
+                // Unmatched closing brackets have no level
+                if (level < 0)
+                {
+                    continue;
+                }
+
+                auto position = block.position() + bracket.column;
+                decorations.append(
+                    {position, position + 1, m_bracketLevelFormats[level % m_bracketLevelFormats.size()]});
+            }
         }
+    }
 
-        auto counter = 1;
+    m_decorations->setDecorations(RainbowBracketsLayer, decorations);
+}
+
+void QCodeEditor::updateScopes()
+{
+    QVector<int> stickyHeaderBlocks;
+    auto rowHeight = fontMetrics().height();
+    int height = 0;
 
-        while (counter != 0 && position > 0 && position < (document()->characterCount() - 1))
+    if (m_stickyHeaders)
+    {
+        // Scopes of the top line not covered by the headers, the
+        // second pass accounts for the rows of the first one
+        for (int pass = 0; pass < 2; ++pass)
         {
-            // Moving position
-            position += direction;
+            auto top = cursorForPosition(QPoint(0, height)).block();
+            stickyHeaderBlocks.clear();
 
-            auto character = document()->characterAt(position);
-            // Checking symbol under position
-            if (character == activeSymbol)
+            for (auto &scope : m_scopeTree->enclosingScopes(top))
             {
-                ++counter;
+                auto title = scopeTitle(scope);
+                if (title.blockNumber() < top.blockNumber())
+                {
+                    stickyHeaderBlocks.append(title.blockNumber());
+                }
             }
-            else if (character == counterSymbol)
+
+            // The innermost scopes are the most useful ones
+            if (stickyHeaderBlocks.size() > MaxStickyHeaders)
             {
-                --counter;
+                stickyHeaderBlocks.remove(0, stickyHeaderBlocks.size() - MaxStickyHeaders);
             }
+
+            height = static_cast<int>(stickyHeaderBlocks.size()) * rowHeight;
         }
+    }
+
+    if (stickyHeaderBlocks != m_stickyHeaderBlocks)
+    {
+        m_stickyHeaderBlocks = stickyHeaderBlocks;
+        viewport()->update(0, 0, viewport()->width(), qMax(height, m_stickyHeaderHeight));
+        m_stickyHeaderHeight = height;
+    }
+
+    QStringList breadcrumbs;
+    for (auto &scope : m_scopeTree->enclosingScopes(textCursor().block()))
+    {
+        breadcrumbs.append(scopeTitle(scope).text().trimmed());
+    }
+
+    if (breadcrumbs != m_breadcrumbs)
+    {
+        m_breadcrumbs = breadcrumbs;
+        Q_EMIT breadcrumbsChanged(m_breadcrumbs);
+    }
+}
+
+QTextBlock QCodeEditor::scopeTitle(const QTextBlock &block) const
+{
+    auto text = block.text();
+    auto named = std::any_of(text.cbegin(), text.cend(), [](QChar c) { return c.isLetterOrNumber(); });
+
+    if (named)
+    {
+        return block;
+    }
+
+    auto previous = block.previous();
+    while (previous.isValid() && previous.text().trimmed().isEmpty())
+    {
+        previous = previous.previous();
+    }
+
+    return previous.isValid() ? previous : block;
+}
+
+void QCodeEditor::paintSecondaryCursors(QPainter &painter, const QRect &rect)
+{
+    if (m_multiCursor->isEmpty())
+    {
+        return;
+    }
+
+    // Whole lines, so carets at the line start aren't missed
+    auto from = cursorForPosition(QPoint(0, rect.top())).position();
+    auto to = cursorForPosition(QPoint(viewport()->width(), rect.bottom())).position();
+
+    auto color = m_syntaxStyle->getFormat("Text").foreground().color();
+
+    for (auto &cursor : m_multiCursor->cursors(from, to))
+    {
+        auto r = cursorRect(cursor);
+        painter.fillRect(r.x(), r.y(), cursorWidth(), r.height(), color);
+    }
+}
 
-        auto format = m_syntaxStyle->getFormat("Parentheses");
+void QCodeEditor::paintStickyHeaders(QPainter &painter)
+{
+    if (m_stickyHeaderBlocks.isEmpty())
+    {
+        return;
+    }
 
-        // Found
-        if (counter == 0)
+    auto background = m_syntaxStyle->getFormat("Text").background();
+    auto separator = m_syntaxStyle->getFormat("LineNumber").foreground().color();
+    auto x = -horizontalScrollBar()->value();
+
+    painter.setClipping(false);
+    painter.setPen(m_syntaxStyle->getFormat("Text").foreground().color());
+
+    qreal y = 0;
+    for (auto number : qAsConst(m_stickyHeaderBlocks))
+    {
+        auto block = document()->findBlockByNumber(number);
+        auto layout = block.layout();
+        if (!layout || layout->lineCount() == 0)
         {
-            ExtraSelection selection{};
+            continue;
+        }
+
+        // First line of the block, with its highlighting
+        auto line = layout->lineAt(0);
+        QRectF row(0, y, viewport()->width(), line.height());
 
-            auto directionEnum = direction < 0 ? QTextCursor::MoveOperation::Left : QTextCursor::MoveOperation::Right;
+        painter.fillRect(row, background);
+        layout->draw(&painter, QPointF(x, y - layout->position().y() - line.y()), {}, row);
 
-            selection.format = format;
-            selection.cursor = textCursor();
-            selection.cursor.clearSelection();
-            selection.cursor.movePosition(directionEnum, QTextCursor::MoveMode::MoveAnchor,
-                                          qAbs(textCursor().position() - position));
+        y += line.height();
+    }
 
-            selection.cursor.movePosition(QTextCursor::MoveOperation::Right, QTextCursor::MoveMode::KeepAnchor, 1);
+    painter.setPen(separator);
+    painter.drawLine(QPointF(0, y - 0.5), QPointF(viewport()->width(), y - 0.5));
+}
 
-            extra1.append(selection);
+void QCodeEditor::goToMatchingBracket()
+{
+    auto cursor = textCursor();
+    auto bracket = bracketUnderCursor();
 
-            selection.cursor = textCursor();
-            selection.cursor.clearSelection();
-            selection.cursor.movePosition(directionEnum, QTextCursor::MoveMode::KeepAnchor, 1);
+    if (bracket < 0)
+    {
+        // Not at a bracket, go to the enclosing one
+        auto scope = m_bracketIndex->enclosingBrackets(cursor.position(), cursor.position());
+        if (scope.first < 0)
+        {
+            return;
+        }
 
-            extra1.append(selection);
+        cursor.setPosition(scope.first);
+    }
+    else
+    {
+        auto match = m_bracketIndex->matchingBracket(bracket);
+        if (match < 0)
+        {
+            return;
         }
 
-        break;
+        // Before an opening and after a closing bracket, so going back works
+        cursor.setPosition(match < bracket ? match : match + 1);
     }
+
+    setTextCursor(cursor);
+}
+
+void QCodeEditor::selectEnclosingScope()
+{
+    auto cursor = textCursor();
+    auto start = cursor.selectionStart();
+    auto end = cursor.selectionEnd();
+
+    auto scope = m_bracketIndex->enclosingBrackets(start, end);
+    if (scope.first < 0 || scope.second < 0)
+    {
+        return;
+    }
+
+    // The content first, then the brackets, then the outer scope
+    if (start == scope.first + 1 && end == scope.second)
+    {
+        cursor.setPosition(scope.first);
+        cursor.setPosition(scope.second + 1, QTextCursor::KeepAnchor);
+    }
+    else
+    {
+        cursor.setPosition(scope.first + 1);
+        cursor.setPosition(scope.second, QTextCursor::KeepAnchor);
+    }
+
+    setTextCursor(cursor);
+}
+
+void QCodeEditor::toggleFold()
+{
+    m_folding->toggleFold(textCursor().block());
 }
 
 void QCodeEditor::highlightCurrentLine()
 {
+    QVector<QDecorationManager::Decoration> decorations;
+
     if (!isReadOnly())
     {
-        QTextEdit::ExtraSelection selection{};
+        auto format = m_syntaxStyle->getFormat("CurrentLine");
+        format.setForeground(QBrush());
+        format.setProperty(QTextFormat::FullWidthSelection, true);
+
+        auto position = textCursor().position();
+        decorations.append({position, position, format});
+    }
 
-        selection.format = m_syntaxStyle->getFormat("CurrentLine");
-        selection.format.setForeground(QBrush());
-        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
-        selection.cursor = textCursor();
-        selection.cursor.clearSelection();
+    m_decorations->setDecorations(CurrentLineLayer, decorations);
 
-        extra1.append(selection);
+    // Only the rows of the previous and the new current line change
+    auto block = textCursor().block();
+    if (block.blockNumber() != m_currentLineBlock)
+    {
+        m_lineNumberArea->updateBlock(document()->findBlockByNumber(m_currentLineBlock));
+        m_lineNumberArea->updateBlock(block);
+        m_currentLineBlock = block.blockNumber();
     }
 }
 
-void QCodeEditor::highlightOccurrences()
+void QCodeEditor::updateOccurrenceWord()
 {
     auto cursor = textCursor();
-    if (cursor.hasSelection())
+    auto text = cursor.selectedText();
+
+    m_occurrenceWord = QWordIndex::isWord(text) ? text : QString();
+
+    Q_EMIT occurrencesChanged(m_occurrenceWord, m_wordIndex->count(m_occurrenceWord));
+
+    m_overviewRuler->setMarkers(QOverviewRuler::Lane::Occurrences,
+                                m_occurrenceWord.isEmpty() ? QVector<int>()
+                                                           : m_wordIndex->occurrences(m_occurrenceWord));
+
+    highlightOccurrences();
+}
+
+void QCodeEditor::highlightOccurrences()
+{
+    QVector<QDecorationManager::Decoration> decorations;
+
+    if (!m_occurrenceWord.isEmpty())
     {
-        auto text = cursor.selectedText();
-        if (QRegularExpression(
-                R"((?:[_a-zA-Z][_a-zA-Z0-9]*)|(?<=\b|\s|^)(?i)(?:(?:(?:(?:(?:\d+(?:'\d+)*)?\.(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)\.(?:e[+-]?(?:\d+(?:'\d+)*))?)|(?:(?:\d+(?:'\d+)*)(?:e[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)?\.(?:[0-9a-f]+(?:'[0-9a-f]+)*)(?:p[+-]?(?:\d+(?:'\d+)*)))|(?:0x(?:[0-9a-f]+(?:'[0-9a-f]+)*)\.?(?:p[+-]?(?:\d+(?:'\d+)*))))[lf]?)|(?:(?:(?:[1-9]\d*(?:'\d+)*)|(?:0[0-7]*(?:'[0-7]+)*)|(?:0x[0-9a-f]+(?:'[0-9a-f]+)*)|(?:0b[01]+(?:'[01]+)*))(?:u?l{0,2}|l{0,2}u?)))(?=\b|\s|$))")
-                .match(text)
-                .captured() == text)
-        {
-            auto doc = document();
-            cursor = doc->find(text, 0, QTextDocument::FindWholeWords | QTextDocument::FindCaseSensitively);
-            while (!cursor.isNull())
+        QTextCharFormat format;
+        format.setBackground(m_syntaxStyle->getFormat("Selection").background());
+
+        auto from = cursorForPosition(QPoint(0, 0)).position();
+        auto to = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).position();
+        auto selectionStart = textCursor().selectionStart();
+
+        for (auto position : m_wordIndex->occurrences(m_occurrenceWord, from, to))
+        {
+            if (position != selectionStart)
             {
-                if (cursor != textCursor())
-                {
-                    QTextEdit::ExtraSelection e;
-                    e.cursor = cursor;
-                    e.format.setBackground(m_syntaxStyle->getFormat("Selection").background());
-                    extra2.push_back(e);
-                }
-                cursor = doc->find(text, cursor, QTextDocument::FindWholeWords | QTextDocument::FindCaseSensitively);
+                decorations.append({position, position + m_occurrenceWord.size(), format});
             }
         }
     }
+
+    m_decorations->setDecorations(OccurrencesLayer, decorations);
 }
 
-void QCodeEditor::paintEvent(QPaintEvent *e)
+void QCodeEditor::highlightSecondarySelections()
 {
-    updateLineNumberArea(e->rect());
-    QTextEdit::paintEvent(e);
+    QVector<QDecorationManager::Decoration> decorations;
+
+    if (!m_multiCursor->isEmpty())
+    {
+        QTextCharFormat format;
+        format.setBackground(m_syntaxStyle->getFormat("Selection").background());
+
+        auto from = cursorForPosition(QPoint(0, 0)).position();
+        auto to = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).position();
+
+        for (auto &cursor : m_multiCursor->cursors(from, to))
+        {
+            if (cursor.hasSelection())
+            {
+                decorations.append({cursor.selectionStart(), cursor.selectionEnd(), format});
+            }
+        }
+    }
+
+    m_decorations->setDecorations(SecondarySelectionsLayer, decorations);
 }
 
-int QCodeEditor::getFirstVisibleBlock()
+void QCodeEditor::highlightSearchResults()
 {
-    // Detect the first block for which bounding rect - once translated
-    // in absolute coordinated - is contained by the editor's text area
+    QVector<QDecorationManager::Decoration> decorations;
 
-    // Costly way of doing but since "blockBoundingGeometry(...)" doesn't
-    // exists for "QTextEdit"...
-
-    QTextCursor curs = QTextCursor(document());
-    curs.movePosition(QTextCursor::Start);
-    for (int i = 0; i < document()->blockCount(); ++i)
+    if (!m_findEngine->pattern().isEmpty())
     {
-        QTextBlock block = curs.block();
+        auto format = m_syntaxStyle->getFormat("SearchResult");
 
-        QRect r1 = viewport()->geometry();
-        QRect r2 = document()
-                       ->documentLayout()
-                       ->blockBoundingRect(block)
-                       .translated(viewport()->geometry().x(),
-                                   viewport()->geometry().y() - verticalScrollBar()->sliderPosition())
-                       .toRect();
+        auto from = cursorForPosition(QPoint(0, 0)).position();
+        auto to = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).position();
 
-        if (r1.intersects(r2))
+        for (auto &hit : m_findEngine->hits(from, to))
         {
-            return i;
+            decorations.append({hit.start, hit.start + hit.length, format});
         }
+    }
+
+    m_decorations->setDecorations(SearchResultsLayer, decorations);
+}
+
+void QCodeEditor::highlightDiagnostics()
+{
+    QVector<QDecorationManager::Decoration> decorations;
 
-        curs.movePosition(QTextCursor::NextBlock);
+    auto from = cursorForPosition(QPoint(0, 0)).position();
+    auto to = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).position();
+
+    for (auto &range : m_diagnostics->diagnostics(from, to))
+    {
+        decorations.append({range.start, range.end, diagnosticFormat(range.level), range.message});
     }
 
-    return 0;
+    m_decorations->setDecorations(SquigglesLayer, decorations);
 }
 
-bool QCodeEditor::proceedCompleterBegin(QKeyEvent *e)
+void QCodeEditor::markDiagnostics()
 {
-    if (m_completer && m_completer->popup()->isVisible())
+    QVector<int> errors;
+    QVector<int> warnings;
+
+    for (auto &range : m_diagnostics->diagnostics())
     {
-        switch (e->key())
+        if (range.level == SeverityLevel::Error)
         {
-        case Qt::Key_Enter:
-        case Qt::Key_Return:
-        case Qt::Key_Escape:
-        case Qt::Key_Tab:
-        case Qt::Key_Backtab:
-            e->ignore();
-            return true; // let the completer do default behavior
-        default:
-            break;
+            errors.append(range.start);
+        }
+        else if (range.level != SeverityLevel::Hint)
+        {
+            warnings.append(range.start);
         }
     }
 
-    // todo: Replace with modifiable QShortcut
-    auto isShortcut = ((e->modifiers() & Qt::ControlModifier) && e->key() == Qt::Key_Space);
-
-    return !(!m_completer || !isShortcut);
+    m_overviewRuler->setMarkers(QOverviewRuler::Lane::Errors, errors);
+    m_overviewRuler->setMarkers(QOverviewRuler::Lane::Warnings, warnings);
 }
 
-void QCodeEditor::proceedCompleterEnd(QKeyEvent *e)
+QTextCharFormat QCodeEditor::diagnosticFormat(SeverityLevel level) const
 {
-    auto ctrlOrShift = e->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier);
+    QTextCharFormat format;
 
-    if (!m_completer || (ctrlOrShift && e->text().isEmpty()) || e->key() == Qt::Key_Delete)
+    switch (level)
     {
-        return;
+    case SeverityLevel::Error:
+        format.setUnderlineColor(m_syntaxStyle->getFormat("Error").underlineColor());
+        format.setUnderlineStyle(m_syntaxStyle->getFormat("Error").underlineStyle());
+        break;
+    case SeverityLevel::Warning:
+        format.setUnderlineColor(m_syntaxStyle->getFormat("Warning").underlineColor());
+        format.setUnderlineStyle(m_syntaxStyle->getFormat("Warning").underlineStyle());
+        break;
+    case SeverityLevel::Information:
+        format.setUnderlineColor(m_syntaxStyle->getFormat("Warning").underlineColor());
+        format.setUnderlineStyle(QTextCharFormat::DotLine);
+        break;
+    case SeverityLevel::Hint:
+        format.setUnderlineColor(m_syntaxStyle->getFormat("Text").foreground().color());
+        format.setUnderlineStyle(QTextCharFormat::DotLine);
     }
 
-    static QString eow(R"(~!@#$%^&*()_+{}|:"<>?,./;'[]\-=)");
+    return format;
+}
 
-    auto isShortcut = ((e->modifiers() & Qt::ControlModifier) && e->key() == Qt::Key_Space);
-    auto completionPrefix = wordUnderCursor();
+int QCodeEditor::diagnosticOffset(QPair<int, int> position, int version) const
+{
+    QPositionMapper::Position mapped(position.first - 1, position.second);
 
-    if (!isShortcut && (e->text().isEmpty() || completionPrefix.length() < 2 || eow.contains(e->text().right(1))))
+    if (version < 0)
     {
-        m_completer->popup()->hide();
-        return;
+        return m_positionMapper->toOffset(mapped, m_positionEncoding);
     }
 
-    if (completionPrefix != m_completer->completionPrefix())
+    // The line is converted as it's now, which is exact unless it was edited since the version
+    if (m_positionEncoding != QPositionMapper::Encoding::Utf16)
     {
-        m_completer->setCompletionPrefix(completionPrefix);
-        m_completer->popup()->setCurrentIndex(m_completer->completionModel()->index(0, 0));
+        auto line = m_diagnostics->mapPosition({mapped.line, 0}, version).line;
+        mapped.column =
+            m_positionMapper->convertColumn(line, mapped.column, m_positionEncoding, QPositionMapper::Encoding::Utf16);
     }
 
-    auto cursRect = cursorRect();
-    cursRect.setWidth(m_completer->popup()->sizeHintForColumn(0) +
-                      m_completer->popup()->verticalScrollBar()->sizeHint().width());
+    return m_positionMapper->toOffset(m_diagnostics->mapPosition(mapped, version));
+}
+
+void QCodeEditor::paintEvent(QPaintEvent *e)
+{
+    {
+        QPainter painter(viewport());
+        paintDecorations(painter, e->rect(), false);
+    }
 
-    m_completer->complete(cursRect);
+    QTextEdit::paintEvent(e);
+
+    QPainter painter(viewport());
+    paintDecorations(painter, e->rect(), true);
+    paintSecondaryCursors(painter, e->rect());
+    paintStickyHeaders(painter);
 }
 
-void QCodeEditor::keyPressEvent(QKeyEvent *e)
+void QCodeEditor::paintDecorations(QPainter &painter, const QRect &rect, bool underlines)
 {
-    auto completerSkip = proceedCompleterBegin(e);
+    // Document range of the painted rectangle
+    auto from = cursorForPosition(rect.topLeft()).position();
+    auto to = cursorForPosition(rect.bottomRight()).position();
 
-    if (!completerSkip)
+    painter.setClipRect(rect);
+
+    for (auto &layer : m_decorations->layers())
     {
-        if ((e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) && e->modifiers() != Qt::NoModifier)
+        if (m_decorations->rendering(layer) != QDecorationManager::Rendering::Painted)
         {
-            QKeyEvent pureEnter(QEvent::KeyPress, Qt::Key_Enter, Qt::NoModifier);
-            if (e->modifiers() == Qt::ControlModifier)
-            {
-                moveCursor(QTextCursor::EndOfBlock);
-                keyPressEvent(&pureEnter);
-                return;
-            }
-            else if (e->modifiers() == (Qt::ControlModifier | Qt::ShiftModifier))
+            continue;
+        }
+
+        for (auto &decoration : m_decorations->decorations(layer, from, to))
+        {
+            auto &format = decoration.format;
+
+            // Long decorations are only walked through the visible lines
+            auto start = qMax(decoration.start, from);
+            auto end = qMin(decoration.end, to);
+
+            if (!underlines)
             {
-                if (textCursor().blockNumber() == 0)
+                if (format.background().style() == Qt::NoBrush)
                 {
-                    moveCursor(QTextCursor::StartOfBlock);
-                    insertPlainText("\n");
-                    moveCursor(QTextCursor::PreviousBlock);
-                    moveCursor(QTextCursor::EndOfBlock);
+                    continue;
                 }
-                else
+
+                auto fullWidth = format.boolProperty(QTextFormat::FullWidthSelection);
+                for (auto &r : decorationRects(start, end, fullWidth))
                 {
-                    moveCursor(QTextCursor::PreviousBlock);
-                    moveCursor(QTextCursor::EndOfBlock);
-                    keyPressEvent(&pureEnter);
+                    painter.fillRect(r, format.background());
                 }
-                return;
+
+                continue;
             }
-            else if (e->modifiers() == Qt::ShiftModifier)
+
+            auto style = format.underlineStyle();
+            if (style == QTextCharFormat::NoUnderline)
             {
-                keyPressEvent(&pureEnter);
-                return;
+                continue;
             }
-        }
 
-        if (e->key() == Qt::Key_Tab && e->modifiers() == Qt::NoModifier)
-        {
-            if (textCursor().hasSelection())
+            auto color = format.underlineColor();
+            if (!color.isValid())
             {
-                indent();
-                return;
+                color = palette().color(QPalette::Text);
             }
 
-            auto c = charUnderCursor();
-            for (auto p : qAsConst(m_parentheses))
+            for (auto &r : decorationRects(start, end, false))
             {
-                if (p.tabJumpOut && c == p.right)
+                auto y = r.bottom() - 1.5;
+
+                if (style == QTextCharFormat::WaveUnderline || style == QTextCharFormat::SpellCheckUnderline)
                 {
-                    moveCursor(QTextCursor::NextCharacter);
-                    return;
-                }
-            }
+                    QPainterPath path(QPointF(r.left(), y));
 
-            if (m_replaceTab)
+                    auto up = true;
+                    for (auto x = r.left(); x < r.right(); x += 2)
+                    {
+                        path.quadTo(x + 1, up ? y - 1.5 : y + 1.5, x + 2, y);
+                        up = !up;
+                    }
+
+                    painter.setPen(QPen(color, 1));
+                    painter.setRenderHint(QPainter::Antialiasing, true);
+                    painter.drawPath(path);
+                    painter.setRenderHint(QPainter::Antialiasing, false);
+                    continue;
+                }
+
+                auto penStyle = Qt::SolidLine;
+                switch (style)
+                {
+                case QTextCharFormat::DashUnderline:
+                    penStyle = Qt::DashLine;
+                    break;
+                case QTextCharFormat::DotLine:
+                    penStyle = Qt::DotLine;
+                    break;
+                case QTextCharFormat::DashDotLine:
+                    penStyle = Qt::DashDotLine;
+                    break;
+                case QTextCharFormat::DashDotDotLine:
+                    penStyle = Qt::DashDotDotLine;
+                    break;
+                default:
+                    break;
+                }
+
+                painter.setPen(QPen(color, 1, penStyle));
+                painter.drawLine(QPointF(r.left(), y), QPointF(r.right(), y));
+            }
+        }
+    }
+}
+
+QVector<QRectF> QCodeEditor::decorationRects(int start, int end, bool fullWidth) const
+{
+    QVector<QRectF> rects;
+
+    auto doc = document();
+    QPointF offset(-horizontalScrollBar()->value(), -verticalScrollBar()->value());
+
+    for (auto block = doc->findBlock(start); block.isValid() && block.position() <= end; block = block.next())
+    {
+        auto layout = block.layout();
+        if (!block.isVisible() || !layout)
+        {
+            continue;
+        }
+
+        auto origin = doc->documentLayout()->blockBoundingRect(block).topLeft() + offset;
+        auto from = qMax(start - block.position(), 0);
+        auto to = qMin(end - block.position(), block.length() - 1);
+
+        for (int i = 0; i < layout->lineCount(); ++i)
+        {
+            auto line = layout->lineAt(i);
+            auto lineStart = line.textStart();
+            auto lineEnd = lineStart + line.textLength();
+
+            if (lineEnd < from || lineStart > to)
+            {
+                continue;
+            }
+
+            auto r = line.rect().translated(origin);
+
+            if (fullWidth)
+            {
+                r.setLeft(0);
+                r.setRight(viewport()->width());
+                rects.append(r);
+                break;
+            }
+
+            r.setLeft(origin.x() + line.cursorToX(qMax(from, lineStart)));
+            r.setRight(origin.x() + line.cursorToX(qMin(to, lineEnd)));
+            rects.append(r);
+        }
+    }
+
+    return rects;
+}
+
+QRect QCodeEditor::layerBoundingRect(const QString &layer) const
+{
+    QRectF bounds;
+
+    auto rect = viewport()->rect();
+    auto from = cursorForPosition(rect.topLeft()).position();
+    auto to = cursorForPosition(rect.bottomRight()).position();
+
+    for (auto &decoration : m_decorations->decorations(layer, from, to))
+    {
+        auto fullWidth = decoration.format.boolProperty(QTextFormat::FullWidthSelection);
+        for (auto &r : decorationRects(qMax(decoration.start, from), qMin(decoration.end, to), fullWidth))
+        {
+            bounds = bounds.united(r);
+        }
+    }
+
+    if (bounds.isNull())
+    {
+        return QRect();
+    }
+
+    // Wave underlines reach slightly past the line rectangle
+    QPoint offset(horizontalScrollBar()->value(), verticalScrollBar()->value());
+    return bounds.toAlignedRect().adjusted(-2, -2, 2, 2).translated(offset);
+}
+
+int QCodeEditor::getFirstVisibleBlock()
+{
+    // The layout finds the block at the top of the viewport
+    // without walking the blocks above it
+    return cursorForPosition(QPoint(0, 0)).blockNumber();
+}
+
+bool QCodeEditor::proceedCompleterBegin(QKeyEvent *e)
+{
+    auto completer = activeCompleter();
+
+    if (completer && completer->popup()->isVisible())
+    {
+        switch (e->key())
+        {
+        case Qt::Key_Enter:
+        case Qt::Key_Return:
+        case Qt::Key_Escape:
+        case Qt::Key_Tab:
+        case Qt::Key_Backtab:
+            // Late completions mustn't show the popup again
+            m_completionEngine->cancel();
+            e->ignore();
+            return true; // let the completer do default behavior
+        default:
+            break;
+        }
+    }
+
+    // todo: Replace with modifiable QShortcut
+    auto isShortcut = ((e->modifiers() & Qt::ControlModifier) && e->key() == Qt::Key_Space);
+
+    return !(!completer || !isShortcut);
+}
+
+void QCodeEditor::proceedCompleterEnd(QKeyEvent *e)
+{
+    auto ctrlOrShift = e->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier);
+    auto completer = activeCompleter();
+
+    if (!completer || (ctrlOrShift && e->text().isEmpty()) || e->key() == Qt::Key_Delete)
+    {
+        return;
+    }
+
+    static QString eow(R"(~!@#$%^&*()_+{}|:"<>?,./;'[]\-=)");
+
+    auto isShortcut = ((e->modifiers() & Qt::ControlModifier) && e->key() == Qt::Key_Space);
+    auto completionPrefix = wordUnderCursor();
+
+    if (!isShortcut && (e->text().isEmpty() || completionPrefix.length() < 2 || eow.contains(e->text().right(1))))
+    {
+        completer->popup()->hide();
+        m_completionEngine->cancel();
+        return;
+    }
+
+    if (completionPrefix != completer->completionPrefix())
+    {
+        // Ranks the candidates itself, instead of filtering them by prefix
+        auto fuzzyCompleter = qobject_cast<QFuzzyCompleter *>(completer);
+        if (fuzzyCompleter)
+        {
+            fuzzyCompleter->filter(completionPrefix);
+        }
+        else
+        {
+            completer->setCompletionPrefix(completionPrefix);
+        }
+
+        completer->popup()->setCurrentIndex(completer->completionModel()->index(0, 0));
+    }
+
+    // Completions of the previous prefix are shown until the providers answer
+    if (completer == m_providerCompleter &&
+        (isShortcut || completionPrefix != m_completionEngine->currentRequest().prefix))
+    {
+        auto cursor = textCursor();
+        m_completionEngine->request(
+            QCompletionProvider::Request(completionPrefix, cursor.block().text(), cursor.positionInBlock()));
+    }
+
+    showCompleterPopup(completer);
+}
+
+void QCodeEditor::showCompleterPopup(QCompleter *completer)
+{
+    if (completer->completionCount() == 0)
+    {
+        completer->popup()->hide();
+        return;
+    }
+
+    // Only the rows, which fit in the popup, are measured
+    auto popup = completer->popup();
+    auto model = completer->completionModel();
+    auto rows = qMin(model->rowCount(), completer->maxVisibleItems());
+
+    int width = 0;
+    for (int row = 0; row < rows; ++row)
+    {
+        width = qMax(width, popup->sizeHintForIndex(model->index(row, 0)).width());
+    }
+
+    auto cursRect = cursorRect();
+    cursRect.setWidth(width + popup->verticalScrollBar()->sizeHint().width());
+
+    completer->complete(cursRect);
+}
+
+void QCodeEditor::keyPressEvent(QKeyEvent *e)
+{
+    if (!m_multiCursor->isEmpty() && multiCursorKeyPress(e))
+    {
+        return;
+    }
+
+    auto completerSkip = proceedCompleterBegin(e);
+
+    if (!completerSkip)
+    {
+        if ((e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) && e->modifiers() != Qt::NoModifier)
+        {
+            QKeyEvent pureEnter(QEvent::KeyPress, Qt::Key_Enter, Qt::NoModifier);
+            if (e->modifiers() == Qt::ControlModifier)
+            {
+                moveCursor(QTextCursor::EndOfBlock);
+                keyPressEvent(&pureEnter);
+                return;
+            }
+            else if (e->modifiers() == (Qt::ControlModifier | Qt::ShiftModifier))
+            {
+                if (textCursor().blockNumber() == 0)
+                {
+                    moveCursor(QTextCursor::StartOfBlock);
+                    insertPlainText("\n");
+                    moveCursor(QTextCursor::PreviousBlock);
+                    moveCursor(QTextCursor::EndOfBlock);
+                }
+                else
+                {
+                    moveCursor(QTextCursor::PreviousBlock);
+                    moveCursor(QTextCursor::EndOfBlock);
+                    keyPressEvent(&pureEnter);
+                }
+                return;
+            }
+            else if (e->modifiers() == Qt::ShiftModifier)
+            {
+                keyPressEvent(&pureEnter);
+                return;
+            }
+        }
+
+        if (e->key() == Qt::Key_Tab && e->modifiers() == Qt::NoModifier)
+        {
+            if (textCursor().hasSelection())
+            {
+                indent();
+                return;
+            }
+
+            auto c = charUnderCursor();
+            for (auto p : qAsConst(m_parentheses))
+            {
+                if (p.tabJumpOut && c == p.right)
+                {
+                    moveCursor(QTextCursor::NextCharacter);
+                    return;
+                }
+            }
+
+            if (m_replaceTab)
             {
                 insertPlainText(m_tabReplace);
                 return;
@@ -817,240 +1912,1081 @@ void QCodeEditor::keyPressEvent(QKeyEvent *e)
                     {
                         auto symbol = charUnderCursor();
 
-                        if (symbol == p.right)
-                        {
-                            moveCursor(QTextCursor::NextCharacter);
-                            return;
-                        }
-                    }
+                        if (symbol == p.right)
+                        {
+                            moveCursor(QTextCursor::NextCharacter);
+                            return;
+                        }
+                    }
+
+                    if (p.left == e->text())
+                    {
+                        insertPlainText(QString(p.left) + p.right);
+                        moveCursor(QTextCursor::PreviousCharacter);
+                        return;
+                    }
+                }
+            }
+        }
+
+        if ((e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) && e->modifiers() == Qt::NoModifier)
+        {
+            insertPlainText("\n" + indentationSpaces.left(textCursor().columnNumber()));
+            setTextCursor(textCursor()); // scroll to the cursor
+            return;
+        }
+
+        if (e->key() == Qt::Key_Escape && textCursor().hasSelection())
+        {
+            auto cursor = textCursor();
+            cursor.clearSelection();
+            setTextCursor(cursor);
+        }
+
+        QTextEdit::keyPressEvent(e);
+    }
+
+    proceedCompleterEnd(e);
+}
+
+void QCodeEditor::setAutoIndentation(bool enabled)
+{
+    m_autoIndentation = enabled;
+}
+
+void QCodeEditor::setParentheses(const QVector<Parenthesis> &parentheses)
+{
+    m_parentheses = parentheses;
+
+    QVector<QPair<QChar, QChar>> pairs;
+    for (auto &p : m_parentheses)
+    {
+        pairs.append({p.left, p.right});
+    }
+
+    m_bracketIndex->setPairs(pairs);
+}
+
+void QCodeEditor::setRainbowBrackets(bool enabled)
+{
+    m_rainbowBrackets = enabled;
+    scheduleUpdate(VisibleBracketsDirty);
+}
+
+bool QCodeEditor::rainbowBrackets() const
+{
+    return m_rainbowBrackets;
+}
+
+void QCodeEditor::setExtraBottomMargin(bool enabled)
+{
+    m_extraBottomMargin = enabled;
+    updateBottomMargin();
+}
+
+bool QCodeEditor::autoIndentation() const
+{
+    return m_autoIndentation;
+}
+
+void QCodeEditor::setTabReplace(bool enabled)
+{
+    m_replaceTab = enabled;
+}
+
+bool QCodeEditor::tabReplace() const
+{
+    return m_replaceTab;
+}
+
+void QCodeEditor::setTabReplaceSize(int val)
+{
+    m_tabReplace.fill(' ', val);
+#if QT_VERSION >= 0x050B00
+    setTabStopDistance(fontMetrics().horizontalAdvance(QString(val * 1000, ' ')) / 1000.0);
+#elif QT_VERSION == 0x050A00
+    setTabStopDistance(fontMetrics().width(QString(val * 1000, ' ')) / 1000.0);
+#else
+    setTabStopWidth(fontMetrics().width(QString(val * 1000, ' ')) / 1000.0);
+#endif
+}
+
+int QCodeEditor::tabReplaceSize() const
+{
+    return m_tabReplace.size();
+}
+
+void QCodeEditor::setCompleter(QCompleter *completer)
+{
+    if (m_completer)
+    {
+        disconnect(m_completer, nullptr, this, nullptr);
+    }
+
+    m_completer = completer;
+
+    if (!m_completer)
+    {
+        return;
+    }
+
+    m_completer->setWidget(this);
+
+    // A fuzzy completer shows its ranked rows unfiltered
+    if (!qobject_cast<QFuzzyCompleter *>(m_completer))
+    {
+        m_completer->setCompletionMode(QCompleter::CompletionMode::PopupCompletion);
+    }
+
+    connect(m_completer, QOverload<const QString &>::of(&QCompleter::activated), this, &QCodeEditor::insertCompletion);
+}
+
+void QCodeEditor::mousePressEvent(QMouseEvent *e)
+{
+    if (e->button() == Qt::LeftButton && e->modifiers() == Qt::AltModifier)
+    {
+        m_multiCursor->addCursor(textCursor());
+        setTextCursor(cursorForPosition(e->pos()));
+        m_multiCursor->normalize(textCursor());
+        return;
+    }
+
+    if (e->button() == Qt::LeftButton)
+    {
+        m_multiCursor->clear();
+    }
+
+    QTextEdit::mousePressEvent(e);
+}
+
+void QCodeEditor::focusInEvent(QFocusEvent *e)
+{
+    auto completer = activeCompleter();
+    if (completer)
+    {
+        completer->setWidget(this);
+    }
+
+    QTextEdit::focusInEvent(e);
+}
+
+bool QCodeEditor::event(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip)
+    {
+        auto *helpEvent = dynamic_cast<QHelpEvent *>(event);
+        auto point = helpEvent->pos();
+        point.setX(point.x() - m_lineNumberArea->geometry().right());
+        auto position = cursorForPosition(point).position();
+
+        QString text;
+        for (auto const &e : m_diagnostics->diagnostics(position, position))
+        {
+            if (text.isEmpty())
+                text = e.message;
+            else
+                text += "; " + e.message;
+        }
+
+        if (text.isEmpty())
+            QToolTip::hideText();
+        else
+            QToolTip::showText(helpEvent->globalPos(), text);
+
+        return true;
+    }
+    return QTextEdit::event(event);
+}
+
+void QCodeEditor::insertCompletion(const QString &s)
+{
+    auto completer = activeCompleter();
+    if (!completer || completer->widget() != this)
+    {
+        return;
+    }
+
+    m_completionEngine->cancel();
+
+    auto tc = textCursor();
+    tc.select(QTextCursor::SelectionType::WordUnderCursor);
+    tc.insertText(s);
+    setTextCursor(tc);
+}
+
+QCompleter *QCodeEditor::completer() const
+{
+    return m_completer;
+}
+
+void QCodeEditor::addCompletionProvider(QCompletionProvider *provider)
+{
+    if (!m_providerCompleter)
+    {
+        m_providerCompleter = new QFuzzyCompleter(this);
+        m_providerCompleter->setWidget(this);
+
+        connect(m_providerCompleter, QOverload<const QString &>::of(&QCompleter::activated), this,
+                &QCodeEditor::insertCompletion);
+    }
+
+    m_completionEngine->addProvider(provider);
+}
+
+void QCodeEditor::removeCompletionProvider(QCompletionProvider *provider)
+{
+    m_completionEngine->removeProvider(provider);
+
+    // The completer is used again
+    if (m_providerCompleter && m_completionEngine->providers().isEmpty())
+    {
+        m_providerCompleter->popup()->hide();
+        m_providerCompleter->setCandidates({});
+    }
+}
+
+QCompletionEngine *QCodeEditor::completionEngine() const
+{
+    return m_completionEngine;
+}
+
+QCompleter *QCodeEditor::activeCompleter() const
+{
+    return m_completionEngine->providers().isEmpty() ? m_completer : m_providerCompleter;
+}
+
+void QCodeEditor::updateProviderCompletions(const QString &prefix, const QStringList &results)
+{
+    if (!hasFocus() || prefix != wordUnderCursor())
+    {
+        return;
+    }
+
+    // Completions of the previous prefix are kept, until some of the new ones arrive
+    if (results.isEmpty() && m_completionEngine->isRunning())
+    {
+        return;
+    }
+
+    m_providerCompleter->setCandidates(results);
+    m_providerCompleter->filter(prefix);
+    m_providerCompleter->popup()->setCurrentIndex(m_providerCompleter->completionModel()->index(0, 0));
+
+    showCompleterPopup(m_providerCompleter);
+}
+
+QDecorationManager *QCodeEditor::decorations() const
+{
+    return m_decorations;
+}
+
+QPositionMapper *QCodeEditor::positionMapper() const
+{
+    return m_positionMapper;
+}
+
+void QCodeEditor::setPositionEncoding(QPositionMapper::Encoding encoding)
+{
+    m_positionEncoding = encoding;
+}
+
+QPositionMapper::Encoding QCodeEditor::positionEncoding() const
+{
+    return m_positionEncoding;
+}
+
+QDiagnosticStore *QCodeEditor::diagnostics() const
+{
+    return m_diagnostics;
+}
+
+bool QCodeEditor::setDiagnostics(const QVector<Diagnostic> &diagnostics, int version)
+{
+    if (!m_diagnostics->isMappable(version))
+    {
+        return false;
+    }
+
+    QVector<QDiagnosticStore::Range> ranges;
+    ranges.reserve(diagnostics.size());
+
+    for (auto &diagnostic : diagnostics)
+    {
+        if (diagnostic.stop < diagnostic.start)
+            continue;
+
+        ranges.append({diagnosticOffset(diagnostic.start, version), diagnosticOffset(diagnostic.stop, version),
+                       diagnostic.level, diagnostic.message, diagnostic.id});
+    }
+
+    // Positions are mapped to the current text already
+    return m_diagnostics->setDiagnostics(ranges);
+}
+
+bool QCodeEditor::updateDiagnostics(const QVector<Diagnostic> &added, const QVector<int> &removedIds, int version)
+{
+    if (!m_diagnostics->isMappable(version))
+    {
+        return false;
+    }
+
+    QVector<QDiagnosticStore::Range> ranges;
+    ranges.reserve(added.size());
+
+    for (auto &diagnostic : added)
+    {
+        if (diagnostic.stop < diagnostic.start)
+            continue;
+
+        ranges.append({diagnosticOffset(diagnostic.start, version), diagnosticOffset(diagnostic.stop, version),
+                       diagnostic.level, diagnostic.message, diagnostic.id});
+    }
+
+    return m_diagnostics->updateDiagnostics(ranges, removedIds);
+}
+
+QWordIndex *QCodeEditor::wordIndex() const
+{
+    return m_wordIndex;
+}
+
+QBracketIndex *QCodeEditor::bracketIndex() const
+{
+    return m_bracketIndex;
+}
+
+QFoldingManager *QCodeEditor::folding() const
+{
+    return m_folding;
+}
+
+QScopeTree *QCodeEditor::scopeTree() const
+{
+    return m_scopeTree;
+}
+
+void QCodeEditor::setStickyHeaders(bool enabled)
+{
+    m_stickyHeaders = enabled;
+    scheduleUpdate(ScopesDirty);
+}
+
+bool QCodeEditor::stickyHeaders() const
+{
+    return m_stickyHeaders;
+}
+
+QStringList QCodeEditor::breadcrumbs() const
+{
+    return m_breadcrumbs;
+}
+
+void QCodeEditor::setMinimapVisible(bool visible)
+{
+    m_minimap->setVisible(visible);
+    scheduleUpdate(LineNumberAreaWidthDirty);
+}
+
+bool QCodeEditor::isMinimapVisible() const
+{
+    return !m_minimap->isHidden();
+}
+
+QMinimap *QCodeEditor::minimap() const
+{
+    return m_minimap;
+}
+
+QOverviewRuler *QCodeEditor::overviewRuler() const
+{
+    return m_overviewRuler;
+}
+
+QFindEngine *QCodeEditor::findEngine() const
+{
+    return m_findEngine;
+}
+
+bool QCodeEditor::findAll(const QString &pattern, const QFindEngine::Options &options)
+{
+    return m_findEngine->start(pattern, options);
+}
+
+void QCodeEditor::clearFind()
+{
+    m_findEngine->clear();
+}
+
+int QCodeEditor::replaceAll(const QString &pattern, const QString &replacement, const QFindEngine::Options &options)
+{
+    auto regex = QFindEngine::regularExpression(pattern, options);
+    if (pattern.isEmpty() || !regex.isValid() || isReadOnly())
+    {
+        return 0;
+    }
+
+    regex.optimize();
+
+    auto parts = options.regularExpression ? replacementParts(replacement, regex.captureCount())
+                                           : QVector<ReplacementPart>{ReplacementPart(replacement)};
+
+    // Unlike toPlainText, keeps non-breaking spaces and line separators, which are copied back between matches
+    auto snapshot = document()->toRawText();
+    snapshot.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+
+    // Matches on the same line form a single span, so the other blocks and their data are left alone
+    QVector<ReplacementSpan> spans;
+    int count = 0;
+
+    // First line break after the last match, the snapshot size if there's none
+    int lineBreak = -1;
+
+    auto it = regex.globalMatch(snapshot);
+    while (it.hasNext())
+    {
+        // Empty matches (e.g. of "^") insert the replacement
+        auto match = it.next();
+        auto start = static_cast<int>(match.capturedStart());
+        auto end = static_cast<int>(match.capturedEnd());
+
+        if (spans.isEmpty() || lineBreak < start)
+        {
+            spans.append(ReplacementSpan(start));
+        }
+
+        auto &span = spans.last();
+
+        // Text between the matches is kept
+        span.text.append(snapshot.constData() + span.end, start - span.end);
+
+        for (auto &part : qAsConst(parts))
+        {
+            span.text.append(part.capture < 0 ? part.text : match.captured(part.capture));
+        }
+
+        span.end = end;
+        ++count;
+
+        // Looked up again only once passed, so long lines aren't scanned per match
+        if (lineBreak < end)
+        {
+            auto next = snapshot.indexOf('\n', end);
+            lineBreak = static_cast<int>(next < 0 ? snapshot.size() : next);
+        }
+    }
+
+    if (spans.isEmpty())
+    {
+        return 0;
+    }
+
+    // Single undo step, the document reports a single change once it's done
+    BulkEdit edit(this);
+
+    QTextCursor cursor(document());
+
+    // From the end, so the offsets of the snapshot stay valid
+    for (auto i = static_cast<int>(spans.size()) - 1; i >= 0; --i)
+    {
+        cursor.setPosition(spans[i].start);
+        cursor.setPosition(spans[i].end, QTextCursor::KeepAnchor);
+
+        if (spans[i].text.isEmpty())
+        {
+            cursor.removeSelectedText();
+        }
+        else
+        {
+            cursor.insertText(spans[i].text);
+        }
+    }
+
+    return count;
+}
+
+QTrigramIndex *QCodeEditor::trigramIndex() const
+{
+    return m_trigramIndex;
+}
+
+QMultiCursor *QCodeEditor::multiCursor() const
+{
+    return m_multiCursor;
+}
+
+void QCodeEditor::findNext()
+{
+    selectNextHit(false);
+}
+
+void QCodeEditor::findPrevious()
+{
+    selectNextHit(true);
+}
+
+void QCodeEditor::addCursorAbove()
+{
+    addCursorVertically(QTextCursor::Up);
+}
+
+void QCodeEditor::addCursorBelow()
+{
+    addCursorVertically(QTextCursor::Down);
+}
+
+void QCodeEditor::addNextOccurrence()
+{
+    auto primary = textCursor();
+
+    if (!primary.hasSelection())
+    {
+        primary.select(QTextCursor::WordUnderCursor);
+        setTextCursor(primary);
+        return;
+    }
+
+    auto text = primary.selectedText();
+
+    // Found in a single block only
+    if (text.contains(QChar::ParagraphSeparator))
+    {
+        return;
+    }
+
+    // The primary cursor is the last added occurrence, the ones already added are skipped
+    auto found = primary;
+    do
+    {
+        auto next = document()->find(text, found.selectionEnd(), QTextDocument::FindCaseSensitively);
+        found = next.isNull() ? document()->find(text, 0, QTextDocument::FindCaseSensitively) : next;
+
+        if (found.isNull() || found.selectionStart() == primary.selectionStart())
+        {
+            return;
+        }
+    } while (!m_multiCursor->cursors(found.selectionStart(), found.selectionEnd()).isEmpty());
+
+    m_multiCursor->addCursor(primary);
+    setTextCursor(found);
+    m_multiCursor->normalize(found);
+}
+
+void QCodeEditor::splitSelectionIntoLines()
+{
+    auto cursors = m_multiCursor->cursors();
+    cursors.append(textCursor());
+
+    QVector<QTextCursor> lines;
+
+    for (auto &cursor : qAsConst(cursors))
+    {
+        auto start = cursor.selectionStart();
+        auto end = cursor.selectionEnd();
+
+        auto block = document()->findBlock(start);
+        if (end < block.position() + block.length())
+        {
+            lines.append(cursor);
+            continue;
+        }
+
+        for (; block.isValid() && block.position() <= end; block = block.next())
+        {
+            // The line after the selection isn't selected
+            if (block.position() == end && end > start)
+            {
+                break;
+            }
+
+            QTextCursor line(document());
+            line.setPosition(qMax(start, block.position()));
+            line.setPosition(qMin(end, block.position() + block.length() - 1), QTextCursor::KeepAnchor);
+            lines.append(line);
+        }
+    }
+
+    // The last line of the text cursor stays the text cursor
+    auto primary = lines.takeLast();
+
+    m_multiCursor->setCursors(lines);
+    setTextCursor(primary);
+    m_multiCursor->normalize(primary);
+}
+
+void QCodeEditor::clearSecondaryCursors()
+{
+    m_multiCursor->clear();
+}
+
+void QCodeEditor::addCursorVertically(QTextCursor::MoveOperation operation)
+{
+    auto cursor = textCursor();
+
+    if (!m_multiCursor->isEmpty())
+    {
+        auto cursors = m_multiCursor->cursors();
+        auto &outermost = operation == QTextCursor::Up ? cursors.first() : cursors.last();
+
+        if (operation == QTextCursor::Up ? outermost.position() < cursor.position()
+                                         : outermost.position() > cursor.position())
+        {
+            cursor = outermost;
+        }
+    }
+
+    // Moves by visual lines and keeps the horizontal position of the cursor
+    cursor.clearSelection();
+    if (!cursor.movePosition(operation))
+    {
+        return;
+    }
+
+    m_multiCursor->addCursor(cursor);
+    m_multiCursor->normalize(textCursor());
+}
+
+void QCodeEditor::editCursors(const std::function<void(QTextCursor &)> &edit)
+{
+    auto cursors = m_multiCursor->cursors();
+    auto primary = textCursor();
+
+    {
+        // Single undo step, the document reports a single change once it's done
+        BulkEdit bulkEdit(this);
+
+        for (auto &cursor : cursors)
+        {
+            edit(cursor);
+        }
+
+        edit(primary);
+    }
+
+    // Set once, after the layout has caught up with the edit, so it's scrolled to correctly
+    setTextCursor(primary);
+
+    m_multiCursor->setCursors(cursors);
+    m_multiCursor->normalize(primary);
+}
+
+bool QCodeEditor::multiCursorKeyPress(QKeyEvent *e)
+{
+    auto modifiers = e->modifiers() & ~Qt::KeypadModifier;
+    if (modifiers != Qt::NoModifier && modifiers != Qt::ShiftModifier)
+    {
+        return false;
+    }
+
+    auto mode = modifiers == Qt::ShiftModifier ? QTextCursor::KeepAnchor : QTextCursor::MoveAnchor;
+
+    switch (e->key())
+    {
+    case Qt::Key_Escape:
+        clearSecondaryCursors();
+        return true;
+    case Qt::Key_Left:
+    case Qt::Key_Right: {
+        auto left = e->key() == Qt::Key_Left;
+        editCursors([left, mode](QTextCursor &cursor) {
+            // A selection collapses to its side
+            if (mode == QTextCursor::MoveAnchor && cursor.hasSelection())
+            {
+                cursor.setPosition(left ? cursor.selectionStart() : cursor.selectionEnd());
+                return;
+            }
+
+            cursor.movePosition(left ? QTextCursor::Left : QTextCursor::Right, mode);
+        });
+        return true;
+    }
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+    case Qt::Key_Home:
+    case Qt::Key_End: {
+        auto operation = e->key() == Qt::Key_Up     ? QTextCursor::Up
+                         : e->key() == Qt::Key_Down ? QTextCursor::Down
+                         : e->key() == Qt::Key_Home ? QTextCursor::StartOfLine
+                                                    : QTextCursor::EndOfLine;
+        editCursors([operation, mode](QTextCursor &cursor) { cursor.movePosition(operation, mode); });
+        return true;
+    }
+    case Qt::Key_Backspace:
+    case Qt::Key_Delete: {
+        auto backward = e->key() == Qt::Key_Backspace;
+        editCursors([backward](QTextCursor &cursor) {
+            if (cursor.hasSelection())
+            {
+                cursor.removeSelectedText();
+            }
+            else if (backward)
+            {
+                cursor.deletePreviousChar();
+            }
+            else
+            {
+                cursor.deleteChar();
+            }
+        });
+        return true;
+    }
+    case Qt::Key_Return:
+    case Qt::Key_Enter: {
+        QRegularExpression indentation("^\\s*");
+        editCursors([&indentation](QTextCursor &cursor) {
+            auto spaces = indentation.match(cursor.block().text()).captured();
+            cursor.insertText("\n" + spaces.left(cursor.positionInBlock()));
+        });
+        return true;
+    }
+    case Qt::Key_Tab: {
+        auto cursors = m_multiCursor->cursors();
+        auto selection = textCursor().hasSelection() ||
+                         std::any_of(cursors.cbegin(), cursors.cend(),
+                                     [](const QTextCursor &cursor) { return cursor.hasSelection(); });
+
+        if (selection)
+        {
+            indent();
+            return true;
+        }
 
-                    if (p.left == e->text())
-                    {
-                        insertPlainText(QString(p.left) + p.right);
-                        moveCursor(QTextCursor::PreviousCharacter);
-                        return;
-                    }
-                }
-            }
+        auto tab = m_replaceTab ? m_tabReplace : QString("\t");
+        editCursors([&tab](QTextCursor &cursor) { cursor.insertText(tab); });
+        return true;
+    }
+    case Qt::Key_Backtab:
+        unindent();
+        return true;
+    default:
+        break;
+    }
+
+    auto text = e->text();
+    if (text.isEmpty() || !text[0].isPrint())
+    {
+        return false;
+    }
+
+    editCursors([&text](QTextCursor &cursor) { cursor.insertText(text); });
+    return true;
+}
+
+QVector<QTextBlock> QCodeEditor::selectedBlocks() const
+{
+    auto cursors = m_multiCursor->cursors();
+    auto primary = textCursor();
+
+    auto it = std::upper_bound(cursors.begin(), cursors.end(), primary, [](const QTextCursor &a, const QTextCursor &b) {
+        return a.selectionStart() < b.selectionStart();
+    });
+    cursors.insert(it, primary);
+
+    QVector<QTextBlock> blocks;
+    int lastNumber = -1;
+
+    for (auto &cursor : qAsConst(cursors))
+    {
+        auto block = document()->findBlock(cursor.selectionStart());
+        auto last = document()->findBlock(cursor.selectionEnd());
+
+        // Lines shared with the previous cursors are taken once
+        if (last.blockNumber() <= lastNumber)
+        {
+            continue;
         }
 
-        if ((e->key() == Qt::Key_Return || e->key() == Qt::Key_Enter) && e->modifiers() == Qt::NoModifier)
+        if (block.blockNumber() <= lastNumber)
         {
-            insertPlainText("\n" + indentationSpaces.left(textCursor().columnNumber()));
-            setTextCursor(textCursor()); // scroll to the cursor
-            return;
+            block = document()->findBlockByNumber(lastNumber + 1);
         }
 
-        if (e->key() == Qt::Key_Escape && textCursor().hasSelection())
+        for (; block.isValid(); block = block.next())
         {
-            auto cursor = textCursor();
-            cursor.clearSelection();
-            setTextCursor(cursor);
+            blocks.append(block);
+
+            if (block == last)
+            {
+                break;
+            }
         }
 
-        QTextEdit::keyPressEvent(e);
+        lastNumber = last.blockNumber();
     }
 
-    proceedCompleterEnd(e);
+    return blocks;
 }
 
-void QCodeEditor::setAutoIndentation(bool enabled)
+void QCodeEditor::selectNextHit(bool backward)
 {
-    m_autoIndentation = enabled;
-}
+    auto cursor = textCursor();
 
-void QCodeEditor::setParentheses(const QVector<Parenthesis> &parentheses)
-{
-    m_parentheses = parentheses;
-}
+    auto hit = m_findEngine->nextHit(backward ? cursor.selectionStart() : cursor.selectionEnd(), backward);
+    if (hit.length == 0)
+    {
+        return;
+    }
 
-void QCodeEditor::setExtraBottomMargin(bool enabled)
-{
-    m_extraBottomMargin = enabled;
-    updateBottomMargin();
+    cursor.setPosition(hit.start);
+    cursor.setPosition(hit.start + hit.length, QTextCursor::KeepAnchor);
+    setTextCursor(cursor);
 }
 
-bool QCodeEditor::autoIndentation() const
+void QCodeEditor::squiggle(SeverityLevel level, QPair<int, int> start, QPair<int, int> stop,
+                           const QString &tooltipMessage)
 {
-    return m_autoIndentation;
-}
+    if (stop < start)
+        return;
 
-void QCodeEditor::setTabReplace(bool enabled)
-{
-    m_replaceTab = enabled;
+    m_diagnostics->addDiagnostic({diagnosticOffset(start), diagnosticOffset(stop), level, tooltipMessage});
 }
 
-bool QCodeEditor::tabReplace() const
+void QCodeEditor::loadFileAsync(const QString &path)
 {
-    return m_replaceTab;
-}
+    cancelLoading();
 
-void QCodeEditor::setTabReplaceSize(int val)
-{
-    m_tabReplace.fill(' ', val);
-#if QT_VERSION >= 0x050B00
-    setTabStopDistance(fontMetrics().horizontalAdvance(QString(val * 1000, ' ')) / 1000.0);
-#elif QT_VERSION == 0x050A00
-    setTabStopDistance(fontMetrics().width(QString(val * 1000, ' ')) / 1000.0);
-#else
-    setTabStopWidth(fontMetrics().width(QString(val * 1000, ' ')) / 1000.0);
-#endif
-}
+    clearSquiggle();
+    m_multiCursor->clear();
+    clear();
 
-int QCodeEditor::tabReplaceSize() const
-{
-    return m_tabReplace.size();
-}
+    // Highlighting each appended chunk would delay the first screen, it starts after loading
+    m_highlightTimer->stop();
+    m_highlightBlock = -1;
 
-void QCodeEditor::setCompleter(QCompleter *completer)
-{
-    if (m_completer)
+    if (m_highlighter)
     {
-        disconnect(m_completer, nullptr, this, nullptr);
+        m_highlighter->setDocument(nullptr);
     }
 
-    m_completer = completer;
+    m_loadReadOnly = isReadOnly();
+    m_invalidSequences = 0;
+    setReadOnly(true);
+    document()->setUndoRedoEnabled(false);
 
-    if (!m_completer)
+    m_loadThread = new QThread();
+    m_loader = new QFileLoader(path);
+    m_loader->moveToThread(m_loadThread);
+
+    connect(m_loadThread, &QThread::finished, m_loader, &QObject::deleteLater);
+    connect(m_loadThread, &QThread::finished, m_loadThread, &QObject::deleteLater);
+    connect(m_loader, &QFileLoader::chunkRead, this, &QCodeEditor::appendLoadedChunk);
+    connect(m_loader, &QFileLoader::finished, this, &QCodeEditor::finishLoading);
+
+    m_loadThread->start();
+
+    auto loader = m_loader;
+    QMetaObject::invokeMethod(
+        m_loader, [loader] { loader->readChunk(FirstLoadChunkSize); }, Qt::QueuedConnection);
+}
+
+void QCodeEditor::cancelLoading()
+{
+    if (!m_loader)
     {
         return;
     }
 
-    m_completer->setWidget(this);
-    m_completer->setCompletionMode(QCompleter::CompletionMode::PopupCompletion);
+    disconnect(m_loader, nullptr, this, nullptr);
+    m_loader->cancel();
+    m_loadThread->quit();
 
-    connect(m_completer, QOverload<const QString &>::of(&QCompleter::activated), this, &QCodeEditor::insertCompletion);
+    m_loader = nullptr;
+    m_loadThread = nullptr;
+
+    setReadOnly(m_loadReadOnly);
+    document()->setUndoRedoEnabled(true);
+
+    startHighlighting();
+
+    Q_EMIT loadFinished(false);
 }
 
-void QCodeEditor::focusInEvent(QFocusEvent *e)
+bool QCodeEditor::isLoading() const
 {
-    if (m_completer)
+    return m_loader != nullptr;
+}
+
+void QCodeEditor::appendLoadedChunk(const QString &text, qint64 bytesRead, qint64 bytesTotal)
+{
+    // Let the worker decode the next chunk while this one is inserted
+    if (bytesRead < bytesTotal)
     {
-        m_completer->setWidget(this);
+        auto loader = m_loader;
+        QMetaObject::invokeMethod(
+            m_loader, [loader] { loader->readChunk(LoadChunkSize); }, Qt::QueuedConnection);
     }
 
-    QTextEdit::focusInEvent(e);
+    // The highlighter is attached once everything is appended
+    QTextCursor cursor(document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(text);
+
+    Q_EMIT loadProgress(bytesRead, bytesTotal);
 }
 
-bool QCodeEditor::event(QEvent *event)
+void QCodeEditor::finishLoading(bool success)
 {
-    if (event->type() == QEvent::ToolTip)
+    if (success)
     {
-        auto *helpEvent = dynamic_cast<QHelpEvent *>(event);
-        auto point = helpEvent->pos();
-        point.setX(point.x() - m_lineNumberArea->geometry().right());
-        QTextCursor cursor = cursorForPosition(point);
+        m_encoding = m_loader->encoding();
+        m_lineEnding = m_loader->lineEnding();
+        m_invalidSequences = m_loader->invalidSequences();
+    }
 
-        auto lineNumber = cursor.blockNumber() + 1;
+    disconnect(m_loader, nullptr, this, nullptr);
+    m_loadThread->quit();
 
-        QTextCursor copyCursor(cursor);
-        copyCursor.movePosition(QTextCursor::StartOfBlock);
+    m_loader = nullptr;
+    m_loadThread = nullptr;
 
-        auto blockPositionStart = cursor.positionInBlock() - copyCursor.positionInBlock();
-        QPair<int, int> positionOfTooltip{lineNumber, blockPositionStart};
+    setReadOnly(m_loadReadOnly);
+    document()->setUndoRedoEnabled(true);
 
-        QString text;
-        for (auto const &e : qAsConst(m_squiggler))
-        {
-            if (e.m_startPos <= positionOfTooltip && e.m_stopPos >= positionOfTooltip)
-            {
-                if (text.isEmpty())
-                    text = e.m_tooltipText;
-                else
-                    text += "; " + e.m_tooltipText;
-            }
-        }
+    if (success)
+    {
+        document()->setModified(false);
+    }
 
-        if (text.isEmpty())
-            QToolTip::hideText();
-        else
-            QToolTip::showText(helpEvent->globalPos(), text);
+    startHighlighting();
 
-        return true;
-    }
-    return QTextEdit::event(event);
+    Q_EMIT loadFinished(success);
 }
 
-void QCodeEditor::insertCompletion(const QString &s)
+void QCodeEditor::startHighlighting()
 {
-    if (m_completer->widget() != this)
+    if (!m_highlighter)
     {
         return;
     }
 
-    auto tc = textCursor();
-    tc.select(QTextCursor::SelectionType::WordUnderCursor);
-    tc.insertText(s);
-    setTextCursor(tc);
+    // Blocks start in the state of an ordinary line, so highlighting one
+    // doesn't go on through all the blocks below, which aren't highlighted yet
+    for (auto block = document()->firstBlock(); block.isValid(); block = block.next())
+    {
+        block.setUserState(0);
+    }
+
+    m_highlighter->setDocument(document());
+
+    // The highlighter processes the reported range at once, which also replaces
+    // the pass over the whole document it schedules when it's attached
+    auto first = cursorForPosition(QPoint(0, 0)).block();
+    auto last = cursorForPosition(QPoint(viewport()->width(), viewport()->height())).block();
+    document()->markContentsDirty(first.position(), last.position() + last.length() - first.position());
+
+    // The visible blocks are highlighted again in order, when their real previous states are known
+    m_highlightBlock = 0;
+    m_highlightTimer->start();
 }
 
-QCompleter *QCodeEditor::completer() const
+void QCodeEditor::highlightNextBlocks()
 {
-    return m_completer;
+    auto block = document()->findBlockByNumber(m_highlightBlock);
+
+    for (int i = 0; block.isValid() && i < HighlightChunkBlocks; ++i, block = block.next())
+    {
+        m_highlighter->rehighlightBlock(block);
+    }
+
+    if (!block.isValid())
+    {
+        m_highlightTimer->stop();
+        m_highlightBlock = -1;
+        return;
+    }
+
+    m_highlightBlock = block.blockNumber();
 }
 
-void QCodeEditor::squiggle(SeverityLevel level, QPair<int, int> start, QPair<int, int> stop,
-                           const QString &tooltipMessage)
+void QCodeEditor::highlightVisibleBlocks()
 {
-    if (stop < start)
+    if (!m_highlighter || m_highlightBlock < 0)
+    {
         return;
+    }
 
-    SquiggleInformation info(start, stop, tooltipMessage);
-    m_squiggler.push_back(info);
+    auto block = document()->findBlockByNumber(qMax(getFirstVisibleBlock(), m_highlightBlock));
+    auto bottom = viewport()->height();
 
-    auto cursor = textCursor();
+    // Blocks above the background highlighting are up to date already
+    for (; block.isValid(); block = block.next())
+    {
+        if (!block.isVisible())
+        {
+            continue;
+        }
 
-    cursor.movePosition(QTextCursor::Start);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor, start.first - 1);
-    cursor.movePosition(QTextCursor::StartOfBlock);
-    cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::MoveAnchor, start.second);
+        auto top = document()->documentLayout()->blockBoundingRect(block).top() - verticalScrollBar()->value();
+        if (top > bottom)
+        {
+            break;
+        }
 
-    if (stop.first > start.first)
-        cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, stop.first - start.first);
+        m_highlighter->rehighlightBlock(block);
+    }
+}
 
-    cursor.movePosition(QTextCursor::StartOfBlock, QTextCursor::KeepAnchor);
-    cursor.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, stop.second);
+bool QCodeEditor::saveFile(const QString &path, bool replaceInvalid)
+{
+    // The original bytes are lost, U+FFFD would be written instead
+    if (m_invalidSequences > 0 && !replaceInvalid)
+    {
+        return false;
+    }
 
-    QTextCharFormat newcharfmt = currentCharFormat();
-    newcharfmt.setFontUnderline(true);
+    QFile fl(path);
 
-    switch (level)
+    if (!fl.open(QIODevice::WriteOnly | QIODevice::Truncate))
     {
-    case SeverityLevel::Error:
-        newcharfmt.setUnderlineColor(m_syntaxStyle->getFormat("Error").underlineColor());
-        newcharfmt.setUnderlineStyle(m_syntaxStyle->getFormat("Error").underlineStyle());
-        break;
-    case SeverityLevel::Warning:
-        newcharfmt.setUnderlineColor(m_syntaxStyle->getFormat("Warning").underlineColor());
-        newcharfmt.setUnderlineStyle(m_syntaxStyle->getFormat("Warning").underlineStyle());
-        break;
-    case SeverityLevel::Information:
-        newcharfmt.setUnderlineColor(m_syntaxStyle->getFormat("Warning").underlineColor());
-        newcharfmt.setUnderlineStyle(QTextCharFormat::DotLine);
-        break;
-    case SeverityLevel::Hint:
-        newcharfmt.setUnderlineColor(m_syntaxStyle->getFormat("Text").foreground().color());
-        newcharfmt.setUnderlineStyle(QTextCharFormat::DotLine);
+        return false;
+    }
+
+    // Unlike toPlainText, keeps non-breaking spaces and line separators, only blocks are separated
+    auto text = document()->toRawText();
+    text.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+
+    auto data = QDocumentCodec::encode(text, m_encoding, m_lineEnding);
+
+    if (fl.write(data) != data.size())
+    {
+        return false;
     }
 
-    extra_squiggles.push_back({cursor, newcharfmt});
+    m_invalidSequences = 0;
 
-    m_lineNumberArea->lint(level, start.first, stop.first);
+    // Lines are marked as changed since the last save
+    document()->setModified(false);
 
-    setExtraSelections(extra1 + extra2 + extra_squiggles);
+    return true;
 }
 
-void QCodeEditor::clearSquiggle()
+void QCodeEditor::setEncoding(QDocumentCodec::Encoding encoding)
 {
-    if (m_squiggler.empty())
-        return;
+    m_encoding = encoding;
+}
 
-    m_squiggler.clear();
-    extra_squiggles.clear();
+QDocumentCodec::Encoding QCodeEditor::encoding() const
+{
+    return m_encoding;
+}
+
+void QCodeEditor::setLineEnding(QDocumentCodec::LineEnding lineEnding)
+{
+    m_lineEnding = lineEnding;
+}
+
+QDocumentCodec::LineEnding QCodeEditor::lineEnding() const
+{
+    return m_lineEnding;
+}
 
-    m_lineNumberArea->clearLint();
+int QCodeEditor::invalidSequences() const
+{
+    return m_invalidSequences;
+}
 
-    setExtraSelections(extra1 + extra2);
+void QCodeEditor::clearSquiggle()
+{
+    m_diagnostics->clear();
 }
 
 QChar QCodeEditor::charUnderCursor(int offset) const
@@ -1084,108 +3020,52 @@ void QCodeEditor::insertFromMimeData(const QMimeData *source)
 bool QCodeEditor::removeInEachLineOfSelection(const QRegularExpression &regex, bool force)
 {
     auto cursor = textCursor();
-    auto lines = toPlainText().remove('\r').split('\n');
-    int selectionStart = cursor.selectionStart();
-    int selectionEnd = cursor.selectionEnd();
-    bool cursorAtEnd = cursor.position() == selectionEnd;
-    cursor.setPosition(selectionStart);
-    int lineStart = cursor.blockNumber();
-    cursor.setPosition(selectionEnd);
-    int lineEnd = cursor.blockNumber();
-    QString newText;
-    QTextStream stream(&newText);
-    int deleteTotal = 0, deleteFirst = 0;
-    for (int i = lineStart; i <= lineEnd; ++i)
-    {
-        auto line = lines[i];
-        auto match = regex.match(line).captured(1);
-        int len = match.length();
+
+    // Ranges to remove as pairs of position and length
+    QVector<QPair<int, int>> removals;
+    for (auto &block : selectedBlocks())
+    {
+        auto match = regex.match(block.text());
+        int len = match.capturedLength(1);
         if (len == 0 && !force)
             return false;
-        if (i == lineStart)
-            deleteFirst = len;
-        deleteTotal += len;
-        stream << line.remove(line.indexOf(match), len);
-        if (i != lineEnd)
-#if QT_VERSION >= 0x50E00
-            stream << Qt::endl;
-#else
-            stream << endl;
-#endif
-    }
-    cursor.movePosition(QTextCursor::Start);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor, lineStart);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, lineEnd - lineStart);
-    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
-    cursor.insertText(newText);
-    cursor.setPosition(qMax(0, selectionStart - deleteFirst));
-    if (cursor.blockNumber() < lineStart)
-    {
-        cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor, lineStart - cursor.blockNumber());
-        cursor.movePosition(QTextCursor::StartOfBlock);
-    }
-    int pos = cursor.position();
-    cursor.setPosition(selectionEnd - deleteTotal);
-    if (cursor.blockNumber() < lineEnd)
-    {
-        cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor, lineEnd - cursor.blockNumber());
-        cursor.movePosition(QTextCursor::StartOfBlock);
-    }
-    int pos2 = cursor.position();
-    if (cursorAtEnd)
-    {
-        cursor.setPosition(pos);
-        cursor.setPosition(pos2, QTextCursor::KeepAnchor);
+        if (len > 0)
+            removals.append({block.position() + match.capturedStart(1), len});
     }
-    else
+
+    // Backwards, so that the collected positions stay valid. The selection
+    // follows the edits since the editor cursor is adjusted by the document.
+    cursor.beginEditBlock();
+    for (int i = removals.size() - 1; i >= 0; --i)
     {
-        cursor.setPosition(pos2);
-        cursor.setPosition(pos, QTextCursor::KeepAnchor);
+        cursor.setPosition(removals[i].first);
+        cursor.setPosition(removals[i].first + removals[i].second, QTextCursor::KeepAnchor);
+        cursor.removeSelectedText();
     }
-    setTextCursor(cursor);
+    cursor.endEditBlock();
+
     return true;
 }
 
 void QCodeEditor::addInEachLineOfSelection(const QRegularExpression &regex, const QString &str)
 {
     auto cursor = textCursor();
-    auto lines = toPlainText().remove('\r').split('\n');
-    int selectionStart = cursor.selectionStart();
-    int selectionEnd = cursor.selectionEnd();
-    bool cursorAtEnd = cursor.position() == selectionEnd;
-    cursor.setPosition(selectionStart);
-    int lineStart = cursor.blockNumber();
-    cursor.setPosition(selectionEnd);
-    int lineEnd = cursor.blockNumber();
-    QString newText;
-    QTextStream stream(&newText);
-    for (int i = lineStart; i <= lineEnd; ++i)
-    {
-        auto line = lines[i];
-        stream << line.insert(line.indexOf(regex), str);
-        if (i != lineEnd)
-#if QT_VERSION >= 0x50E00
-            stream << Qt::endl;
-#else
-            stream << endl;
-#endif
-    }
-    cursor.movePosition(QTextCursor::Start);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::MoveAnchor, lineStart);
-    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, lineEnd - lineStart);
-    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
-    cursor.insertText(newText);
-    int pos = selectionStart + str.length();
-    int pos2 = selectionEnd + str.length() * (lineEnd - lineStart + 1);
-    if (cursorAtEnd)
+
+    QVector<int> insertions;
+    for (auto &block : selectedBlocks())
     {
-        cursor.setPosition(pos);
-        cursor.setPosition(pos2, QTextCursor::KeepAnchor);
+        int index = block.text().indexOf(regex);
+        if (index >= 0)
+            insertions.append(block.position() + index);
     }
-    else
+
+    // Backwards, so that the collected positions stay valid. The selection
+    // follows the edits since the editor cursor is adjusted by the document.
+    cursor.beginEditBlock();
+    for (int i = insertions.size() - 1; i >= 0; --i)
     {
-        cursor.setPosition(pos2);
-        cursor.setPosition(pos, QTextCursor::KeepAnchor);
+        cursor.setPosition(insertions[i]);
+        cursor.insertText(str);
     }
-    setTextCursor(cursor);
+    cursor.endEditBlock();
 }
@@ -0,0 +1,224 @@
+// QCodeEditor
+#include <QCompletionEngine>
+
+// Qt
+#include <QRunnable>
+#include <QThreadPool>
+
+/**
+ * @brief Class, that describes query of a provider in a
+ * worker thread.
+ */
+class QCompletionEngine::Task : public QRunnable
+{
+  public:
+    Task(QCompletionEngine *engine, QCompletionProvider *provider, int requestId,
+         const QCompletionProvider::Request &request)
+        : QRunnable(), m_engine(engine), m_provider(provider), m_requestId(requestId), m_request(request)
+    {
+    }
+
+    void run() override
+    {
+        QStringList results;
+
+        // Stale requests are skipped, but still reported, so the provider can be queried again
+        if (!m_request.isCancelled())
+        {
+            results = m_provider->complete(m_request);
+        }
+
+        auto engine = m_engine;
+        auto provider = m_provider;
+        auto id = m_requestId;
+
+        QMetaObject::invokeMethod(
+            engine, [engine, provider, id, results] { engine->taskDone(provider, id, results); },
+            Qt::QueuedConnection);
+    }
+
+  private:
+    QCompletionEngine *m_engine;
+    QCompletionProvider *m_provider;
+    int m_requestId;
+    QCompletionProvider::Request m_request;
+};
+
+QCompletionEngine::QCompletionEngine(QObject *parent)
+    : QObject(parent), m_pool(new QThreadPool(this)), m_entries(), m_request(), m_requestId(0), m_cancelled(),
+      m_pendingCount(0), m_results(), m_merged()
+{
+}
+
+QCompletionEngine::~QCompletionEngine()
+{
+    cancel();
+    m_pool->waitForDone();
+}
+
+void QCompletionEngine::addProvider(QCompletionProvider *provider)
+{
+    if (provider == nullptr || indexOf(provider) >= 0)
+    {
+        return;
+    }
+
+    provider->setParent(this);
+    m_entries.append(Entry(provider));
+}
+
+void QCompletionEngine::removeProvider(QCompletionProvider *provider)
+{
+    auto index = indexOf(provider);
+    if (index < 0)
+    {
+        return;
+    }
+
+    // The provider may be deleted by the caller, so no worker may use it anymore
+    cancel();
+    m_pool->waitForDone();
+
+    m_entries.remove(index);
+    provider->setParent(nullptr);
+}
+
+QVector<QCompletionProvider *> QCompletionEngine::providers() const
+{
+    QVector<QCompletionProvider *> result;
+    result.reserve(m_entries.size());
+
+    for (auto &entry : m_entries)
+    {
+        result.append(entry.provider);
+    }
+
+    return result;
+}
+
+void QCompletionEngine::request(const QCompletionProvider::Request &request)
+{
+    cancel();
+
+    m_cancelled = std::make_shared<std::atomic<bool>>(false);
+
+    m_request = request;
+    m_request.cancelled = m_cancelled;
+    m_pendingCount = static_cast<int>(m_entries.size());
+
+    for (int i = 0; i < m_entries.size(); ++i)
+    {
+        // A provider is queried by one worker at a time, so a busy one is queried once it's done
+        if (m_entries[i].running)
+        {
+            m_entries[i].pending = true;
+        }
+        else
+        {
+            start(i);
+        }
+    }
+
+    if (m_pendingCount == 0)
+    {
+        Q_EMIT finished(m_request.prefix);
+    }
+}
+
+void QCompletionEngine::cancel()
+{
+    if (m_cancelled)
+    {
+        *m_cancelled = true;
+    }
+
+    ++m_requestId;
+
+    for (auto &entry : m_entries)
+    {
+        entry.pending = false;
+    }
+
+    m_request = QCompletionProvider::Request();
+    m_pendingCount = 0;
+    m_results.clear();
+    m_merged.clear();
+}
+
+QCompletionProvider::Request QCompletionEngine::currentRequest() const
+{
+    return m_request;
+}
+
+bool QCompletionEngine::isRunning() const
+{
+    return m_pendingCount > 0;
+}
+
+QStringList QCompletionEngine::results() const
+{
+    return m_results;
+}
+
+void QCompletionEngine::start(int index)
+{
+    auto &entry = m_entries[index];
+    entry.running = true;
+    entry.pending = false;
+
+    entry.provider->prepare(m_request);
+    m_pool->start(new Task(this, entry.provider, m_requestId, m_request));
+}
+
+void QCompletionEngine::taskDone(QCompletionProvider *provider, int requestId, const QStringList &results)
+{
+    auto index = indexOf(provider);
+    if (index < 0)
+    {
+        return;
+    }
+
+    m_entries[index].running = false;
+
+    if (m_entries[index].pending)
+    {
+        start(index);
+        return;
+    }
+
+    if (requestId != m_requestId)
+    {
+        return;
+    }
+
+    for (auto &result : results)
+    {
+        if (!m_merged.contains(result))
+        {
+            m_merged.insert(result);
+            m_results.append(result);
+        }
+    }
+
+    --m_pendingCount;
+
+    Q_EMIT resultsChanged(m_request.prefix, m_results);
+
+    if (m_pendingCount == 0)
+    {
+        Q_EMIT finished(m_request.prefix);
+    }
+}
+
+int QCompletionEngine::indexOf(QCompletionProvider *provider) const
+{
+    for (int i = 0; i < m_entries.size(); ++i)
+    {
+        if (m_entries[i].provider == provider)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,10 @@
+// QCodeEditor
+#include <QCompletionProvider>
+
+QCompletionProvider::QCompletionProvider(QObject *parent) : QObject(parent)
+{
+}
+
+void QCompletionProvider::prepare(const Request &)
+{
+}
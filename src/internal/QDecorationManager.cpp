@@ -0,0 +1,237 @@
+// QCodeEditor
+#include <QDecorationManager>
+
+// Qt
+#include <QTextDocument>
+
+// std
+#include <algorithm>
+
+namespace
+{
+bool startsBefore(const QDecorationManager::Decoration &decoration, int position)
+{
+    return decoration.start < position;
+}
+} // namespace
+
+QDecorationManager::QDecorationManager(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_layers(), m_changeFilter(document)
+{
+    connect(document, &QTextDocument::contentsChange, this, &QDecorationManager::onContentsChange);
+}
+
+void QDecorationManager::addLayer(const QString &name, int z, Rendering rendering)
+{
+    if (hasLayer(name))
+    {
+        return;
+    }
+
+    Layer layer;
+    layer.name = name;
+    layer.z = z;
+    layer.rendering = rendering;
+
+    auto it = std::upper_bound(m_layers.begin(), m_layers.end(), z,
+                               [](int value, const Layer &other) { return value < other.z; });
+    m_layers.insert(it, layer);
+}
+
+bool QDecorationManager::hasLayer(const QString &name) const
+{
+    return findLayer(name) != nullptr;
+}
+
+QStringList QDecorationManager::layers() const
+{
+    QStringList names;
+
+    for (auto &layer : m_layers)
+    {
+        names.append(layer.name);
+    }
+
+    return names;
+}
+
+QDecorationManager::Rendering QDecorationManager::rendering(const QString &layer) const
+{
+    auto found = findLayer(layer);
+    return found ? found->rendering : Rendering::Painted;
+}
+
+void QDecorationManager::setDecorations(const QString &layer, QVector<Decoration> decorations)
+{
+    auto found = findLayer(layer);
+    if (!found || (found->decorations.isEmpty() && decorations.isEmpty()))
+    {
+        return;
+    }
+
+    std::stable_sort(decorations.begin(), decorations.end(),
+                     [](const Decoration &a, const Decoration &b) { return a.start < b.start; });
+
+    found->maxLength = 0;
+    for (auto &decoration : decorations)
+    {
+        found->maxLength = qMax(found->maxLength, decoration.end - decoration.start);
+    }
+
+    found->decorations = std::move(decorations);
+    markDirty(found);
+}
+
+void QDecorationManager::addDecoration(const QString &layer, const Decoration &decoration)
+{
+    auto found = findLayer(layer);
+    if (!found)
+    {
+        return;
+    }
+
+    // After the decorations with the same start, keeps insertion order
+    auto it = std::lower_bound(found->decorations.begin(), found->decorations.end(), decoration.start + 1,
+                               startsBefore);
+    found->decorations.insert(it, decoration);
+    found->maxLength = qMax(found->maxLength, decoration.end - decoration.start);
+
+    markDirty(found);
+}
+
+void QDecorationManager::clear(const QString &layer)
+{
+    auto found = findLayer(layer);
+    if (!found || found->decorations.isEmpty())
+    {
+        return;
+    }
+
+    found->decorations.clear();
+    found->maxLength = 0;
+
+    markDirty(found);
+}
+
+int QDecorationManager::count(const QString &layer) const
+{
+    auto found = findLayer(layer);
+    return found ? found->decorations.size() : 0;
+}
+
+QVector<QDecorationManager::Decoration> QDecorationManager::decorations(const QString &layer) const
+{
+    auto found = findLayer(layer);
+    return found ? found->decorations : QVector<Decoration>();
+}
+
+QVector<QDecorationManager::Decoration> QDecorationManager::decorations(const QString &layer, int from, int to) const
+{
+    QVector<Decoration> result;
+
+    auto found = findLayer(layer);
+    if (!found)
+    {
+        return result;
+    }
+
+    // Nothing starting before this can reach `from`
+    auto it = std::lower_bound(found->decorations.begin(), found->decorations.end(), from - found->maxLength,
+                               startsBefore);
+
+    for (; it != found->decorations.end() && it->start <= to; ++it)
+    {
+        if (it->end >= from)
+        {
+            result.append(*it);
+        }
+    }
+
+    return result;
+}
+
+QStringList QDecorationManager::takeDirtyLayers()
+{
+    QStringList names;
+
+    for (auto &layer : m_layers)
+    {
+        if (layer.dirty)
+        {
+            names.append(layer.name);
+            layer.dirty = false;
+        }
+    }
+
+    return names;
+}
+
+void QDecorationManager::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // Format changes (e.g. by the highlighter) are reported this way too
+    if (!m_changeFilter.isTextChange(charsRemoved, charsAdded))
+    {
+        return;
+    }
+
+    const int removedEnd = position + charsRemoved;
+    const int addedEnd = position + charsAdded;
+    const int delta = charsAdded - charsRemoved;
+
+    auto map = [&](int offset) {
+        if (offset >= removedEnd)
+        {
+            return offset + delta;
+        }
+
+        // Inside the removed text
+        return qMin(offset, addedEnd);
+    };
+
+    for (auto &layer : m_layers)
+    {
+        auto it = std::lower_bound(layer.decorations.begin(), layer.decorations.end(), position - layer.maxLength,
+                                   startsBefore);
+
+        // Mapping is monotonic, so the order is kept
+        for (; it != layer.decorations.end(); ++it)
+        {
+            it->start = map(it->start);
+            it->end = map(it->end);
+            layer.maxLength = qMax(layer.maxLength, it->end - it->start);
+        }
+    }
+}
+
+QDecorationManager::Layer *QDecorationManager::findLayer(const QString &name)
+{
+    for (auto &layer : m_layers)
+    {
+        if (layer.name == name)
+        {
+            return &layer;
+        }
+    }
+
+    return nullptr;
+}
+
+const QDecorationManager::Layer *QDecorationManager::findLayer(const QString &name) const
+{
+    for (auto &layer : m_layers)
+    {
+        if (layer.name == name)
+        {
+            return &layer;
+        }
+    }
+
+    return nullptr;
+}
+
+void QDecorationManager::markDirty(Layer *layer)
+{
+    layer->dirty = true;
+
+    Q_EMIT layerChanged(layer->name);
+}
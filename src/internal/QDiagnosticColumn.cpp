@@ -0,0 +1,80 @@
+// QCodeEditor
+#include <QCodeEditor>
+#include <QDiagnosticColumn>
+#include <QDiagnosticStore>
+#include <QSyntaxStyle>
+
+// Qt
+#include <QPainter>
+#include <QTextBlock>
+#include <QTextDocument>
+
+namespace
+{
+constexpr int MarkerWidth = 7;
+} // namespace
+
+QDiagnosticColumn::QDiagnosticColumn(QCodeEditor *editor)
+    : QGutterColumn("Diagnostics", editor), m_firstBlockNumber(0), m_severities()
+{
+}
+
+int QDiagnosticColumn::computeWidth() const
+{
+    return MarkerWidth;
+}
+
+void QDiagnosticColumn::beginPaint(const QTextBlock &first, const QTextBlock &last)
+{
+    auto document = editor()->document();
+
+    m_firstBlockNumber = first.blockNumber();
+    auto lastBlockNumber = last.blockNumber();
+
+    m_severities.fill(-1, qMax(lastBlockNumber - m_firstBlockNumber + 1, 0));
+
+    for (auto &range : editor()->diagnostics()->diagnostics(first.position(), last.position() + last.length()))
+    {
+        auto from = qMax(document->findBlock(range.start).blockNumber(), m_firstBlockNumber);
+        auto to = qMin(document->findBlock(range.end).blockNumber(), lastBlockNumber);
+
+        for (auto i = from; i <= to; ++i)
+        {
+            auto &severity = m_severities[i - m_firstBlockNumber];
+            severity = qMax(severity, static_cast<int>(range.level));
+        }
+    }
+}
+
+void QDiagnosticColumn::paintRow(QPainter &painter, const QRect &rect, const QTextBlock &, int blockNumber)
+{
+    auto row = blockNumber - m_firstBlockNumber;
+    if (row < 0 || row >= m_severities.size() || m_severities[row] < 0)
+    {
+        return;
+    }
+
+    auto style = editor()->syntaxStyle();
+
+    QColor color;
+    switch (static_cast<QCodeEditor::SeverityLevel>(m_severities[row]))
+    {
+    case QCodeEditor::SeverityLevel::Error:
+        color = style->getFormat("Error").underlineColor();
+        break;
+    case QCodeEditor::SeverityLevel::Warning:
+        color = style->getFormat("Warning").underlineColor();
+        break;
+    case QCodeEditor::SeverityLevel::Information:
+        color = style->getFormat("Warning").underlineColor();
+        break;
+    case QCodeEditor::SeverityLevel::Hint:
+        color = style->getFormat("Text").foreground().color();
+        break;
+    default:
+        Q_UNREACHABLE();
+        break;
+    }
+
+    painter.fillRect(rect, color);
+}
@@ -0,0 +1,589 @@
+// QCodeEditor
+#include <QDiagnosticStore>
+
+// Qt
+#include <QTextBlock>
+#include <QTextDocument>
+
+// std
+#include <algorithm>
+#include <limits>
+
+QDiagnosticStore::QDiagnosticStore(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_document(document), m_root(nullptr), m_count(0), m_seed(2463534242u), m_ids(),
+      m_version(0), m_journal(), m_lineLengths(), m_changeFilter(document)
+{
+    connect(document, &QTextDocument::contentsChange, this, &QDiagnosticStore::onContentsChange);
+
+    indexLines();
+}
+
+QDiagnosticStore::~QDiagnosticStore()
+{
+    destroy(m_root);
+}
+
+int QDiagnosticStore::version() const
+{
+    return m_version;
+}
+
+bool QDiagnosticStore::isMappable(int version) const
+{
+    return version < 0 || (version <= m_version && m_version - version <= m_journal.size());
+}
+
+QPositionMapper::Position QDiagnosticStore::mapPosition(QPositionMapper::Position position, int version) const
+{
+    if (version < 0)
+    {
+        return position;
+    }
+
+    for (int i = m_journal.size() - (m_version - version); i < m_journal.size(); ++i)
+    {
+        position = map(position, m_journal[i]);
+    }
+
+    return position;
+}
+
+bool QDiagnosticStore::setDiagnostics(QVector<Range> ranges, int version)
+{
+    if (!isMappable(version))
+    {
+        return false;
+    }
+
+    if (m_count == 0 && ranges.isEmpty())
+    {
+        return true;
+    }
+
+    for (auto &range : ranges)
+    {
+        range.start = mapOffset(range.start, version);
+        range.end = mapOffset(range.end, version);
+    }
+
+    std::stable_sort(ranges.begin(), ranges.end(), [](const Range &a, const Range &b) { return a.start < b.start; });
+
+    destroy(m_root);
+    m_root = nullptr;
+    m_count = 0;
+    m_ids.clear();
+
+    // Cartesian tree of the sorted nodes, built in O(n)
+    QVector<Node *> rightSpine;
+
+    for (auto &range : ranges)
+    {
+        auto node = createNode(range);
+
+        Node *last = nullptr;
+        while (!rightSpine.isEmpty() && rightSpine.last()->priority < node->priority)
+        {
+            last = rightSpine.takeLast();
+        }
+
+        node->left = last;
+
+        if (!rightSpine.isEmpty())
+        {
+            rightSpine.last()->right = node;
+        }
+
+        rightSpine.append(node);
+    }
+
+    if (!rightSpine.isEmpty())
+    {
+        m_root = rightSpine.first();
+        pullAll(m_root);
+    }
+
+    Q_EMIT changed();
+
+    return true;
+}
+
+bool QDiagnosticStore::updateDiagnostics(const QVector<Range> &added, const QVector<int> &removedIds, int version)
+{
+    if (!isMappable(version))
+    {
+        return false;
+    }
+
+    for (auto id : removedIds)
+    {
+        if (auto node = m_ids.value(id))
+        {
+            removeNode(node);
+        }
+    }
+
+    for (auto range : added)
+    {
+        if (auto node = m_ids.value(range.id))
+        {
+            removeNode(node);
+        }
+
+        range.start = mapOffset(range.start, version);
+        range.end = mapOffset(range.end, version);
+
+        insertNode(createNode(range));
+    }
+
+    if (!added.isEmpty() || !removedIds.isEmpty())
+    {
+        Q_EMIT changed();
+    }
+
+    return true;
+}
+
+void QDiagnosticStore::addDiagnostic(const Range &range)
+{
+    updateDiagnostics({range}, {});
+}
+
+void QDiagnosticStore::clear()
+{
+    if (m_count == 0)
+    {
+        return;
+    }
+
+    destroy(m_root);
+    m_root = nullptr;
+    m_count = 0;
+    m_ids.clear();
+
+    Q_EMIT changed();
+}
+
+int QDiagnosticStore::count() const
+{
+    return m_count;
+}
+
+QVector<QDiagnosticStore::Range> QDiagnosticStore::diagnostics() const
+{
+    return diagnostics(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+}
+
+QVector<QDiagnosticStore::Range> QDiagnosticStore::diagnostics(int from, int to) const
+{
+    QVector<Range> result;
+    collect(m_root, from, to, 0, result);
+    return result;
+}
+
+void QDiagnosticStore::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // Format changes (e.g. by the highlighter) are reported this way too
+    if (!m_changeFilter.isTextChange(charsRemoved, charsAdded))
+    {
+        return;
+    }
+
+    Edit edit(position, charsRemoved, charsAdded);
+    mapLines(edit);
+
+    ++m_version;
+    m_journal.append(edit);
+
+    if (m_journal.size() > MaxJournalSize)
+    {
+        m_journal.removeFirst();
+    }
+
+    if (!m_root)
+    {
+        return;
+    }
+
+    // Diagnostics starting before, in and after the removed text
+    Node *before;
+    Node *removed;
+    Node *after;
+    split(m_root, position, before, after);
+    split(after, position + charsRemoved, removed, after);
+
+    mapEnds(before, position, edit);
+    mapAll(removed, edit);
+    shift(after, charsAdded - charsRemoved);
+
+    // Mapping is monotonic, so the order is kept
+    m_root = merge(merge(before, removed), after);
+    m_root->parent = nullptr;
+}
+
+int QDiagnosticStore::map(int offset, const Edit &edit)
+{
+    if (offset >= edit.position + edit.charsRemoved)
+    {
+        return offset + edit.charsAdded - edit.charsRemoved;
+    }
+
+    // Inside the removed text
+    return qMin(offset, edit.position + edit.charsAdded);
+}
+
+QPositionMapper::Position QDiagnosticStore::map(const QPositionMapper::Position &position, const Edit &edit)
+{
+    auto before = [](const QPositionMapper::Position &a, const QPositionMapper::Position &b) {
+        return a.line < b.line || (a.line == b.line && a.column < b.column);
+    };
+
+    if (before(position, edit.start))
+    {
+        return position;
+    }
+
+    if (before(position, edit.removedEnd))
+    {
+        // Inside the removed text
+        return edit.start;
+    }
+
+    if (position.line == edit.removedEnd.line)
+    {
+        return {edit.addedEnd.line, position.column - edit.removedEnd.column + edit.addedEnd.column};
+    }
+
+    return {position.line + edit.addedEnd.line - edit.removedEnd.line, position.column};
+}
+
+void QDiagnosticStore::shift(Node *node, int delta)
+{
+    if (!node || delta == 0)
+    {
+        return;
+    }
+
+    node->range.start += delta;
+    node->range.end += delta;
+    node->maxEnd += delta;
+    node->shift += delta;
+}
+
+void QDiagnosticStore::push(Node *node)
+{
+    if (node->shift != 0)
+    {
+        shift(node->left, node->shift);
+        shift(node->right, node->shift);
+        node->shift = 0;
+    }
+}
+
+void QDiagnosticStore::pull(Node *node)
+{
+    node->maxEnd = node->range.end;
+
+    if (node->left)
+    {
+        node->maxEnd = qMax(node->maxEnd, node->left->maxEnd);
+        node->left->parent = node;
+    }
+
+    if (node->right)
+    {
+        node->maxEnd = qMax(node->maxEnd, node->right->maxEnd);
+        node->right->parent = node;
+    }
+}
+
+void QDiagnosticStore::pullAll(Node *node)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    pullAll(node->left);
+    pullAll(node->right);
+    pull(node);
+}
+
+QDiagnosticStore::Node *QDiagnosticStore::merge(Node *a, Node *b)
+{
+    if (!a || !b)
+    {
+        return a ? a : b;
+    }
+
+    if (a->priority > b->priority)
+    {
+        push(a);
+        a->right = merge(a->right, b);
+        pull(a);
+        return a;
+    }
+
+    push(b);
+    b->left = merge(a, b->left);
+    pull(b);
+    return b;
+}
+
+void QDiagnosticStore::split(Node *node, int position, Node *&left, Node *&right)
+{
+    if (!node)
+    {
+        left = right = nullptr;
+        return;
+    }
+
+    push(node);
+
+    if (node->range.start < position)
+    {
+        split(node->right, position, node->right, right);
+        left = node;
+        pull(left);
+        left->parent = nullptr;
+    }
+    else
+    {
+        split(node->left, position, left, node->left);
+        right = node;
+        pull(right);
+        right->parent = nullptr;
+    }
+}
+
+void QDiagnosticStore::destroy(Node *node)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    destroy(node->left);
+    destroy(node->right);
+    delete node;
+}
+
+void QDiagnosticStore::collect(const Node *node, int from, int to, int offset, QVector<Range> &result)
+{
+    // Nothing in this subtree reaches `from`
+    if (!node || node->maxEnd + offset < from)
+    {
+        return;
+    }
+
+    const int childOffset = offset + node->shift;
+
+    collect(node->left, from, to, childOffset, result);
+
+    // The right subtree starts even later
+    if (node->range.start + offset > to)
+    {
+        return;
+    }
+
+    if (node->range.end + offset >= from)
+    {
+        auto range = node->range;
+        range.start += offset;
+        range.end += offset;
+        result.append(range);
+    }
+
+    collect(node->right, from, to, childOffset, result);
+}
+
+void QDiagnosticStore::mapEnds(Node *node, int position, const Edit &edit)
+{
+    if (!node || node->maxEnd < position)
+    {
+        return;
+    }
+
+    push(node);
+
+    mapEnds(node->left, position, edit);
+
+    if (node->range.end >= position)
+    {
+        node->range.end = map(node->range.end, edit);
+    }
+
+    mapEnds(node->right, position, edit);
+
+    pull(node);
+}
+
+void QDiagnosticStore::mapAll(Node *node, const Edit &edit)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    push(node);
+
+    node->range.start = map(node->range.start, edit);
+    node->range.end = map(node->range.end, edit);
+
+    mapAll(node->left, edit);
+    mapAll(node->right, edit);
+
+    pull(node);
+}
+
+int QDiagnosticStore::mapOffset(int offset, int version) const
+{
+    if (version < 0)
+    {
+        return offset;
+    }
+
+    for (int i = m_journal.size() - (m_version - version); i < m_journal.size(); ++i)
+    {
+        offset = map(offset, m_journal[i]);
+    }
+
+    return offset;
+}
+
+void QDiagnosticStore::mapLines(Edit &edit)
+{
+    // Some changes report the final separator too
+    auto end = qMin(edit.position + edit.charsAdded, m_document->characterCount() - 1);
+
+    auto startBlock = m_document->findBlock(edit.position);
+    auto endBlock = m_document->findBlock(end);
+    if (!startBlock.isValid() || !endBlock.isValid() || m_lineLengths.isEmpty())
+    {
+        indexLines();
+        return;
+    }
+
+    edit.start = {startBlock.blockNumber(), edit.position - startBlock.position()};
+    edit.addedEnd = {endBlock.blockNumber(), end - endBlock.position()};
+
+    // Text after the edit is unchanged, so the old end line differs from the new one only before it
+    auto suffix = endBlock.length() - 1 - edit.addedEnd.column;
+    auto lineCount = static_cast<int>(m_lineLengths.size());
+    auto removedLines = edit.addedEnd.line - edit.start.line - (m_document->blockCount() - lineCount);
+    auto removedEndLine = qBound(edit.start.line, edit.start.line + removedLines, lineCount - 1);
+
+    edit.removedEnd = {removedEndLine, qMax(m_lineLengths[removedEndLine] - suffix, 0)};
+
+    // Replace lengths of the removed lines with the added ones
+    auto delta = (edit.addedEnd.line - edit.start.line) - (removedEndLine - edit.start.line);
+    if (delta > 0)
+    {
+        m_lineLengths.insert(edit.start.line, delta, 0);
+    }
+    else if (delta < 0)
+    {
+        m_lineLengths.remove(edit.start.line, -delta);
+    }
+
+    auto block = startBlock;
+    for (int line = edit.start.line; line <= edit.addedEnd.line; ++line, block = block.next())
+    {
+        m_lineLengths[line] = block.length() - 1;
+    }
+
+    if (m_lineLengths.size() != m_document->blockCount())
+    {
+        indexLines();
+    }
+}
+
+void QDiagnosticStore::indexLines()
+{
+    m_lineLengths.clear();
+    m_lineLengths.reserve(m_document->blockCount());
+
+    for (auto block = m_document->firstBlock(); block.isValid(); block = block.next())
+    {
+        m_lineLengths.append(block.length() - 1);
+    }
+}
+
+QDiagnosticStore::Node *QDiagnosticStore::createNode(const Range &range)
+{
+    // xorshift32
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    auto node = new Node(range);
+    node->priority = m_seed;
+
+    if (range.id >= 0)
+    {
+        m_ids.insert(range.id, node);
+    }
+
+    ++m_count;
+
+    return node;
+}
+
+void QDiagnosticStore::insertNode(Node *node)
+{
+    // After the diagnostics with the same start, keeps insertion order
+    Node *left;
+    Node *right;
+    split(m_root, node->range.start + 1, left, right);
+
+    m_root = merge(merge(left, node), right);
+    m_root->parent = nullptr;
+}
+
+void QDiagnosticStore::removeNode(Node *node)
+{
+    // Pending shifts of the ancestors must reach the children first
+    QVector<Node *> path;
+    for (auto n = node; n; n = n->parent)
+    {
+        path.prepend(n);
+    }
+
+    for (auto n : qAsConst(path))
+    {
+        push(n);
+    }
+
+    auto parent = node->parent;
+    auto child = merge(node->left, node->right);
+
+    if (child)
+    {
+        child->parent = parent;
+    }
+
+    if (!parent)
+    {
+        m_root = child;
+    }
+    else if (parent->left == node)
+    {
+        parent->left = child;
+    }
+    else
+    {
+        parent->right = child;
+    }
+
+    for (auto n = parent; n; n = n->parent)
+    {
+        pull(n);
+    }
+
+    if (node->range.id >= 0)
+    {
+        m_ids.remove(node->range.id);
+    }
+
+    --m_count;
+    delete node;
+}
@@ -0,0 +1,430 @@
+// QCodeEditor
+#include <QDocumentCodec>
+
+// Qt
+#include <QVector>
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QCODEEDITOR_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+/**
+ * @brief Decodes one multi-byte UTF-8 sequence.
+ * @return Sequence length, 0 if it's malformed and
+ * -1 if it's cut by the end of data.
+ */
+int decodeUtf8Sequence(const uchar *p, int remaining, uint &codePoint)
+{
+    int length;
+    uint minimum;
+
+    if ((p[0] & 0xE0) == 0xC0)
+    {
+        length = 2;
+        minimum = 0x80;
+        codePoint = p[0] & 0x1F;
+    }
+    else if ((p[0] & 0xF0) == 0xE0)
+    {
+        length = 3;
+        minimum = 0x800;
+        codePoint = p[0] & 0x0F;
+    }
+    else if ((p[0] & 0xF8) == 0xF0)
+    {
+        length = 4;
+        minimum = 0x10000;
+        codePoint = p[0] & 0x07;
+    }
+    else
+    {
+        return 0;
+    }
+
+    for (int i = 1; i < length; ++i)
+    {
+        if (i >= remaining)
+        {
+            return -1;
+        }
+
+        if ((p[i] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+
+        codePoint = (codePoint << 6) | (p[i] & 0x3F);
+    }
+
+    // Overlong forms, surrogates and values beyond Unicode are malformed
+    if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+    {
+        return 0;
+    }
+
+    return length;
+}
+
+/**
+ * @brief Appends a normalised line break for the CR or LF at
+ * `data[i]` and returns the number of bytes consumed.
+ */
+template <typename Unit>
+int lineBreak(const Unit *data, int i, int size, QChar *out, int &o, QDocumentCodec::DecodeResult &result)
+{
+    int consumed = 1;
+
+    if (data[i] == Unit('\r'))
+    {
+        if (i + 1 < size && data[i + 1] == Unit('\n'))
+        {
+            ++result.crlf;
+            consumed = 2;
+        }
+        else
+        {
+            ++result.cr;
+        }
+    }
+    else
+    {
+        ++result.lf;
+    }
+
+    out[o++] = QLatin1Char('\n');
+
+    return consumed;
+}
+} // namespace
+
+QDocumentCodec::Encoding QDocumentCodec::detectEncoding(const QByteArray &data)
+{
+    if (data.startsWith("\xEF\xBB\xBF"))
+    {
+        return Encoding::Utf8Bom;
+    }
+
+    if (data.startsWith("\xFF\xFE"))
+    {
+        return Encoding::Utf16LE;
+    }
+
+    if (data.startsWith("\xFE\xFF"))
+    {
+        return Encoding::Utf16BE;
+    }
+
+    return isValidUtf8(data.constData(), data.size(), true) ? Encoding::Utf8 : Encoding::Latin1;
+}
+
+int QDocumentCodec::bomLength(Encoding encoding)
+{
+    switch (encoding)
+    {
+    case Encoding::Utf8Bom:
+        return 3;
+    case Encoding::Utf16LE:
+    case Encoding::Utf16BE:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+bool QDocumentCodec::isValidUtf8(const char *data, int size, bool allowTruncated)
+{
+    auto bytes = reinterpret_cast<const uchar *>(data);
+    int i = 0;
+
+    while (i < size)
+    {
+#ifdef QCODEEDITOR_HAS_SSE2
+        // Skip ASCII 16 bytes at a time
+        while (i + 16 <= size &&
+               _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i))) == 0)
+        {
+            i += 16;
+        }
+
+        if (i >= size)
+        {
+            break;
+        }
+#endif
+
+        if (bytes[i] < 0x80)
+        {
+            ++i;
+            continue;
+        }
+
+        uint codePoint;
+        auto length = decodeUtf8Sequence(bytes + i, size - i, codePoint);
+
+        if (length == -1)
+        {
+            return allowTruncated;
+        }
+
+        if (length == 0)
+        {
+            return false;
+        }
+
+        i += length;
+    }
+
+    return true;
+}
+
+int QDocumentCodec::lastLineBreak(const QByteArray &data, Encoding encoding, int from)
+{
+    from = qMax(from, 0);
+
+    if (encoding == Encoding::Utf16LE || encoding == Encoding::Utf16BE)
+    {
+        const int low = encoding == Encoding::Utf16LE ? 0 : 1;
+
+        for (int i = (data.size() & ~1) - 2; i >= (from & ~1); i -= 2)
+        {
+            if (data[i + low] == '\n' && data[i + 1 - low] == '\0')
+            {
+                return i + 2;
+            }
+        }
+
+        return 0;
+    }
+
+    for (int i = data.size() - 1; i >= from; --i)
+    {
+        if (data[i] == '\n')
+        {
+            return i + 1;
+        }
+    }
+
+    // Classic Mac line breaks, but never cut between CR and a following LF
+    for (int i = data.size() - 2; i >= from; --i)
+    {
+        if (data[i] == '\r')
+        {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+QDocumentCodec::DecodeResult QDocumentCodec::decode(const char *data, int size, Encoding encoding)
+{
+    DecodeResult result;
+
+    auto bytes = reinterpret_cast<const uchar *>(data);
+
+    if (encoding == Encoding::Utf16LE || encoding == Encoding::Utf16BE)
+    {
+        const int units = size / 2;
+        const bool bigEndian = encoding == Encoding::Utf16BE;
+
+        QVector<ushort> swapped(units);
+        for (int i = 0; i < units; ++i)
+        {
+            swapped[i] = bigEndian ? static_cast<ushort>((bytes[2 * i] << 8) | bytes[2 * i + 1])
+                                   : static_cast<ushort>(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+        }
+
+        result.text.resize(units + (size & 1));
+        auto out = result.text.data();
+        int o = 0;
+
+        for (int i = 0; i < units;)
+        {
+            auto unit = swapped[i];
+
+            if (unit == '\r' || unit == '\n')
+            {
+                i += lineBreak(swapped.constData(), i, units, out, o, result);
+            }
+            else
+            {
+                out[o++] = QChar(unit);
+                ++i;
+            }
+        }
+
+        if (size & 1)
+        {
+            out[o++] = QChar::ReplacementCharacter;
+            ++result.invalidSequences;
+        }
+
+        result.text.resize(o);
+        return result;
+    }
+
+    // UTF-16 never needs more code units than UTF-8 or Latin-1 needs bytes
+    result.text.resize(size);
+    auto out = result.text.data();
+    int o = 0;
+    int i = 0;
+
+    if (encoding == Encoding::Latin1)
+    {
+        while (i < size)
+        {
+            if (bytes[i] == '\r' || bytes[i] == '\n')
+            {
+                i += lineBreak(bytes, i, size, out, o, result);
+            }
+            else
+            {
+                out[o++] = QLatin1Char(static_cast<char>(bytes[i++]));
+            }
+        }
+
+        result.text.resize(o);
+        return result;
+    }
+
+    while (i < size)
+    {
+#ifdef QCODEEDITOR_HAS_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i carriageReturn = _mm_set1_epi8('\r');
+        const __m128i newline = _mm_set1_epi8('\n');
+
+        while (i + 16 <= size)
+        {
+            auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i));
+
+            // Non-ASCII bytes and CRs need the scalar path
+            if (_mm_movemask_epi8(_mm_or_si128(chunk, _mm_cmpeq_epi8(chunk, carriageReturn))) != 0)
+            {
+                break;
+            }
+
+            auto target = reinterpret_cast<__m128i *>(out + o);
+            _mm_storeu_si128(target, _mm_unpacklo_epi8(chunk, zero));
+            _mm_storeu_si128(target + 1, _mm_unpackhi_epi8(chunk, zero));
+
+            auto newlines = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+            result.lf += static_cast<int>(qPopulationCount(newlines));
+
+            i += 16;
+            o += 16;
+        }
+#endif
+
+        // Scalar path for (at least) the next 16 bytes
+        const int stop = qMin(size, i + 16);
+
+        while (i < stop)
+        {
+            auto byte = bytes[i];
+
+            if (byte == '\r' || byte == '\n')
+            {
+                i += lineBreak(bytes, i, size, out, o, result);
+                continue;
+            }
+
+            if (byte < 0x80)
+            {
+                out[o++] = QLatin1Char(static_cast<char>(byte));
+                ++i;
+                continue;
+            }
+
+            uint codePoint;
+            auto length = decodeUtf8Sequence(bytes + i, size - i, codePoint);
+
+            if (length <= 0)
+            {
+                out[o++] = QChar::ReplacementCharacter;
+                ++result.invalidSequences;
+                ++i;
+                continue;
+            }
+
+            if (QChar::requiresSurrogates(codePoint))
+            {
+                out[o++] = QChar(QChar::highSurrogate(codePoint));
+                out[o++] = QChar(QChar::lowSurrogate(codePoint));
+            }
+            else
+            {
+                out[o++] = QChar(static_cast<ushort>(codePoint));
+            }
+
+            i += length;
+        }
+    }
+
+    result.text.resize(o);
+    return result;
+}
+
+QDocumentCodec::LineEnding QDocumentCodec::dominantLineEnding(int lf, int crlf, int cr)
+{
+    if (crlf > lf && crlf >= cr)
+    {
+        return LineEnding::CRLF;
+    }
+
+    if (cr > lf && cr > crlf)
+    {
+        return LineEnding::CR;
+    }
+
+    return LineEnding::LF;
+}
+
+QByteArray QDocumentCodec::encode(const QString &text, Encoding encoding, LineEnding lineEnding)
+{
+    auto normalised = text;
+
+    if (lineEnding == LineEnding::CRLF)
+    {
+        normalised.replace(QLatin1Char('\n'), QLatin1String("\r\n"));
+    }
+    else if (lineEnding == LineEnding::CR)
+    {
+        normalised.replace(QLatin1Char('\n'), QLatin1Char('\r'));
+    }
+
+    switch (encoding)
+    {
+    case Encoding::Utf8:
+        return normalised.toUtf8();
+    case Encoding::Utf8Bom:
+        return QByteArray("\xEF\xBB\xBF") + normalised.toUtf8();
+    case Encoding::Latin1:
+        return normalised.toLatin1();
+    case Encoding::Utf16LE:
+    case Encoding::Utf16BE:
+        break;
+    }
+
+    const bool bigEndian = encoding == Encoding::Utf16BE;
+
+    QByteArray result;
+    result.reserve(2 + normalised.size() * 2);
+    result.append(bigEndian ? "\xFE\xFF" : "\xFF\xFE", 2);
+
+    for (auto ch : qAsConst(normalised))
+    {
+        auto unit = ch.unicode();
+        auto high = static_cast<char>(unit >> 8);
+        auto low = static_cast<char>(unit & 0xFF);
+
+        result.append(bigEndian ? high : low);
+        result.append(bigEndian ? low : high);
+    }
+
+    return result;
+}
@@ -0,0 +1,278 @@
+// QCodeEditor
+#include <QFileLineIndex>
+
+// Qt
+#include <QtAlgorithms>
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QCODEEDITOR_HAS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+// Files smaller than this are scanned on the calling thread only
+constexpr qint64 ParallelScanChunkSize = 16 * 1024 * 1024;
+
+struct ChunkScan
+{
+    qint64 newlines = 0;
+    // Pairs of chunk-local line number and its start offset
+    QVector<QPair<qint64, qint64>> checkpoints;
+};
+
+void scanChunk(const uchar *data, qint64 begin, qint64 end, ChunkScan &result)
+{
+    qint64 count = 0;
+    qint64 next = QFileLineIndex::CheckpointInterval;
+
+    auto record = [&](qint64 newlinePosition) {
+        if (++count == next)
+        {
+            result.checkpoints.append({count, newlinePosition + 1});
+            next += QFileLineIndex::CheckpointInterval;
+        }
+    };
+
+    qint64 i = begin;
+
+#ifdef QCODEEDITOR_HAS_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= end; i += 16)
+    {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        auto mask = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+
+        if (mask == 0)
+            continue;
+
+        // Only walk the bits when a checkpoint falls into these 16 bytes
+        auto bits = static_cast<qint64>(qPopulationCount(mask));
+        if (count + bits < next)
+        {
+            count += bits;
+            continue;
+        }
+
+        while (mask != 0)
+        {
+            record(i + qCountTrailingZeroBits(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // Tail (or the whole chunk without SSE2), memchr is vectorised by the C library
+    while (i < end)
+    {
+        auto found = static_cast<const uchar *>(std::memchr(data + i, '\n', static_cast<size_t>(end - i)));
+        if (found == nullptr)
+            break;
+
+        auto position = found - data;
+        record(position);
+        i = position + 1;
+    }
+
+    result.newlines = count;
+}
+} // namespace
+
+QFileLineIndex::QFileLineIndex() : m_file(), m_data(nullptr), m_size(0), m_lineCount(0), m_checkpoints()
+{
+}
+
+QFileLineIndex::~QFileLineIndex()
+{
+    close();
+}
+
+bool QFileLineIndex::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    m_size = m_file.size();
+
+    if (m_size > 0)
+    {
+        m_data = m_file.map(0, m_size);
+
+        if (m_data == nullptr)
+        {
+            close();
+            return false;
+        }
+    }
+
+    int threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    threadCount = static_cast<int>(qBound<qint64>(1, m_size / ParallelScanChunkSize, qMax(1, threadCount)));
+
+    std::vector<ChunkScan> scans(static_cast<size_t>(threadCount));
+    const qint64 chunkSize = m_size / threadCount;
+
+    if (threadCount == 1)
+    {
+        scanChunk(m_data, 0, m_size, scans[0]);
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<size_t>(threadCount));
+
+        for (int i = 0; i < threadCount; ++i)
+        {
+            qint64 begin = chunkSize * i;
+            qint64 end = i == threadCount - 1 ? m_size : begin + chunkSize;
+            workers.emplace_back(scanChunk, m_data, begin, end, std::ref(scans[static_cast<size_t>(i)]));
+        }
+
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    qint64 checkpointCount = 1;
+    for (auto &scan : scans)
+    {
+        checkpointCount += scan.checkpoints.size();
+    }
+
+    m_checkpoints.reserve(static_cast<int>(checkpointCount));
+    m_checkpoints.append({0, 0});
+
+    qint64 base = 0;
+    for (auto &scan : scans)
+    {
+        for (auto &checkpoint : qAsConst(scan.checkpoints))
+        {
+            m_checkpoints.append({base + checkpoint.first, checkpoint.second});
+        }
+        base += scan.newlines;
+    }
+
+    m_lineCount = base + 1;
+
+    return true;
+}
+
+void QFileLineIndex::close()
+{
+    if (m_data != nullptr)
+    {
+        m_file.unmap(m_data);
+        m_data = nullptr;
+    }
+
+    if (m_file.isOpen())
+    {
+        m_file.close();
+    }
+
+    m_size = 0;
+    m_lineCount = 0;
+    m_checkpoints.clear();
+    m_checkpoints.squeeze();
+}
+
+bool QFileLineIndex::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+qint64 QFileLineIndex::size() const
+{
+    return m_size;
+}
+
+qint64 QFileLineIndex::lineCount() const
+{
+    return m_lineCount;
+}
+
+qint64 QFileLineIndex::lineStart(qint64 line) const
+{
+    if (line < 0 || line >= m_lineCount)
+    {
+        return -1;
+    }
+
+    auto it = std::upper_bound(m_checkpoints.cbegin(), m_checkpoints.cend(), line,
+                               [](qint64 value, const QPair<qint64, qint64> &c) { return value < c.first; });
+    --it;
+
+    qint64 offset = it->second;
+    for (qint64 i = it->first; i < line; ++i)
+    {
+        offset = nextLineStart(offset);
+    }
+
+    return offset;
+}
+
+qint64 QFileLineIndex::nextLineStart(qint64 offset) const
+{
+    if (offset >= m_size)
+    {
+        return m_size + 1;
+    }
+
+    auto found = static_cast<const uchar *>(std::memchr(m_data + offset, '\n', static_cast<size_t>(m_size - offset)));
+
+    return found == nullptr ? m_size + 1 : (found - m_data) + 1;
+}
+
+QString QFileLineIndex::line(qint64 lineNumber, int maxLength) const
+{
+    auto start = lineStart(lineNumber);
+
+    if (start < 0)
+    {
+        return QString();
+    }
+
+    return text(start, nextLineStart(start) - 1, maxLength);
+}
+
+QString QFileLineIndex::text(qint64 from, qint64 to, int maxLength) const
+{
+    to = qMin(to, m_size);
+
+    if (from >= to)
+    {
+        return QString();
+    }
+
+    if (m_data[to - 1] == '\r')
+    {
+        --to;
+    }
+
+    auto length = static_cast<int>(qMin<qint64>(to - from, maxLength));
+
+    return QString::fromUtf8(reinterpret_cast<const char *>(m_data + from), length);
+}
+
+const uchar *QFileLineIndex::data() const
+{
+    return m_data;
+}
+
+qint64 QFileLineIndex::memoryCost() const
+{
+    return static_cast<qint64>(m_checkpoints.capacity()) * static_cast<qint64>(sizeof(QPair<qint64, qint64>));
+}
@@ -0,0 +1,95 @@
+// QCodeEditor
+#include <QFileLoader>
+
+QFileLoader::QFileLoader(const QString &path, QObject *parent)
+    : QObject(parent), m_file(path), m_carry(), m_encodingDetected(false), m_encoding(QDocumentCodec::Encoding::Utf8),
+      m_lf(0), m_crlf(0), m_cr(0), m_invalidSequences(0), m_cancelled(false)
+{
+}
+
+QFileLoader::~QFileLoader() = default;
+
+void QFileLoader::cancel()
+{
+    m_cancelled = true;
+}
+
+bool QFileLoader::isCancelled() const
+{
+    return m_cancelled;
+}
+
+QDocumentCodec::Encoding QFileLoader::encoding() const
+{
+    return m_encoding;
+}
+
+QDocumentCodec::LineEnding QFileLoader::lineEnding() const
+{
+    return QDocumentCodec::dominantLineEnding(m_lf, m_crlf, m_cr);
+}
+
+int QFileLoader::invalidSequences() const
+{
+    return m_invalidSequences;
+}
+
+void QFileLoader::readChunk(int maxBytes)
+{
+    if (m_cancelled)
+    {
+        return;
+    }
+
+    if (!m_file.isOpen() && !m_file.open(QIODevice::ReadOnly))
+    {
+        Q_EMIT finished(false);
+        return;
+    }
+
+    auto bytes = m_carry + m_file.read(maxBytes);
+    auto atEnd = m_file.atEnd();
+
+    if (!m_encodingDetected)
+    {
+        m_encoding = QDocumentCodec::detectEncoding(bytes);
+        m_encodingDetected = true;
+        bytes.remove(0, QDocumentCodec::bomLength(m_encoding));
+    }
+
+    // The carried bytes have no line break, but a CR at their end may be followed by LF
+    auto carried = static_cast<int>(m_carry.size()) - 1;
+    int cut = atEnd ? bytes.size() : QDocumentCodec::lastLineBreak(bytes, m_encoding, carried);
+
+    while (cut == 0 && !atEnd)
+    {
+        if (m_cancelled)
+        {
+            return;
+        }
+
+        // A single line longer than the chunk, keep reading and search only the new bytes
+        auto scanned = static_cast<int>(bytes.size()) - 1;
+        bytes += m_file.read(maxBytes);
+        atEnd = m_file.atEnd();
+
+        cut = atEnd ? bytes.size() : QDocumentCodec::lastLineBreak(bytes, m_encoding, scanned);
+    }
+
+    m_carry = bytes.mid(cut);
+
+    auto result = QDocumentCodec::decode(bytes.constData(), cut, m_encoding);
+
+    m_lf += result.lf;
+    m_crlf += result.crlf;
+    m_cr += result.cr;
+    m_invalidSequences += result.invalidSequences;
+
+    Q_EMIT chunkRead(result.text, m_file.pos() - m_carry.size(), m_file.size());
+
+    if (atEnd)
+    {
+        m_file.close();
+        Q_EMIT finished(true);
+    }
+}
@@ -0,0 +1,562 @@
+// QCodeEditor
+#include <QFindEngine>
+#include <QTrigramIndex>
+
+// Qt
+#include <QRunnable>
+#include <QTextDocument>
+#include <QThreadPool>
+#include <QTimer>
+
+// std
+#include <algorithm>
+
+namespace
+{
+// Characters searched by a worker at once, the chunk is extended to the end of the line
+constexpr int ChunkSize = 256 * 1024;
+
+// Candidate lines of the trigram index searched by a worker at once
+constexpr int ChunkLines = 4096;
+
+// Delay of searching again after the last change, ms
+constexpr int RefreshDelay = 300;
+} // namespace
+
+/**
+ * @brief Class, that describes search of a chunk of the
+ * snapshot in a worker thread.
+ */
+class QFindEngine::Task : public QRunnable
+{
+  public:
+    Task(QFindEngine *engine, std::shared_ptr<Run> run, int index, int start, int end)
+        : QRunnable(), m_engine(engine), m_run(std::move(run)), m_index(index), m_start(start), m_end(end)
+    {
+    }
+
+    void run() override
+    {
+        QVector<Hit> hits;
+
+        if (!m_run->lines.isEmpty())
+        {
+            for (int i = m_start; i < m_end; ++i)
+            {
+                if (!match(m_run->lines[i], m_run->positions[i], hits))
+                {
+                    return;
+                }
+            }
+        }
+        // Chunk starts at a line start, so anchors and word boundaries behave as in the whole text
+        else if (!match(m_run->snapshot.mid(m_start, m_end - m_start), m_start, hits))
+        {
+            return;
+        }
+
+        auto engine = m_engine;
+        auto id = m_run->id;
+        auto index = m_index;
+
+        QMetaObject::invokeMethod(
+            engine, [engine, id, index, hits] { engine->chunkDone(id, index, hits); }, Qt::QueuedConnection);
+    }
+
+  private:
+    /**
+     * @brief Method for appending matches in the text,
+     * which starts at the offset, to the hits.
+     * @return false if the search has been cancelled.
+     */
+    bool match(const QString &text, int offset, QVector<Hit> &hits) const
+    {
+        auto it = m_run->regex.globalMatch(text);
+        while (it.hasNext())
+        {
+            if (m_run->cancelled)
+            {
+                return false;
+            }
+
+            auto match = it.next();
+            if (match.capturedLength() > 0)
+            {
+                hits.append(
+                    Hit(offset + static_cast<int>(match.capturedStart()), static_cast<int>(match.capturedLength())));
+            }
+        }
+
+        return !m_run->cancelled;
+    }
+
+    QFindEngine *m_engine;
+    std::shared_ptr<Run> m_run;
+    int m_index;
+    int m_start;
+    int m_end;
+};
+
+QFindEngine::QFindEngine(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_document(document), m_pool(new QThreadPool(this)), m_refreshTimer(new QTimer(this)),
+      m_trigramIndex(nullptr), m_pattern(), m_options(), m_regex(), m_revision(0), m_changeFilter(document), m_run(),
+      m_nextRunId(0), m_streamed(false), m_pendingChunks(), m_pendingCount(0), m_chunks(), m_count(0)
+{
+    m_refreshTimer->setSingleShot(true);
+    m_refreshTimer->setInterval(RefreshDelay);
+
+    connect(m_refreshTimer, &QTimer::timeout, this, &QFindEngine::refresh);
+    connect(m_document, &QTextDocument::contentsChange, this, &QFindEngine::onContentsChange);
+}
+
+QFindEngine::~QFindEngine()
+{
+    cancel();
+    m_pool->waitForDone();
+}
+
+QRegularExpression QFindEngine::regularExpression(const QString &pattern, const Options &options)
+{
+    auto expression = options.regularExpression ? pattern : QRegularExpression::escape(pattern);
+    if (options.wholeWords)
+    {
+        expression = "\\b(?:" + expression + ")\\b";
+    }
+
+    auto patternOptions = QRegularExpression::MultilineOption | QRegularExpression::UseUnicodePropertiesOption;
+    if (!options.caseSensitive)
+    {
+        patternOptions |= QRegularExpression::CaseInsensitiveOption;
+    }
+
+    return QRegularExpression(expression, patternOptions);
+}
+
+bool QFindEngine::canMatchLineBreak(const QString &pattern, const Options &options)
+{
+    if (!options.regularExpression)
+    {
+        return pattern.contains(QLatin1Char('\n'));
+    }
+
+    // Escapes, negated classes and the dot-all flag, which may stand for a line break
+    static const QRegularExpression lineBreak(
+        R"(\\[nrsSvVRWDHXCxpPc0]|\[\^|\[:(?:\^|space:|cntrl:)|\(\?[a-zA-Z]*s|\n|\r)");
+    return pattern.contains(lineBreak);
+}
+
+bool QFindEngine::start(const QString &pattern, const Options &options)
+{
+    cancel();
+    m_refreshTimer->stop();
+
+    m_pattern = pattern;
+    m_options = options;
+    m_chunks.clear();
+    m_count = 0;
+
+    m_regex = regularExpression(pattern, options);
+
+    if (pattern.isEmpty() || !m_regex.isValid())
+    {
+        m_pattern.clear();
+
+        Q_EMIT hitsReset(m_revision);
+
+        return false;
+    }
+
+    // Compiled once here, instead of by each worker
+    m_regex.optimize();
+
+    Q_EMIT hitsReset(m_revision);
+
+    run(true);
+
+    return true;
+}
+
+void QFindEngine::clear()
+{
+    cancel();
+    m_refreshTimer->stop();
+
+    m_pattern.clear();
+
+    if (!m_chunks.isEmpty())
+    {
+        m_chunks.clear();
+        m_count = 0;
+
+        Q_EMIT hitsReset(m_revision);
+    }
+}
+
+void QFindEngine::setTrigramIndex(QTrigramIndex *index)
+{
+    m_trigramIndex = index;
+}
+
+QTrigramIndex *QFindEngine::trigramIndex() const
+{
+    return m_trigramIndex;
+}
+
+QString QFindEngine::pattern() const
+{
+    return m_pattern;
+}
+
+QFindEngine::Options QFindEngine::options() const
+{
+    return m_options;
+}
+
+int QFindEngine::revision() const
+{
+    return m_revision;
+}
+
+bool QFindEngine::isRunning() const
+{
+    return m_run != nullptr || m_refreshTimer->isActive();
+}
+
+int QFindEngine::count() const
+{
+    return m_count;
+}
+
+QVector<QFindEngine::Hit> QFindEngine::hits() const
+{
+    QVector<Hit> result;
+    result.reserve(m_count);
+
+    for (auto &chunk : m_chunks)
+    {
+        for (auto &hit : chunk.hits)
+        {
+            result.append(Hit(hit.start + chunk.shift, hit.length));
+        }
+    }
+
+    return result;
+}
+
+QVector<QFindEngine::Hit> QFindEngine::hits(int from, int to) const
+{
+    QVector<Hit> result;
+
+    for (auto i = chunkAt(from); i < m_chunks.size(); ++i)
+    {
+        auto &chunk = m_chunks[i];
+        if (chunk.start + chunk.shift > to)
+        {
+            break;
+        }
+
+        auto it = std::lower_bound(chunk.hits.cbegin(), chunk.hits.cend(), from - chunk.shift,
+                                   [](const Hit &hit, int start) { return hit.start < start; });
+
+        for (; it != chunk.hits.cend() && it->start + chunk.shift <= to; ++it)
+        {
+            result.append(Hit(it->start + chunk.shift, it->length));
+        }
+    }
+
+    return result;
+}
+
+QFindEngine::Hit QFindEngine::nextHit(int position, bool backward) const
+{
+    auto comparator = [](const Hit &hit, int start) { return hit.start < start; };
+
+    if (backward)
+    {
+        for (auto i = qMin(chunkAt(position), static_cast<int>(m_chunks.size()) - 1); i >= 0; --i)
+        {
+            auto &chunk = m_chunks[i];
+            auto it = std::lower_bound(chunk.hits.cbegin(), chunk.hits.cend(), position - chunk.shift, comparator);
+
+            if (it != chunk.hits.cbegin())
+            {
+                --it;
+                return Hit(it->start + chunk.shift, it->length);
+            }
+        }
+
+        // Wrap around to the last hit
+        for (auto i = static_cast<int>(m_chunks.size()) - 1; i >= 0; --i)
+        {
+            auto &chunk = m_chunks[i];
+            if (!chunk.hits.isEmpty())
+            {
+                return Hit(chunk.hits.last().start + chunk.shift, chunk.hits.last().length);
+            }
+        }
+
+        return Hit();
+    }
+
+    for (auto i = chunkAt(position); i < m_chunks.size(); ++i)
+    {
+        auto &chunk = m_chunks[i];
+        auto it = std::lower_bound(chunk.hits.cbegin(), chunk.hits.cend(), position - chunk.shift, comparator);
+
+        if (it != chunk.hits.cend())
+        {
+            return Hit(it->start + chunk.shift, it->length);
+        }
+    }
+
+    // Wrap around to the first hit
+    for (auto &chunk : m_chunks)
+    {
+        if (!chunk.hits.isEmpty())
+        {
+            return Hit(chunk.hits.first().start + chunk.shift, chunk.hits.first().length);
+        }
+    }
+
+    return Hit();
+}
+
+void QFindEngine::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    // Format changes (e.g. by the highlighter) are reported this way too
+    if (!m_changeFilter.isTextChange(charsRemoved, charsAdded))
+    {
+        return;
+    }
+
+    ++m_revision;
+
+    if (m_pattern.isEmpty())
+    {
+        return;
+    }
+
+    // Hits of the running search are for the old text
+    cancel();
+
+    auto delta = charsAdded - charsRemoved;
+    auto removedEnd = position + charsRemoved;
+
+    auto map = [&](int offset) { return offset >= removedEnd ? offset + delta : qMin(offset, position + charsAdded); };
+
+    for (auto &chunk : m_chunks)
+    {
+        auto start = chunk.start + chunk.shift;
+        auto end = chunk.end + chunk.shift;
+
+        if (start >= removedEnd)
+        {
+            chunk.shift += delta;
+            continue;
+        }
+
+        if (end < position)
+        {
+            continue;
+        }
+
+        // Hits touching the changed text are dropped, until the text is searched again
+        QVector<Hit> hits;
+        for (auto hit : qAsConst(chunk.hits))
+        {
+            hit.start += chunk.shift;
+
+            if (hit.start + hit.length <= position)
+            {
+                hits.append(hit);
+            }
+            else if (hit.start >= removedEnd)
+            {
+                hit.start += delta;
+                hits.append(hit);
+            }
+        }
+
+        m_count -= static_cast<int>(chunk.hits.size() - hits.size());
+
+        chunk.hits = hits;
+        chunk.start = map(start);
+        chunk.end = map(end);
+        chunk.shift = 0;
+    }
+
+    m_refreshTimer->start();
+}
+
+void QFindEngine::refresh()
+{
+    if (!m_pattern.isEmpty())
+    {
+        run(false);
+    }
+}
+
+void QFindEngine::run(bool streamed)
+{
+    cancel();
+
+    m_run = std::make_shared<Run>(m_nextRunId++, m_regex);
+    m_streamed = streamed;
+    m_pendingCount = 0;
+
+    QVector<Chunk> chunks;
+
+    // Offsets of the snapshot or indices of the lines searched by each worker
+    QVector<QPair<int, int>> ranges;
+
+    auto literal = m_options.regularExpression ? QTrigramIndex::requiredLiteral(m_pattern) : m_pattern;
+    auto multiLine = canMatchLineBreak(m_pattern, m_options);
+
+    // Candidate lines are searched one by one, so matches spanning lines need the whole text
+    if (m_trigramIndex && m_trigramIndex->isReady() && literal.size() >= 3 && !multiLine)
+    {
+        // Only the lines, which may match, are copied and searched
+        for (auto &block : m_trigramIndex->candidates(literal))
+        {
+            m_run->positions.append(block.position());
+            m_run->lines.append(block.text());
+        }
+
+        const auto &lines = m_run->lines;
+        for (int first = 0; first < lines.size(); first += ChunkLines)
+        {
+            auto last = qMin(first + ChunkLines, static_cast<int>(lines.size())) - 1;
+            auto end = m_run->positions[last] + static_cast<int>(lines[last].size()) + 1;
+
+            // Chunks may leave gaps, lines between them can't match
+            chunks.append(Chunk(m_run->positions[first], end));
+            ranges.append({first, last + 1});
+        }
+    }
+    else
+    {
+        m_run->snapshot = m_document->toPlainText();
+
+        // Chunks end at line ends, so only matches spanning lines may cross them
+        auto chunkSize = multiLine ? static_cast<int>(m_run->snapshot.size()) : ChunkSize;
+
+        const auto &snapshot = m_run->snapshot;
+        for (int start = 0; start < snapshot.size();)
+        {
+            int end = start + chunkSize;
+            if (end >= snapshot.size())
+            {
+                end = static_cast<int>(snapshot.size());
+            }
+            else
+            {
+                auto lineEnd = snapshot.indexOf('\n', end);
+                end = lineEnd < 0 ? static_cast<int>(snapshot.size()) : static_cast<int>(lineEnd) + 1;
+            }
+
+            chunks.append(Chunk(start, end));
+            ranges.append({start, end});
+            start = end;
+        }
+    }
+
+    if (chunks.isEmpty())
+    {
+        m_run.reset();
+        m_chunks.clear();
+        m_count = 0;
+
+        if (!streamed)
+        {
+            Q_EMIT hitsReset(m_revision);
+        }
+
+        Q_EMIT finished(m_revision, 0);
+        return;
+    }
+
+    // Streamed hits are shown right away, the others replace the shown ones when all are found
+    if (streamed)
+    {
+        m_chunks = chunks;
+        m_count = 0;
+    }
+    else
+    {
+        m_pendingChunks = chunks;
+    }
+
+    for (int i = 0; i < chunks.size(); ++i)
+    {
+        m_pool->start(new Task(this, m_run, i, ranges[i].first, ranges[i].second));
+    }
+}
+
+void QFindEngine::cancel()
+{
+    if (m_run)
+    {
+        m_run->cancelled = true;
+        m_run.reset();
+    }
+
+    // Workers, which haven't started yet, are dropped
+    m_pool->clear();
+
+    m_pendingChunks.clear();
+}
+
+void QFindEngine::chunkDone(int runId, int index, const QVector<Hit> &hits)
+{
+    // Hits of a cancelled search
+    if (!m_run || m_run->id != runId)
+    {
+        return;
+    }
+
+    auto &chunks = m_streamed ? m_chunks : m_pendingChunks;
+    chunks[index].hits = hits;
+
+    ++m_pendingCount;
+
+    if (m_streamed)
+    {
+        m_count += static_cast<int>(hits.size());
+
+        if (!hits.isEmpty())
+        {
+            Q_EMIT hitsAdded(m_revision, hits);
+        }
+    }
+
+    if (m_pendingCount < chunks.size())
+    {
+        return;
+    }
+
+    m_run.reset();
+
+    if (!m_streamed)
+    {
+        m_chunks = m_pendingChunks;
+        m_pendingChunks.clear();
+
+        m_count = 0;
+        for (auto &chunk : qAsConst(m_chunks))
+        {
+            m_count += static_cast<int>(chunk.hits.size());
+        }
+
+        Q_EMIT hitsReset(m_revision);
+    }
+
+    Q_EMIT finished(m_revision, m_count);
+}
+
+int QFindEngine::chunkAt(int offset) const
+{
+    auto it = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), offset,
+                               [](int value, const Chunk &chunk) { return value < chunk.end + chunk.shift; });
+
+    return static_cast<int>(it - m_chunks.cbegin());
+}
@@ -0,0 +1,66 @@
+// QCodeEditor
+#include <QCodeEditor>
+#include <QFoldColumn>
+#include <QFoldingManager>
+#include <QSyntaxStyle>
+
+// Qt
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPolygonF>
+#include <QTextBlock>
+
+QFoldColumn::QFoldColumn(QCodeEditor *editor) : QGutterColumn("Folding", editor)
+{
+    connect(editor->folding(), &QFoldingManager::foldingChanged, this, &QGutterColumn::updateRequest);
+}
+
+int QFoldColumn::computeWidth() const
+{
+    return editor()->fontMetrics().height();
+}
+
+void QFoldColumn::paintRow(QPainter &painter, const QRect &rect, const QTextBlock &block, int)
+{
+    auto folding = editor()->folding();
+
+    auto folded = folding->isFolded(block);
+    if (!folded && !folding->isFoldable(block))
+    {
+        return;
+    }
+
+    // Triangle pointing right when folded, down otherwise
+    auto size = rect.width() / 3.0;
+    auto center = QRectF(rect).center();
+
+    QPolygonF triangle;
+    if (folded)
+    {
+        triangle << QPointF(center.x() - size / 2, center.y() - size) << QPointF(center.x() + size / 2, center.y())
+                 << QPointF(center.x() - size / 2, center.y() + size);
+    }
+    else
+    {
+        triangle << QPointF(center.x() - size, center.y() - size / 2)
+                 << QPointF(center.x() + size, center.y() - size / 2) << QPointF(center.x(), center.y() + size / 2);
+    }
+
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(editor()->syntaxStyle()->getFormat("LineNumber").foreground().color());
+    painter.drawPolygon(triangle);
+    painter.setRenderHint(QPainter::Antialiasing, false);
+}
+
+bool QFoldColumn::mousePressed(const QTextBlock &block, QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || !block.isValid())
+    {
+        return false;
+    }
+
+    editor()->folding()->toggleFold(block);
+
+    return true;
+}
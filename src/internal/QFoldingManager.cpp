@@ -0,0 +1,240 @@
+// QCodeEditor
+#include <QCodeBlockData>
+#include <QFoldingManager>
+#include <QScopeTree>
+
+// Qt
+#include <QAbstractTextDocumentLayout>
+#include <QTextDocument>
+
+namespace
+{
+// Gives access to the protected method, which relays out a range of the document
+class LayoutAccess : public QAbstractTextDocumentLayout
+{
+  public:
+    static void relayout(QAbstractTextDocumentLayout *layout, int position, int length)
+    {
+        (layout->*(&LayoutAccess::documentChanged))(position, length, length);
+    }
+};
+} // namespace
+
+QFoldingManager::QFoldingManager(QTextDocument *document, QScopeTree *scopes, QObject *parent)
+    : QObject(parent), m_document(document), m_scopes(scopes)
+{
+    connect(m_document, &QTextDocument::contentsChange, this, &QFoldingManager::onContentsChange);
+}
+
+bool QFoldingManager::isFoldable(const QTextBlock &block) const
+{
+    return regionEnd(block).isValid();
+}
+
+QTextBlock QFoldingManager::regionEnd(const QTextBlock &block) const
+{
+    return m_scopes->scopeEnd(block);
+}
+
+bool QFoldingManager::isFolded(const QTextBlock &block) const
+{
+    auto data = QCodeBlockData::get(block);
+
+    return data && data->folded;
+}
+
+void QFoldingManager::setFolded(const QTextBlock &block, bool folded)
+{
+    auto data = QCodeBlockData::get(block, folded);
+
+    if (data)
+    {
+        data->folded = folded;
+    }
+}
+
+void QFoldingManager::fold(const QTextBlock &block)
+{
+    if (!block.isValid() || isFolded(block) || !regionEnd(block).isValid())
+    {
+        return;
+    }
+
+    setFolded(block, true);
+    applyFolds(block, block.blockNumber());
+}
+
+void QFoldingManager::unfold(const QTextBlock &block)
+{
+    if (!block.isValid() || !isFolded(block))
+    {
+        return;
+    }
+
+    setFolded(block, false);
+    applyFolds(block, block.blockNumber());
+}
+
+void QFoldingManager::toggleFold(const QTextBlock &block)
+{
+    if (isFolded(block))
+    {
+        unfold(block);
+    }
+    else
+    {
+        fold(block);
+    }
+}
+
+void QFoldingManager::foldAll()
+{
+    if (m_scopes->mode() == QStyleSyntaxHighlighter::FoldingMode::None)
+    {
+        return;
+    }
+
+    for (auto block = m_document->firstBlock(); block.isValid(); block = block.next())
+    {
+        if (isFoldable(block))
+        {
+            setFolded(block, true);
+        }
+    }
+
+    applyFolds(m_document->firstBlock(), m_document->blockCount() - 1);
+}
+
+void QFoldingManager::unfoldAll()
+{
+    QTextBlock first;
+    QTextBlock last;
+
+    for (auto block = m_document->firstBlock(); block.isValid(); block = block.next())
+    {
+        setFolded(block, false);
+
+        if (!block.isVisible())
+        {
+            block.setVisible(true);
+
+            if (!first.isValid())
+            {
+                first = block;
+            }
+            last = block;
+        }
+    }
+
+    if (first.isValid())
+    {
+        relayout(first, last);
+
+        Q_EMIT foldingChanged();
+    }
+}
+
+void QFoldingManager::reveal(const QTextBlock &block)
+{
+    while (block.isValid() && !block.isVisible())
+    {
+        // Visible block above is the header of the outermost folded region
+        auto header = block.previous();
+        while (header.isValid() && !header.isVisible())
+        {
+            header = header.previous();
+        }
+
+        if (!header.isValid() || !isFolded(header))
+        {
+            // Hidden by a region, that isn't there anymore
+            applyFolds(block, block.blockNumber());
+            break;
+        }
+
+        unfold(header);
+    }
+}
+
+void QFoldingManager::onContentsChange(int position, int, int charsAdded)
+{
+    auto first = m_document->findBlock(position);
+    auto last = m_document->findBlock(position + charsAdded);
+
+    applyFolds(first, last.isValid() ? last.blockNumber() : m_document->blockCount() - 1);
+}
+
+void QFoldingManager::applyFolds(QTextBlock block, int lastBlockNumber)
+{
+    // Start at a block outside of the folded regions
+    while (block.isValid() && !block.isVisible())
+    {
+        block = block.previous();
+    }
+
+    if (!block.isValid())
+    {
+        block = m_document->firstBlock();
+    }
+
+    auto blockNumber = block.blockNumber();
+    auto hiddenUntil = -1;
+
+    QTextBlock first;
+    QTextBlock last;
+
+    for (; block.isValid(); block = block.next(), ++blockNumber)
+    {
+        auto visible = blockNumber > hiddenUntil;
+
+        // Past the change, everything further is already up to date
+        if (blockNumber > lastBlockNumber && visible && block.isVisible())
+        {
+            break;
+        }
+
+        if (block.isVisible() != visible)
+        {
+            block.setVisible(visible);
+
+            if (!first.isValid())
+            {
+                first = block;
+            }
+            last = block;
+        }
+
+        if (visible && isFolded(block))
+        {
+            auto end = regionEnd(block);
+
+            if (end.isValid())
+            {
+                hiddenUntil = end.blockNumber();
+            }
+            else
+            {
+                // The region is gone
+                setFolded(block, false);
+            }
+        }
+    }
+
+    if (first.isValid())
+    {
+        relayout(first, last);
+
+        Q_EMIT foldingChanged();
+    }
+}
+
+void QFoldingManager::relayout(const QTextBlock &first, const QTextBlock &last)
+{
+    auto layout = m_document->documentLayout();
+    if (!layout)
+    {
+        return;
+    }
+
+    LayoutAccess::relayout(layout, first.position(), last.position() + last.length() - first.position());
+}
@@ -0,0 +1,262 @@
+// QCodeEditor
+#include <QFuzzyCompleter>
+
+// Qt
+#include <QListView>
+#include <QStringListModel>
+#include <QVarLengthArray>
+
+// std
+#include <algorithm>
+
+namespace
+{
+// Score of a matched character and the bonuses on top of it
+constexpr int MatchScore = 16;
+constexpr int WordStartBonus = 24;
+constexpr int ConsecutiveBonus = 16;
+constexpr int CaseBonus = 2;
+
+// Skipped characters cost a point each, up to this many per gap
+constexpr int MaxGapPenalty = 12;
+
+constexpr int DefaultMaxResults = 100;
+} // namespace
+
+QFuzzyCompleter::QFuzzyCompleter(QObject *parent)
+    : QCompleter(parent), m_candidates(), m_wordStarts(), m_pattern(), m_matches(), m_maxResults(DefaultMaxResults),
+      m_model(new QStringListModel(this))
+{
+    setModel(m_model);
+    setCompletionColumn(0);
+
+    // Rows are ranked here, the popup shows them as they are
+    setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    setModelSorting(QCompleter::UnsortedModel);
+    setWrapAround(true);
+
+    // Rows have the same height, so the popup doesn't measure each of them
+    auto view = qobject_cast<QListView *>(popup());
+    if (view)
+    {
+        view->setUniformItemSizes(true);
+        view->setLayoutMode(QListView::Batched);
+    }
+}
+
+int QFuzzyCompleter::score(const QString &pattern, const QString &candidate)
+{
+    auto patternSize = static_cast<int>(pattern.size());
+    auto candidateSize = static_cast<int>(candidate.size());
+
+    if (patternSize == 0)
+    {
+        return 0;
+    }
+
+    if (patternSize > candidateSize)
+    {
+        return -1;
+    }
+
+    // Last index each character can match at, so the rest of the pattern still fits after it
+    QVarLengthArray<int, 64> last(patternSize);
+
+    auto index = candidateSize - 1;
+    for (auto i = patternSize - 1; i >= 0; --i)
+    {
+        auto c = pattern[i].toCaseFolded();
+        while (index >= 0 && candidate[index].toCaseFolded() != c)
+        {
+            --index;
+        }
+
+        if (index < 0)
+        {
+            return -1;
+        }
+
+        last[i] = index--;
+    }
+
+    int result = 0;
+    int previous = -1;
+
+    for (int i = 0; i < patternSize; ++i)
+    {
+        auto c = pattern[i].toCaseFolded();
+        auto from = previous + 1;
+        auto match = -1;
+
+        // A consecutive match is kept, otherwise the next word starting with the character is preferred
+        if (i > 0 && candidate[from].toCaseFolded() == c)
+        {
+            match = from;
+        }
+        else
+        {
+            for (auto k = from; k <= last[i]; ++k)
+            {
+                if (candidate[k].toCaseFolded() == c && isWordStart(candidate, k))
+                {
+                    match = k;
+                    break;
+                }
+            }
+        }
+
+        if (match < 0)
+        {
+            // The pattern has to start at a word
+            if (i == 0)
+            {
+                return -1;
+            }
+
+            match = from;
+            while (candidate[match].toCaseFolded() != c)
+            {
+                ++match;
+            }
+        }
+
+        result += MatchScore;
+
+        if (isWordStart(candidate, match))
+        {
+            result += WordStartBonus;
+        }
+
+        if (i > 0 && match == from)
+        {
+            result += ConsecutiveBonus;
+        }
+
+        if (candidate[match] == pattern[i])
+        {
+            result += CaseBonus;
+        }
+
+        result -= qMin(match - from, MaxGapPenalty);
+        previous = match;
+    }
+
+    // Shorter candidates are closer to the pattern
+    return result - qMin(candidateSize - patternSize, MaxGapPenalty);
+}
+
+void QFuzzyCompleter::setCandidates(const QStringList &candidates)
+{
+    m_candidates = candidates;
+
+    std::sort(m_candidates.begin(), m_candidates.end(), [](const QString &a, const QString &b) {
+        auto result = a.compare(b, Qt::CaseInsensitive);
+        return result != 0 ? result < 0 : a < b;
+    });
+    m_candidates.erase(std::unique(m_candidates.begin(), m_candidates.end()), m_candidates.end());
+
+    m_wordStarts.clear();
+
+    for (int i = 0; i < m_candidates.size(); ++i)
+    {
+        auto &candidate = m_candidates[i];
+
+        for (int k = 0; k < candidate.size(); ++k)
+        {
+            if (!isWordStart(candidate, k))
+            {
+                continue;
+            }
+
+            // A candidate is listed once per letter
+            auto &bucket = m_wordStarts[candidate[k].toCaseFolded()];
+            if (bucket.isEmpty() || bucket.last() != i)
+            {
+                bucket.append(i);
+            }
+        }
+    }
+
+    m_pattern.clear();
+    m_matches.clear();
+    m_model->setStringList({});
+}
+
+QStringList QFuzzyCompleter::candidates() const
+{
+    return m_candidates;
+}
+
+void QFuzzyCompleter::setMaxResults(int count)
+{
+    m_maxResults = qMax(count, 1);
+}
+
+int QFuzzyCompleter::maxResults() const
+{
+    return m_maxResults;
+}
+
+void QFuzzyCompleter::filter(const QString &prefix)
+{
+    QStringList results;
+
+    if (prefix.isEmpty())
+    {
+        m_pattern.clear();
+        m_matches.clear();
+
+        results = m_candidates.mid(0, m_maxResults);
+    }
+    else
+    {
+        // Candidates not matching a shorter pattern can't match a longer one
+        auto incremental = !m_pattern.isEmpty() && prefix.startsWith(m_pattern, Qt::CaseInsensitive);
+        auto pool = incremental ? m_matches : m_wordStarts.value(prefix[0].toCaseFolded());
+
+        QVector<int> matches;
+        QVector<QPair<int, int>> ranked;
+
+        for (auto index : qAsConst(pool))
+        {
+            auto value = score(prefix, m_candidates[index]);
+            if (value >= 0)
+            {
+                matches.append(index);
+                ranked.append({value, index});
+            }
+        }
+
+        m_pattern = prefix;
+        m_matches = matches;
+
+        // Only the shown rows are sorted, ties keep the alphabetical order
+        auto count = qMin(static_cast<int>(ranked.size()), m_maxResults);
+        std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(),
+                          [](const QPair<int, int> &a, const QPair<int, int> &b) {
+                              return a.first != b.first ? a.first > b.first : a.second < b.second;
+                          });
+
+        results.reserve(count);
+        for (int i = 0; i < count; ++i)
+        {
+            results.append(m_candidates[ranked[i].second]);
+        }
+    }
+
+    m_model->setStringList(results);
+    setCompletionPrefix(prefix);
+}
+
+bool QFuzzyCompleter::isWordStart(const QString &text, int index)
+{
+    if (index == 0)
+    {
+        return true;
+    }
+
+    auto previous = text[index - 1];
+    auto current = text[index];
+
+    return !previous.isLetterOrNumber() || (previous.isLower() && current.isUpper());
+}
@@ -4,9 +4,8 @@
 
 // Qt
 #include <QFile>
-#include <QStringListModel>
 
-QGLSLCompleter::QGLSLCompleter(QObject *parent) : QCompleter(parent)
+QGLSLCompleter::QGLSLCompleter(QObject *parent) : QFuzzyCompleter(parent)
 {
     // Setting up GLSL types
     QStringList list;
@@ -33,9 +32,5 @@ QGLSLCompleter::QGLSLCompleter(QObject *parent) : QCompleter(parent)
         list.append(names);
     }
 
-    setModel(new QStringListModel(list, this));
-    setCompletionColumn(0);
-    setModelSorting(QCompleter::CaseInsensitivelySortedModel);
-    setCaseSensitivity(Qt::CaseSensitive);
-    setWrapAround(true);
+    setCandidates(list);
 }
@@ -0,0 +1,31 @@
+// QCodeEditor
+#include <QCodeEditor>
+#include <QGutterColumn>
+
+QGutterColumn::QGutterColumn(const QString &name, QCodeEditor *editor)
+    : QObject(editor), m_name(name), m_editor(editor)
+{
+}
+
+QString QGutterColumn::name() const
+{
+    return m_name;
+}
+
+QCodeEditor *QGutterColumn::editor() const
+{
+    return m_editor;
+}
+
+void QGutterColumn::beginPaint(const QTextBlock &, const QTextBlock &)
+{
+}
+
+bool QGutterColumn::mousePressed(const QTextBlock &, QMouseEvent *)
+{
+    return false;
+}
+
+void QGutterColumn::styleChanged()
+{
+}
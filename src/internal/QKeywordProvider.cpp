@@ -0,0 +1,58 @@
+// QCodeEditor
+#include <QFuzzyCompleter>
+#include <QKeywordProvider>
+#include <QLanguage>
+
+namespace
+{
+// Words matched between checks of cancellation
+constexpr int CancelCheckInterval = 256;
+} // namespace
+
+QKeywordProvider::QKeywordProvider(const QStringList &keywords, QObject *parent)
+    : QCompletionProvider(parent), m_keywords(keywords)
+{
+    m_keywords.removeDuplicates();
+}
+
+QKeywordProvider::QKeywordProvider(QLanguage *language, QObject *parent)
+    : QCompletionProvider(parent), m_keywords()
+{
+    if (language == nullptr)
+    {
+        return;
+    }
+
+    auto keys = language->keys();
+    for (auto &&key : keys)
+    {
+        m_keywords.append(language->names(key));
+    }
+
+    m_keywords.removeDuplicates();
+}
+
+QStringList QKeywordProvider::keywords() const
+{
+    return m_keywords;
+}
+
+QStringList QKeywordProvider::complete(const Request &request)
+{
+    QStringList result;
+
+    for (int i = 0; i < m_keywords.size(); ++i)
+    {
+        if (i % CancelCheckInterval == 0 && request.isCancelled())
+        {
+            return {};
+        }
+
+        if (QFuzzyCompleter::score(request.prefix, m_keywords[i]) >= 0)
+        {
+            result.append(m_keywords[i]);
+        }
+    }
+
+    return result;
+}
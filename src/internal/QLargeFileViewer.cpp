@@ -0,0 +1,465 @@
+// QCodeEditor
+#include <QLargeFileViewer>
+#include <QStyleSyntaxHighlighter>
+#include <QSyntaxStyle>
+
+// Qt
+#include <QElapsedTimer>
+#include <QFontDatabase>
+#include <QKeyEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTimer>
+#include <QtMath>
+
+// std
+#include <limits>
+
+namespace
+{
+// Lines highlighted synchronously to reach the viewport from the last known checkpoint
+constexpr qint64 MaxSynchronousLines = 8 * QLargeFileViewer::StateCheckpointInterval;
+
+// Time budget of one background checkpoint pass, in milliseconds
+constexpr qint64 CheckpointTimeBudget = 10;
+} // namespace
+
+QLargeFileViewer::QLargeFileViewer(QWidget *widget)
+    : QAbstractScrollArea(widget), m_index(), m_highlighter(nullptr), m_syntaxStyle(nullptr),
+      m_highlightDocument(new QTextDocument(this)), m_stateCheckpoints({-1}), m_checkpointTarget(0),
+      m_checkpointTimer(new QTimer(this)), m_windowFirst(-1), m_windowExact(false), m_windowLines(),
+      m_windowFormats(), m_maxLineWidth(0)
+{
+    auto fnt = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+    fnt.setFixedPitch(true);
+    fnt.setPointSize(10);
+    setFont(fnt);
+
+    m_highlightDocument->setUndoRedoEnabled(false);
+
+    m_checkpointTimer->setInterval(0);
+    connect(m_checkpointTimer, &QTimer::timeout, this, &QLargeFileViewer::advanceStateCheckpoints);
+
+    setSyntaxStyle(QSyntaxStyle::defaultStyle());
+}
+
+bool QLargeFileViewer::openFile(const QString &path)
+{
+    closeFile();
+
+    bool opened = m_index.open(path);
+
+    updateScrollBars();
+    viewport()->update();
+
+    return opened;
+}
+
+void QLargeFileViewer::closeFile()
+{
+    m_index.close();
+    m_maxLineWidth = 0;
+    invalidateHighlighting();
+
+    verticalScrollBar()->setValue(0);
+    horizontalScrollBar()->setValue(0);
+    updateScrollBars();
+    viewport()->update();
+}
+
+const QFileLineIndex &QLargeFileViewer::lineIndex() const
+{
+    return m_index;
+}
+
+void QLargeFileViewer::setHighlighter(QStyleSyntaxHighlighter *highlighter)
+{
+    if (m_highlighter)
+    {
+        m_highlighter->setDocument(nullptr);
+    }
+
+    m_highlighter = highlighter;
+
+    if (m_highlighter)
+    {
+        // Attaching to an empty document doesn't schedule a full rehighlight
+        m_highlightDocument->clear();
+        m_highlighter->setSyntaxStyle(m_syntaxStyle);
+        m_highlighter->setDocument(m_highlightDocument);
+    }
+
+    invalidateHighlighting();
+    viewport()->update();
+}
+
+void QLargeFileViewer::setSyntaxStyle(QSyntaxStyle *style)
+{
+    m_syntaxStyle = style;
+
+    if (m_highlighter)
+    {
+        m_highlighter->setSyntaxStyle(m_syntaxStyle);
+    }
+
+    invalidateHighlighting();
+    viewport()->update();
+}
+
+qint64 QLargeFileViewer::firstVisibleLine() const
+{
+    return verticalScrollBar()->value();
+}
+
+void QLargeFileViewer::scrollToLine(qint64 line)
+{
+    verticalScrollBar()->setValue(static_cast<int>(qBound<qint64>(0, line, verticalScrollBar()->maximum())));
+}
+
+void QLargeFileViewer::resizeEvent(QResizeEvent *e)
+{
+    QAbstractScrollArea::resizeEvent(e);
+
+    updateScrollBars();
+}
+
+void QLargeFileViewer::changeEvent(QEvent *e)
+{
+    QAbstractScrollArea::changeEvent(e);
+
+    if (e->type() == QEvent::FontChange)
+    {
+        m_maxLineWidth = 0;
+        updateScrollBars();
+        viewport()->update();
+    }
+}
+
+void QLargeFileViewer::keyPressEvent(QKeyEvent *e)
+{
+    if (e->modifiers() == Qt::ControlModifier && e->key() == Qt::Key_Home)
+    {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMinimum);
+    }
+    else if (e->modifiers() == Qt::ControlModifier && e->key() == Qt::Key_End)
+    {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderToMaximum);
+    }
+    else if (e->key() == Qt::Key_Home)
+    {
+        horizontalScrollBar()->triggerAction(QAbstractSlider::SliderToMinimum);
+    }
+    else
+    {
+        QAbstractScrollArea::keyPressEvent(e);
+    }
+}
+
+void QLargeFileViewer::updateScrollBars()
+{
+    auto visible = qMax(1, viewport()->height() / fontMetrics().lineSpacing());
+    auto maximum = qBound<qint64>(0, m_index.lineCount() - visible, std::numeric_limits<int>::max());
+
+    verticalScrollBar()->setRange(0, static_cast<int>(maximum));
+    verticalScrollBar()->setPageStep(visible);
+    verticalScrollBar()->setSingleStep(1);
+
+    auto textWidth = viewport()->width() - gutterWidth();
+
+    horizontalScrollBar()->setRange(0, qMax(0, m_maxLineWidth - textWidth));
+    horizontalScrollBar()->setPageStep(qMax(1, textWidth));
+#if QT_VERSION >= 0x050B00
+    horizontalScrollBar()->setSingleStep(fontMetrics().horizontalAdvance(QLatin1Char(' ')));
+#else
+    horizontalScrollBar()->setSingleStep(fontMetrics().width(QLatin1Char(' ')));
+#endif
+}
+
+int QLargeFileViewer::visibleLineCount() const
+{
+    return viewport()->height() / fontMetrics().lineSpacing() + 1;
+}
+
+int QLargeFileViewer::gutterWidth() const
+{
+    const int digits = QString::number(qMax<qint64>(1, m_index.lineCount())).length();
+
+#if QT_VERSION >= 0x050B00
+    return 15 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
+#else
+    return 15 + fontMetrics().width(QLatin1Char('9')) * digits;
+#endif
+}
+
+void QLargeFileViewer::invalidateHighlighting()
+{
+    m_checkpointTimer->stop();
+    m_stateCheckpoints = {-1};
+    m_checkpointTarget = 0;
+
+    m_windowFirst = -1;
+    m_windowExact = false;
+    m_windowLines.clear();
+    m_windowFormats.clear();
+}
+
+void QLargeFileViewer::ensureWindow(qint64 first, int count)
+{
+    auto lineCount = m_index.lineCount();
+    auto last = qMin(first + count, lineCount);
+
+    if (m_windowFirst >= 0 && first >= m_windowFirst && last <= m_windowFirst + m_windowLines.size())
+    {
+        return;
+    }
+
+    // Decode a screen above and below as well, so small scrolls reuse the window
+    auto windowFirst = qMax<qint64>(0, first - count);
+    auto windowLast = qMin(lineCount, last + count);
+
+    auto start = windowFirst;
+    auto state = -1;
+    auto exact = m_highlighter == nullptr;
+
+    if (m_highlighter)
+    {
+        auto checkpoint = windowFirst / StateCheckpointInterval;
+
+        if (checkpoint < m_stateCheckpoints.size())
+        {
+            start = checkpoint * StateCheckpointInterval;
+            state = m_stateCheckpoints[static_cast<int>(checkpoint)];
+            exact = true;
+        }
+        else
+        {
+            // The background pass hasn't reached this place yet
+            m_checkpointTarget = qMax(m_checkpointTarget, checkpoint);
+            m_checkpointTimer->start();
+
+            auto known = static_cast<qint64>(m_stateCheckpoints.size() - 1);
+            if (windowFirst - known * StateCheckpointInterval <= MaxSynchronousLines)
+            {
+                start = known * StateCheckpointInterval;
+                state = m_stateCheckpoints.last();
+                exact = true;
+            }
+        }
+    }
+
+    QStringList lines;
+    lines.reserve(static_cast<int>(windowLast - start));
+
+    auto offset = m_index.lineStart(start);
+    for (auto i = start; i < windowLast; ++i)
+    {
+        auto next = m_index.nextLineStart(offset);
+        lines.append(m_index.text(offset, next - 1));
+        offset = next;
+    }
+
+    auto skip = static_cast<int>(windowFirst - start);
+
+    m_windowFormats.clear();
+
+    if (m_highlighter)
+    {
+        QVector<QVector<QTextLayout::FormatRange>> formats;
+        auto states = highlightLines(lines, state, &formats);
+
+        if (exact)
+        {
+            for (int i = 0; i < states.size(); ++i)
+            {
+                auto next = start + i + 1;
+                if (next % StateCheckpointInterval == 0 && next / StateCheckpointInterval == m_stateCheckpoints.size())
+                {
+                    m_stateCheckpoints.append(states[i]);
+                }
+            }
+        }
+
+        m_windowFormats = formats.mid(skip);
+    }
+
+    m_windowLines = lines.mid(skip);
+    m_windowFirst = windowFirst;
+    m_windowExact = exact;
+}
+
+QVector<int> QLargeFileViewer::highlightLines(const QStringList &lines, int previousState,
+                                              QVector<QVector<QTextLayout::FormatRange>> *formats)
+{
+    QVector<int> states;
+
+    if (lines.isEmpty())
+    {
+        return states;
+    }
+
+    // The first block only carries the state of the line before `lines`
+    m_highlightDocument->clear();
+    QTextCursor cursor(m_highlightDocument);
+    cursor.insertText(QStringLiteral("\n"));
+    m_highlightDocument->firstBlock().setUserState(previousState);
+
+    auto text = lines.join('\n');
+    if (text.isEmpty())
+    {
+        m_highlighter->rehighlightBlock(m_highlightDocument->lastBlock());
+    }
+    else
+    {
+        cursor.insertText(text);
+    }
+
+    states.reserve(lines.size());
+    if (formats)
+    {
+        formats->reserve(lines.size());
+    }
+
+    for (auto block = m_highlightDocument->firstBlock().next(); block.isValid(); block = block.next())
+    {
+        states.append(block.userState());
+
+        if (formats)
+        {
+            formats->append(block.layout()->formats());
+        }
+    }
+
+    m_highlightDocument->clear();
+
+    return states;
+}
+
+void QLargeFileViewer::advanceStateCheckpoints()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (m_highlighter && m_stateCheckpoints.size() <= m_checkpointTarget && !timer.hasExpired(CheckpointTimeBudget))
+    {
+        auto start = static_cast<qint64>(m_stateCheckpoints.size() - 1) * StateCheckpointInterval;
+        auto end = start + StateCheckpointInterval;
+
+        if (end > m_index.lineCount())
+        {
+            m_checkpointTarget = m_stateCheckpoints.size() - 1;
+            break;
+        }
+
+        QStringList lines;
+        lines.reserve(StateCheckpointInterval);
+
+        auto offset = m_index.lineStart(start);
+        for (auto i = start; i < end; ++i)
+        {
+            auto next = m_index.nextLineStart(offset);
+            lines.append(m_index.text(offset, next - 1));
+            offset = next;
+        }
+
+        m_stateCheckpoints.append(highlightLines(lines, m_stateCheckpoints.last(), nullptr).last());
+    }
+
+    if (!m_highlighter || m_stateCheckpoints.size() > m_checkpointTarget)
+    {
+        m_checkpointTimer->stop();
+
+        if (!m_windowExact)
+        {
+            m_windowFirst = -1;
+            viewport()->update();
+        }
+    }
+}
+
+void QLargeFileViewer::paintEvent(QPaintEvent *e)
+{
+    QPainter painter(viewport());
+
+    auto background = m_syntaxStyle->getFormat("Text").background().color();
+    painter.fillRect(e->rect(), background);
+
+    if (!m_index.isOpen())
+    {
+        return;
+    }
+
+    auto lineHeight = fontMetrics().lineSpacing();
+    auto first = firstVisibleLine();
+    auto count = visibleLineCount();
+    auto gutter = gutterWidth();
+
+    ensureWindow(first, count);
+
+    QTextOption option;
+    option.setWrapMode(QTextOption::NoWrap);
+#if QT_VERSION >= 0x050B00
+    option.setTabStopDistance(fontMetrics().horizontalAdvance(QString(4, ' ')));
+#elif QT_VERSION == 0x050A00
+    option.setTabStopDistance(fontMetrics().width(QString(4, ' ')));
+#else
+    option.setTabStop(fontMetrics().width(QString(4, ' ')));
+#endif
+
+    auto textLeft = gutter + 4 - horizontalScrollBar()->value();
+    auto widest = 0;
+
+    painter.save();
+    painter.setClipRect(QRect(gutter, 0, viewport()->width() - gutter, viewport()->height()));
+    painter.setPen(m_syntaxStyle->getFormat("Text").foreground().color());
+    painter.setFont(font());
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto index = static_cast<int>(first + i - m_windowFirst);
+        if (index >= m_windowLines.size())
+        {
+            break;
+        }
+
+        QTextLayout layout(m_windowLines[index], font());
+        layout.setTextOption(option);
+        if (index < m_windowFormats.size())
+        {
+            layout.setFormats(m_windowFormats[index]);
+        }
+
+        layout.beginLayout();
+        auto textLine = layout.createLine();
+        if (textLine.isValid())
+        {
+            textLine.setLineWidth(std::numeric_limits<int>::max() / 2);
+            textLine.setPosition(QPointF(0, 0));
+            widest = qMax(widest, qCeil(textLine.naturalTextWidth()));
+        }
+        layout.endLayout();
+
+        layout.draw(&painter, QPointF(textLeft, i * lineHeight));
+    }
+
+    painter.restore();
+
+    // Line numbers
+    painter.fillRect(0, 0, gutter, viewport()->height(), background);
+    painter.setPen(m_syntaxStyle->getFormat("LineNumber").foreground().color());
+    painter.setFont(font());
+
+    for (int i = 0; i < count && first + i < m_index.lineCount(); ++i)
+    {
+        painter.drawText(-5, i * lineHeight, gutter, lineHeight, Qt::AlignRight, QString::number(first + i + 1));
+    }
+
+    if (widest + 8 > m_maxLineWidth)
+    {
+        m_maxLineWidth = widest + 8;
+        updateScrollBars();
+    }
+}
@@ -1,10 +1,12 @@
 // QCodeEditor
 #include <QCodeEditor>
+#include <QGutterColumn>
 #include <QLineNumberArea>
 #include <QSyntaxStyle>
 
 // Qt
 #include <QAbstractTextDocumentLayout>
+#include <QMouseEvent>
 #include <QPaintEvent>
 #include <QPainter>
 #include <QScrollBar>
@@ -12,7 +14,7 @@
 #include <QTextEdit>
 
 QLineNumberArea::QLineNumberArea(QCodeEditor *parent)
-    : QWidget(parent), m_syntaxStyle(nullptr), m_codeEditParent(parent), m_squiggles()
+    : QWidget(parent), m_syntaxStyle(nullptr), m_codeEditParent(parent), m_columns(), m_widths(), m_width(0)
 {
 }
 
@@ -23,21 +25,19 @@ QSize QLineNumberArea::sizeHint() const
         return QWidget::sizeHint();
     }
 
-    const int digits = QString::number(m_codeEditParent->document()->blockCount()).length();
-    int space;
-
-#if QT_VERSION >= 0x050B00
-    space = 15 + m_codeEditParent->fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
-#else
-    space = 15 + m_codeEditParent->fontMetrics().width(QLatin1Char('9')) * digits;
-#endif
-
-    return {space, 0};
+    return {m_width, 0};
 }
 
 void QLineNumberArea::setSyntaxStyle(QSyntaxStyle *style)
 {
     m_syntaxStyle = style;
+
+    for (auto column : m_columns)
+    {
+        column->styleChanged();
+    }
+
+    update();
 }
 
 QSyntaxStyle *QLineNumberArea::syntaxStyle() const
@@ -45,21 +45,118 @@ QSyntaxStyle *QLineNumberArea::syntaxStyle() const
     return m_syntaxStyle;
 }
 
-void QLineNumberArea::lint(QCodeEditor::SeverityLevel level, int from, int to)
+void QLineNumberArea::addColumn(QGutterColumn *column, int index)
+{
+    if (column == nullptr || m_columns.contains(column))
+    {
+        return;
+    }
+
+    if (index < 0 || index > m_columns.size())
+    {
+        index = m_columns.size();
+    }
+
+    m_columns.insert(index, column);
+    m_widths.insert(index, 0);
+
+    connect(column, &QGutterColumn::widthChanged, this, [this, column]() { updateWidth(column); });
+    connect(column, &QGutterColumn::updateRequest, this, [this]() { update(); });
+
+    updateWidth(column);
+}
+
+bool QLineNumberArea::removeColumn(const QString &name)
+{
+    auto removed = column(name);
+    if (removed == nullptr)
+    {
+        return false;
+    }
+
+    auto index = m_columns.indexOf(removed);
+    m_width -= m_widths[index];
+
+    m_columns.remove(index);
+    m_widths.remove(index);
+    delete removed;
+
+    m_codeEditParent->updateLineNumberAreaWidth(0);
+    update();
+
+    return true;
+}
+
+QGutterColumn *QLineNumberArea::column(const QString &name) const
+{
+    for (auto column : m_columns)
+    {
+        if (column->name() == name)
+        {
+            return column;
+        }
+    }
+
+    return nullptr;
+}
+
+QVector<QGutterColumn *> QLineNumberArea::columns() const
+{
+    return m_columns;
+}
+
+void QLineNumberArea::invalidate()
 {
-    for (int i = from - 1; i < to; ++i)
+    m_width = 0;
+
+    for (int i = 0; i < m_columns.size(); ++i)
     {
-        m_squiggles[i] = qMax(m_squiggles[i], level);
+        m_columns[i]->styleChanged();
+        m_widths[i] = m_columns[i]->computeWidth();
+        m_width += m_widths[i];
     }
+
+    m_codeEditParent->updateLineNumberAreaWidth(0);
     update();
 }
 
-void QLineNumberArea::clearLint()
+void QLineNumberArea::updateWidth(QGutterColumn *column)
 {
-    m_squiggles.clear();
+    auto index = m_columns.indexOf(column);
+    if (index < 0)
+    {
+        return;
+    }
+
+    auto width = column->computeWidth();
+    if (width == m_widths[index])
+    {
+        return;
+    }
+
+    m_width += width - m_widths[index];
+    m_widths[index] = width;
+
+    m_codeEditParent->updateLineNumberAreaWidth(0);
     update();
 }
 
+void QLineNumberArea::updateBlock(const QTextBlock &block)
+{
+    if (!block.isValid() || !block.isVisible())
+    {
+        return;
+    }
+
+    auto rect = m_codeEditParent->document()->documentLayout()->blockBoundingRect(block).translated(
+        0, -m_codeEditParent->verticalScrollBar()->value());
+
+    if (rect.bottom() >= 0 && rect.top() <= height())
+    {
+        update(0, static_cast<int>(rect.top()), width(), static_cast<int>(rect.height()) + 1);
+    }
+}
+
 void QLineNumberArea::paintEvent(QPaintEvent *event)
 {
     QPainter painter(this);
@@ -67,60 +164,79 @@ void QLineNumberArea::paintEvent(QPaintEvent *event)
     // Clearing rect to update
     painter.fillRect(event->rect(), m_syntaxStyle->getFormat("Text").background().color());
 
-    auto blockNumber = m_codeEditParent->getFirstVisibleBlock();
-    auto block = m_codeEditParent->document()->findBlockByNumber(blockNumber);
-    auto top = (int)m_codeEditParent->document()
-                   ->documentLayout()
-                   ->blockBoundingRect(block)
-                   .translated(0, -m_codeEditParent->verticalScrollBar()->value())
-                   .top();
-    auto bottom = top + (int)m_codeEditParent->document()->documentLayout()->blockBoundingRect(block).height();
+    // Blocks of the damaged rows only, the area is aligned with the viewport
+    auto rect = event->rect();
+    auto block = m_codeEditParent->cursorForPosition(QPoint(0, rect.top())).block();
+    auto last = m_codeEditParent->cursorForPosition(QPoint(0, rect.bottom())).block();
 
-    auto currentLine = m_syntaxStyle->getFormat("CurrentLineNumber").foreground().color();
-    auto otherLines = m_syntaxStyle->getFormat("LineNumber").foreground().color();
+    for (auto column : m_columns)
+    {
+        column->beginPaint(block, last);
+    }
 
-    painter.setFont(m_codeEditParent->font());
+    auto layout = m_codeEditParent->document()->documentLayout();
+    auto offset = m_codeEditParent->verticalScrollBar()->value();
+    auto rowHeight = m_codeEditParent->fontMetrics().height();
+    auto blockNumber = block.blockNumber();
 
-    while (block.isValid() && top <= event->rect().bottom())
+    while (block.isValid())
     {
-        if (block.isVisible() && bottom >= event->rect().top())
+        auto blockRect = layout->blockBoundingRect(block).translated(0, -offset);
+        auto top = static_cast<int>(blockRect.top());
+        if (top > rect.bottom())
         {
-            QString number = QString::number(blockNumber + 1);
+            break;
+        }
 
-            if (m_squiggles.contains(blockNumber))
+        if (block.isVisible())
+        {
+            int x = 0;
+            for (int i = 0; i < m_columns.size(); ++i)
             {
-                QColor squiggleColor;
-                switch (m_squiggles[blockNumber])
-                {
-                case QCodeEditor::SeverityLevel::Error:
-                    squiggleColor = m_syntaxStyle->getFormat("Error").underlineColor();
-                    break;
-                case QCodeEditor::SeverityLevel::Warning:
-                    squiggleColor = m_syntaxStyle->getFormat("Warning").underlineColor();
-                    break;
-                case QCodeEditor::SeverityLevel::Information:
-                    squiggleColor = m_syntaxStyle->getFormat("Warning").underlineColor();
-                    break;
-                case QCodeEditor::SeverityLevel::Hint:
-                    squiggleColor = m_syntaxStyle->getFormat("Text").foreground().color();
-                    break;
-                default:
-                    Q_UNREACHABLE();
-                    break;
-                }
-                painter.fillRect(0, top, 7, m_codeEditParent->fontMetrics().height(), squiggleColor);
+                m_columns[i]->paintRow(painter, QRect(x, top, m_widths[i], rowHeight), block, blockNumber);
+                x += m_widths[i];
             }
+        }
 
-            auto isCurrentLine = m_codeEditParent->textCursor().blockNumber() == blockNumber;
-            painter.setPen(isCurrentLine ? currentLine : otherLines);
+        auto next = block.next();
+        if (next.isValid() && !next.isVisible())
+        {
+            // Jump over a folded region instead of walking its blocks
+            next = m_codeEditParent->cursorForPosition(QPoint(0, static_cast<int>(blockRect.bottom()) + 1)).block();
+            if (next.blockNumber() <= blockNumber)
+            {
+                break;
+            }
 
-            painter.drawText(-5, top, sizeHint().width(), m_codeEditParent->fontMetrics().height(), Qt::AlignRight,
-                             number);
+            block = next;
+            blockNumber = next.blockNumber();
+            continue;
         }
 
-        block = block.next();
-        top = bottom;
-        bottom = top + (int)m_codeEditParent->document()->documentLayout()->blockBoundingRect(block).height();
+        block = next;
         ++blockNumber;
     }
 }
+
+void QLineNumberArea::mousePressEvent(QMouseEvent *event)
+{
+    auto block = m_codeEditParent->cursorForPosition(QPoint(0, event->pos().y())).block();
+
+    int x = 0;
+    for (int i = 0; i < m_columns.size(); ++i)
+    {
+        x += m_widths[i];
+
+        if (event->pos().x() < x)
+        {
+            if (m_columns[i]->mousePressed(block, event))
+            {
+                return;
+            }
+
+            break;
+        }
+    }
+
+    QWidget::mousePressEvent(event);
+}
@@ -0,0 +1,129 @@
+// QCodeEditor
+#include <QCodeEditor>
+#include <QLineNumberColumn>
+#include <QSyntaxStyle>
+
+// Qt
+#include <QPaintDevice>
+#include <QPainter>
+#include <QTextBlock>
+#include <QTextDocument>
+
+namespace
+{
+// Space around the numbers
+constexpr int LeftMargin = 3;
+constexpr int RightMargin = 5;
+
+int digitCount(int number)
+{
+    int digits = 1;
+
+    for (; number >= 10; number /= 10)
+    {
+        ++digits;
+    }
+
+    return digits;
+}
+} // namespace
+
+QLineNumberColumn::QLineNumberColumn(QCodeEditor *editor)
+    : QGutterColumn("LineNumbers", editor), m_digits(digitCount(editor->document()->blockCount())), m_atlas(),
+      m_cellWidth(0), m_cellHeight(0), m_currentBlockNumber(-1)
+{
+    connect(editor->document(), &QTextDocument::blockCountChanged, this, [this](int count) {
+        auto digits = digitCount(count);
+
+        if (digits != m_digits)
+        {
+            m_digits = digits;
+            Q_EMIT widthChanged();
+        }
+    });
+}
+
+int QLineNumberColumn::computeWidth() const
+{
+#if QT_VERSION >= 0x050B00
+    auto digitWidth = editor()->fontMetrics().horizontalAdvance(QLatin1Char('9'));
+#else
+    auto digitWidth = editor()->fontMetrics().width(QLatin1Char('9'));
+#endif
+
+    return LeftMargin + digitWidth * m_digits + RightMargin;
+}
+
+void QLineNumberColumn::beginPaint(const QTextBlock &, const QTextBlock &)
+{
+    m_currentBlockNumber = editor()->textCursor().blockNumber();
+}
+
+void QLineNumberColumn::paintRow(QPainter &painter, const QRect &rect, const QTextBlock &, int blockNumber)
+{
+    auto ratio = painter.device()->devicePixelRatioF();
+
+    if (m_atlas.isNull() || m_atlas.devicePixelRatio() != ratio)
+    {
+        updateAtlas(ratio);
+    }
+
+    char digits[16];
+    int count = 0;
+
+    for (auto number = blockNumber + 1; number > 0 || count == 0; number /= 10)
+    {
+        digits[count++] = static_cast<char>(number % 10);
+    }
+
+    auto row = blockNumber == m_currentBlockNumber ? 1 : 0;
+    auto x = rect.right() + 1 - RightMargin - count * m_cellWidth;
+
+    // Least significant digit is first
+    for (int i = count - 1; i >= 0; --i, x += m_cellWidth)
+    {
+        painter.drawPixmap(QRectF(x, rect.top(), m_cellWidth, m_cellHeight), m_atlas,
+                           QRectF(digits[i] * m_cellWidth * ratio, row * m_cellHeight * ratio, m_cellWidth * ratio,
+                                  m_cellHeight * ratio));
+    }
+}
+
+void QLineNumberColumn::styleChanged()
+{
+    m_atlas = QPixmap();
+}
+
+void QLineNumberColumn::updateAtlas(qreal ratio)
+{
+    auto metrics = editor()->fontMetrics();
+
+#if QT_VERSION >= 0x050B00
+    m_cellWidth = metrics.horizontalAdvance(QLatin1Char('9'));
+#else
+    m_cellWidth = metrics.width(QLatin1Char('9'));
+#endif
+    m_cellHeight = metrics.height();
+
+    m_atlas = QPixmap(QSize(m_cellWidth * 10, m_cellHeight * 2) * ratio);
+    m_atlas.setDevicePixelRatio(ratio);
+    m_atlas.fill(Qt::transparent);
+
+    auto style = editor()->syntaxStyle();
+
+    QPainter painter(&m_atlas);
+    painter.setFont(editor()->font());
+
+    const QColor colors[] = {style->getFormat("LineNumber").foreground().color(),
+                             style->getFormat("CurrentLineNumber").foreground().color()};
+
+    for (int row = 0; row < 2; ++row)
+    {
+        painter.setPen(colors[row]);
+
+        for (int digit = 0; digit < 10; ++digit)
+        {
+            painter.drawText(QRect(digit * m_cellWidth, row * m_cellHeight, m_cellWidth, m_cellHeight),
+                             Qt::AlignCenter, QString::number(digit));
+        }
+    }
+}
@@ -0,0 +1,315 @@
+// QCodeEditor
+#include <QDiagnosticStore>
+#include <QLinterRunner>
+
+// Qt
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QTemporaryFile>
+#include <QTextDocument>
+#include <QTimer>
+
+namespace
+{
+// Delay of linting after the last change, ms
+constexpr int DefaultDelay = 500;
+} // namespace
+
+QLinterRunner::Adapter QLinterRunner::compilerAdapter()
+{
+    return Adapter(QRegularExpression(R"(^(?<file>.+?):(?<line>\d+):(?:(?<column>\d+):)?\s*)"
+                                      R"((?<severity>fatal error|error|warning|note|remark):\s*(?<message>.*)$)"),
+                   {{"fatal error", QCodeEditor::SeverityLevel::Error},
+                    {"error", QCodeEditor::SeverityLevel::Error},
+                    {"warning", QCodeEditor::SeverityLevel::Warning},
+                    {"note", QCodeEditor::SeverityLevel::Information},
+                    {"remark", QCodeEditor::SeverityLevel::Hint}});
+}
+
+QLinterRunner::Adapter QLinterRunner::pylintAdapter()
+{
+    Adapter adapter(
+        QRegularExpression(R"(^(?<file>.+?):(?<line>\d+):(?<column>\d+): (?<severity>[A-Z])\d+: (?<message>.*)$)"),
+        {{"f", QCodeEditor::SeverityLevel::Error},
+         {"e", QCodeEditor::SeverityLevel::Error},
+         {"w", QCodeEditor::SeverityLevel::Warning},
+         {"r", QCodeEditor::SeverityLevel::Information},
+         {"c", QCodeEditor::SeverityLevel::Information},
+         {"i", QCodeEditor::SeverityLevel::Hint}});
+
+    // pylint counts columns of the decoded text from 0
+    adapter.columnBase = 0;
+    adapter.columnEncoding = QPositionMapper::Encoding::CodePoint;
+
+    return adapter;
+}
+
+QLinterRunner::Adapter QLinterRunner::luacheckAdapter()
+{
+    return Adapter(QRegularExpression(R"(^(?<file>.+?):(?<line>\d+):(?<column>\d+)(?:-(?<endColumn>\d+))?: )"
+                                      R"(\((?<severity>[EW])\d+\) (?<message>.*)$)"),
+                   {{"e", QCodeEditor::SeverityLevel::Error}, {"w", QCodeEditor::SeverityLevel::Warning}});
+}
+
+QLinterRunner::QLinterRunner(QCodeEditor *editor, QObject *parent)
+    : QObject(parent), m_editor(editor), m_program(), m_arguments(), m_input(Input::StandardInput), m_fileSuffix(),
+      m_adapter(compilerAdapter()), m_timer(new QTimer(this)), m_process(nullptr), m_changeFilter(editor->document())
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(DefaultDelay);
+
+    connect(m_timer, &QTimer::timeout, this, &QLinterRunner::run);
+    connect(editor->document(), &QTextDocument::contentsChange, this, &QLinterRunner::onContentsChange);
+}
+
+QLinterRunner::~QLinterRunner()
+{
+    cancel();
+}
+
+void QLinterRunner::setProgram(const QString &program, const QStringList &arguments, Input input,
+                               const QString &fileSuffix)
+{
+    m_program = program;
+    m_arguments = arguments;
+    m_input = input;
+    m_fileSuffix = fileSuffix;
+}
+
+void QLinterRunner::setAdapter(const Adapter &adapter)
+{
+    m_adapter = adapter;
+}
+
+void QLinterRunner::setDelay(int msec)
+{
+    m_timer->setInterval(msec);
+}
+
+int QLinterRunner::delay() const
+{
+    return m_timer->interval();
+}
+
+bool QLinterRunner::isRunning() const
+{
+    return m_process != nullptr;
+}
+
+void QLinterRunner::run()
+{
+    cancel();
+
+    if (!m_editor || m_program.isEmpty())
+    {
+        return;
+    }
+
+    auto text = m_editor->document()->toPlainText();
+    auto revision = m_editor->document()->revision();
+    auto version = m_editor->diagnostics()->version();
+
+    auto process = new QProcess(this);
+    auto arguments = m_arguments;
+
+    if (m_input == Input::TemporaryFile)
+    {
+        // Removed together with the process
+        auto file = new QTemporaryFile(QDir::temp().filePath("qcodeeditor_XXXXXX" + m_fileSuffix), process);
+
+        if (!file->open() || file->write(text.toUtf8()) < 0)
+        {
+            Q_EMIT failed(file->errorString());
+            delete process;
+            return;
+        }
+
+        file->close();
+        arguments.replaceInStrings(FilePlaceholder, file->fileName());
+    }
+
+    m_process = process;
+    process->setProcessChannelMode(QProcess::MergedChannels);
+
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, process, text, revision, version](int, QProcess::ExitStatus) {
+                processFinished(process, text, revision, version);
+            });
+
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+        // Otherwise `finished` follows
+        if (error != QProcess::FailedToStart || process != m_process)
+        {
+            return;
+        }
+
+        m_process = nullptr;
+        process->deleteLater();
+
+        Q_EMIT failed(process->errorString());
+    });
+
+    process->start(m_program, arguments);
+
+    if (m_input == Input::StandardInput)
+    {
+        process->write(text.toUtf8());
+        process->closeWriteChannel();
+    }
+}
+
+void QLinterRunner::cancel()
+{
+    m_timer->stop();
+
+    if (!m_process)
+    {
+        return;
+    }
+
+    auto process = m_process;
+    m_process = nullptr;
+
+    // Deleted once it's really gone, waiting would block
+    process->disconnect(this);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), process, &QObject::deleteLater);
+    process->kill();
+}
+
+void QLinterRunner::onContentsChange(int, int charsRemoved, int charsAdded)
+{
+    // Format changes (e.g. by the highlighter) are reported this way too
+    if (!m_changeFilter.isTextChange(charsRemoved, charsAdded) || m_program.isEmpty())
+    {
+        return;
+    }
+
+    // Restarted on each change, so only a pause in typing runs the linter
+    m_timer->start();
+}
+
+void QLinterRunner::processFinished(QProcess *process, const QString &text, int revision, int version)
+{
+    if (process != m_process)
+    {
+        return;
+    }
+
+    m_process = nullptr;
+    process->deleteLater();
+
+    // Linted text has changed since, a newer run is pending. Without undo only the version tells it
+    if (!m_editor || m_editor->document()->revision() != revision || m_editor->diagnostics()->version() != version)
+    {
+        return;
+    }
+
+    // The text is the linted one, so the document positions are its positions
+    auto mapper = m_editor->positionMapper();
+    auto encoding = m_adapter.columnEncoding;
+
+    const int lineCount = m_editor->document()->blockCount();
+
+    auto lineStart = [&](int line) { return mapper->toOffset({line, 0}); };
+    auto lineEnd = [&](int line) { return lineStart(line) + mapper->lineLength(line); };
+
+    auto number = [](const QString &captured, int fallback) {
+        bool ok = false;
+        auto value = captured.toInt(&ok);
+        return ok ? value : fallback;
+    };
+
+    QVector<QDiagnosticStore::Range> ranges;
+
+    for (auto &line : QString::fromUtf8(process->readAll()).split(QLatin1Char('\n')))
+    {
+        auto match = m_adapter.pattern.match(line.trimmed());
+        if (!match.hasMatch() || !isLintedFile(process, match.captured("file")))
+        {
+            continue;
+        }
+
+        auto startLine = number(match.captured("line"), -1) - m_adapter.lineBase;
+        if (startLine < 0 || startLine >= lineCount)
+        {
+            continue;
+        }
+
+        auto endLine = qBound(startLine, number(match.captured("endLine"), startLine + m_adapter.lineBase) -
+                                             m_adapter.lineBase,
+                              lineCount - 1);
+
+        int start;
+        int end;
+
+        auto column = number(match.captured("column"), -1);
+        if (column < 0)
+        {
+            // Whole line
+            start = lineStart(startLine);
+            end = lineEnd(endLine);
+        }
+        else
+        {
+            start = mapper->toOffset({startLine, column - m_adapter.columnBase}, encoding);
+
+            auto endColumn = number(match.captured("endColumn"), -1);
+            if (endColumn >= 0)
+            {
+                // The end column is inclusive
+                end = mapper->toOffset({endLine, endColumn - m_adapter.columnBase + 1}, encoding);
+            }
+            else
+            {
+                // The word at the column, at least one character
+                auto wordEnd = lineEnd(startLine);
+
+                end = start + 1;
+                while (end < wordEnd && (text[end].isLetterOrNumber() || text[end] == QLatin1Char('_')))
+                {
+                    ++end;
+                }
+            }
+
+            end = qBound(start, end, lineEnd(endLine));
+        }
+
+        auto message = match.captured("message").trimmed();
+
+        ranges.append({start, end,
+                       m_adapter.severities.value(match.captured("severity").toLower(),
+                                                  QCodeEditor::SeverityLevel::Warning),
+                       message.isEmpty() ? line.trimmed() : message});
+    }
+
+    m_editor->diagnostics()->setDiagnostics(ranges, version);
+
+    Q_EMIT finished(ranges.size());
+}
+
+bool QLinterRunner::isLintedFile(QProcess *process, const QString &file) const
+{
+    if (file.isEmpty())
+    {
+        return true;
+    }
+
+    if (m_input == Input::StandardInput)
+    {
+        return m_adapter.standardInputNames.contains(file);
+    }
+
+    // Still there, it's removed together with the process
+    auto temporaryFile = process->findChild<QTemporaryFile *>();
+    if (!temporaryFile)
+    {
+        return false;
+    }
+
+    // The path may be reported relative to the working directory or through a link
+    auto path = temporaryFile->fileName();
+    auto canonicalPath = QFileInfo(path).canonicalFilePath();
+
+    return file == path || (!canonicalPath.isEmpty() && QFileInfo(file).canonicalFilePath() == canonicalPath);
+}
@@ -4,9 +4,8 @@
 
 // Qt
 #include <QFile>
-#include <QStringListModel>
 
-QLuaCompleter::QLuaCompleter(QObject *parent) : QCompleter(parent)
+QLuaCompleter::QLuaCompleter(QObject *parent) : QFuzzyCompleter(parent)
 {
     // Setting up GLSL types
     QStringList list;
@@ -33,9 +32,5 @@ QLuaCompleter::QLuaCompleter(QObject *parent) : QCompleter(parent)
         list.append(names);
     }
 
-    setModel(new QStringListModel(list, this));
-    setCompletionColumn(0);
-    setModelSorting(QCompleter::CaseInsensitivelySortedModel);
-    setCaseSensitivity(Qt::CaseSensitive);
-    setWrapAround(true);
+    setCandidates(list);
 }
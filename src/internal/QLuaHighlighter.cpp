@@ -59,6 +59,8 @@ QLuaHighlighter::QLuaHighlighter(QTextDocument *document)
     m_commentLineSequence = "--";
     m_startCommentBlockSequence = "--[[";
     m_endCommentBlockSequence = "]]";
+
+    m_foldingMode = FoldingMode::Indentation;
 }
 
 void QLuaHighlighter::highlightBlock(const QString &text)
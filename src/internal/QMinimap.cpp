@@ -0,0 +1,306 @@
+// QCodeEditor
+#include <QCodeBlockData>
+#include <QCodeEditor>
+#include <QMinimap>
+#include <QSyntaxStyle>
+
+// Qt
+#include <QAbstractTextDocumentLayout>
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextLayout>
+
+// std
+#include <limits>
+
+namespace
+{
+// Size of a character in the minimap, px
+constexpr int ColumnWidth = 1;
+constexpr int GlyphHeight = 2;
+constexpr int RowHeight = 3;
+
+constexpr int MinimapWidth = 100;
+constexpr int TabWidth = 4;
+} // namespace
+
+QMinimap::QMinimap(QCodeEditor *editor)
+    : QWidget(editor), m_editor(editor), m_generation(0), m_blockCount(editor->document()->blockCount()), m_pixmap(),
+      m_pixmapValid(false), m_pixmapFirstRow(0), m_dirtyFrom(std::numeric_limits<int>::max()), m_dirtyTo(-1)
+{
+    setCursor(Qt::PointingHandCursor);
+
+    connect(editor->document(), &QTextDocument::contentsChange, this, &QMinimap::onContentsChange);
+}
+
+QSize QMinimap::sizeHint() const
+{
+    return {MinimapWidth, 0};
+}
+
+void QMinimap::invalidate()
+{
+    ++m_generation;
+    m_pixmapValid = false;
+
+    update();
+}
+
+void QMinimap::onContentsChange(int position, int, int charsAdded)
+{
+    auto document = m_editor->document();
+
+    auto first = document->findBlock(position);
+    auto last = document->findBlock(position + charsAdded);
+    if (!last.isValid())
+    {
+        last = document->lastBlock();
+    }
+
+    for (auto block = first; block.isValid(); block = block.next())
+    {
+        if (auto data = QCodeBlockData::get(block))
+        {
+            data->minimapGeneration = -1;
+        }
+
+        if (block == last)
+        {
+            break;
+        }
+    }
+
+    m_dirtyFrom = qMin(m_dirtyFrom, first.blockNumber());
+    m_dirtyTo = qMax(m_dirtyTo, last.blockNumber());
+
+    // Inserted or removed lines move all rows below
+    if (document->blockCount() != m_blockCount)
+    {
+        m_blockCount = document->blockCount();
+        m_dirtyTo = std::numeric_limits<int>::max();
+    }
+
+    update();
+}
+
+int QMinimap::firstRow() const
+{
+    auto count = m_editor->document()->blockCount();
+    auto rows = height() / RowHeight;
+    if (count <= rows)
+    {
+        return 0;
+    }
+
+    // Scrolled in proportion to the editor
+    auto firstVisible = m_editor->cursorForPosition(QPoint(0, 0)).blockNumber();
+    auto lastVisible = m_editor->cursorForPosition(QPoint(0, m_editor->viewport()->height())).blockNumber();
+    auto range = count - (lastVisible - firstVisible + 1);
+    if (range <= 0)
+    {
+        return 0;
+    }
+
+    return qBound(0, static_cast<int>(static_cast<qint64>(firstVisible) * (count - rows) / range), count - rows);
+}
+
+void QMinimap::paintEvent(QPaintEvent *)
+{
+    if (!m_editor->syntaxStyle())
+    {
+        return;
+    }
+
+    auto document = m_editor->document();
+    auto rows = (height() + RowHeight - 1) / RowHeight;
+    auto first = firstRow();
+
+    if (m_pixmap.size() != size())
+    {
+        m_pixmap = QPixmap(size());
+        m_pixmapValid = false;
+    }
+
+    // Rows, which are in the pixmap already, are moved instead of painted
+    auto exposedFrom = 0;
+    auto exposedTo = rows;
+
+    if (m_pixmapValid)
+    {
+        auto shift = first - m_pixmapFirstRow;
+
+        if (shift > 0 && shift < rows)
+        {
+            m_pixmap.scroll(0, -shift * RowHeight, m_pixmap.rect());
+            exposedFrom = rows - shift;
+        }
+        else if (shift < 0 && -shift < rows)
+        {
+            m_pixmap.scroll(0, -shift * RowHeight, m_pixmap.rect());
+            exposedTo = -shift;
+        }
+        else if (shift == 0)
+        {
+            exposedFrom = exposedTo = 0;
+        }
+    }
+
+    {
+        QPainter painter(&m_pixmap);
+
+        if (exposedFrom < exposedTo)
+        {
+            paintRows(painter, document->findBlockByNumber(first + exposedFrom), exposedFrom, exposedTo);
+        }
+
+        auto dirtyFrom = qMax(m_dirtyFrom - first, 0);
+        auto dirtyTo = static_cast<int>(qMin(static_cast<qint64>(m_dirtyTo) - first + 1, static_cast<qint64>(rows)));
+
+        if (dirtyFrom < dirtyTo)
+        {
+            paintRows(painter, document->findBlockByNumber(first + dirtyFrom), dirtyFrom, dirtyTo);
+        }
+    }
+
+    m_pixmapValid = true;
+    m_pixmapFirstRow = first;
+    m_dirtyFrom = std::numeric_limits<int>::max();
+    m_dirtyTo = -1;
+
+    QPainter painter(this);
+    painter.drawPixmap(0, 0, m_pixmap);
+
+    // Visible part of the document
+    auto firstVisible = m_editor->cursorForPosition(QPoint(0, 0)).blockNumber();
+    auto lastVisible = m_editor->cursorForPosition(QPoint(0, m_editor->viewport()->height())).blockNumber();
+
+    auto slider = m_editor->syntaxStyle()->getFormat("Selection").background().color();
+    slider.setAlpha(80);
+
+    painter.fillRect(
+        QRect(0, (firstVisible - first) * RowHeight, width(), (lastVisible - firstVisible + 1) * RowHeight), slider);
+}
+
+void QMinimap::paintRows(QPainter &painter, QTextBlock block, int from, int to)
+{
+    painter.fillRect(QRect(0, from * RowHeight, width(), (to - from) * RowHeight),
+                     m_editor->syntaxStyle()->getFormat("Text").background());
+
+    for (auto row = from; row < to && block.isValid(); ++row, block = block.next())
+    {
+        updateRuns(block);
+
+        for (auto &run : qAsConst(QCodeBlockData::get(block)->minimapRuns))
+        {
+            painter.fillRect(run.column * ColumnWidth, row * RowHeight, run.length * ColumnWidth, GlyphHeight,
+                             QColor(run.color));
+        }
+    }
+}
+
+void QMinimap::updateRuns(const QTextBlock &block)
+{
+    auto data = QCodeBlockData::get(block, true);
+    if (data->minimapGeneration == m_generation)
+    {
+        return;
+    }
+
+    auto text = block.text();
+    auto style = m_editor->syntaxStyle();
+
+    // Color of each character, formats are read without laying the block out
+    QVector<QRgb> colors(text.size(), style->getFormat("Text").foreground().color().rgb());
+
+    if (auto layout = block.layout())
+    {
+#if QT_VERSION >= 0x050600
+        const auto formats = layout->formats();
+#else
+        const auto formats = layout->additionalFormats();
+#endif
+
+        for (auto &range : formats)
+        {
+            if (!range.format.hasProperty(QTextFormat::ForegroundBrush))
+            {
+                continue;
+            }
+
+            auto color = range.format.foreground().color().rgb();
+            for (int i = qMax(range.start, 0); i < qMin(range.start + range.length, static_cast<int>(text.size())); ++i)
+            {
+                colors[i] = color;
+            }
+        }
+    }
+
+    QVector<QCodeBlockData::MinimapRun> runs;
+    int column = 0;
+
+    for (int i = 0; i < text.size() && column < MinimapWidth / ColumnWidth; ++i)
+    {
+        if (text[i] == '\t')
+        {
+            column = (column / TabWidth + 1) * TabWidth;
+            continue;
+        }
+
+        if (!text[i].isSpace())
+        {
+            if (!runs.isEmpty() && runs.last().column + runs.last().length == column && runs.last().color == colors[i])
+            {
+                ++runs.last().length;
+            }
+            else
+            {
+                runs.append({column, 1, colors[i]});
+            }
+        }
+
+        ++column;
+    }
+
+    data->minimapRuns = runs;
+    data->minimapGeneration = m_generation;
+}
+
+void QMinimap::scrollToRow(int y)
+{
+    auto document = m_editor->document();
+
+    auto block = document->findBlockByNumber(firstRow() + qMax(y, 0) / RowHeight);
+    if (!block.isValid())
+    {
+        block = document->lastBlock();
+    }
+
+    auto top = document->documentLayout()->blockBoundingRect(block).top();
+    m_editor->verticalScrollBar()->setValue(static_cast<int>(top) - m_editor->viewport()->height() / 2);
+}
+
+void QMinimap::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton)
+    {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+
+    scrollToRow(event->pos().y());
+}
+
+void QMinimap::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!(event->buttons() & Qt::LeftButton))
+    {
+        QWidget::mouseMoveEvent(event);
+        return;
+    }
+
+    scrollToRow(event->pos().y());
+}
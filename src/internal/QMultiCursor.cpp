@@ -0,0 +1,147 @@
+// QCodeEditor
+#include <QMultiCursor>
+
+// std
+#include <algorithm>
+
+namespace
+{
+bool startsBefore(const QTextCursor &a, const QTextCursor &b)
+{
+    return a.selectionStart() < b.selectionStart() ||
+           (a.selectionStart() == b.selectionStart() && a.selectionEnd() < b.selectionEnd());
+}
+} // namespace
+
+QMultiCursor::QMultiCursor(QObject *parent) : QObject(parent), m_cursors()
+{
+}
+
+bool QMultiCursor::isEmpty() const
+{
+    return m_cursors.isEmpty();
+}
+
+int QMultiCursor::count() const
+{
+    return static_cast<int>(m_cursors.size());
+}
+
+QVector<QTextCursor> QMultiCursor::cursors() const
+{
+    return m_cursors;
+}
+
+QVector<QTextCursor> QMultiCursor::cursors(int from, int to) const
+{
+    // Cursors don't overlap, so their ends are sorted as well
+    auto first = std::lower_bound(m_cursors.cbegin(), m_cursors.cend(), from,
+                                  [](const QTextCursor &cursor, int value) { return cursor.selectionEnd() < value; });
+
+    QVector<QTextCursor> result;
+    for (auto it = first; it != m_cursors.cend() && it->selectionStart() <= to; ++it)
+    {
+        result.append(*it);
+    }
+
+    return result;
+}
+
+void QMultiCursor::addCursor(const QTextCursor &cursor)
+{
+    if (cursor.isNull())
+    {
+        return;
+    }
+
+    auto it = std::upper_bound(m_cursors.begin(), m_cursors.end(), cursor, startsBefore);
+    m_cursors.insert(it, cursor);
+
+    merge();
+
+    Q_EMIT changed();
+}
+
+void QMultiCursor::setCursors(QVector<QTextCursor> cursors)
+{
+    cursors.erase(
+        std::remove_if(cursors.begin(), cursors.end(), [](const QTextCursor &cursor) { return cursor.isNull(); }),
+        cursors.end());
+
+    std::sort(cursors.begin(), cursors.end(), startsBefore);
+    m_cursors = cursors;
+
+    merge();
+
+    Q_EMIT changed();
+}
+
+void QMultiCursor::clear()
+{
+    if (m_cursors.isEmpty())
+    {
+        return;
+    }
+
+    m_cursors.clear();
+
+    Q_EMIT changed();
+}
+
+void QMultiCursor::normalize(const QTextCursor &primary)
+{
+    auto size = m_cursors.size();
+
+    merge();
+
+    m_cursors.erase(std::remove_if(m_cursors.begin(), m_cursors.end(),
+                                   [&primary](const QTextCursor &cursor) { return overlap(cursor, primary); }),
+                    m_cursors.end());
+
+    if (m_cursors.size() != size)
+    {
+        Q_EMIT changed();
+    }
+}
+
+bool QMultiCursor::overlap(const QTextCursor &a, const QTextCursor &b)
+{
+    if (a.selectionStart() == b.selectionStart())
+    {
+        return true;
+    }
+
+    return a.selectionStart() < b.selectionEnd() && b.selectionStart() < a.selectionEnd();
+}
+
+void QMultiCursor::merge()
+{
+    if (m_cursors.size() < 2)
+    {
+        return;
+    }
+
+    int last = 0;
+
+    for (int i = 1; i < m_cursors.size(); ++i)
+    {
+        auto &previous = m_cursors[last];
+        auto &cursor = m_cursors[i];
+
+        if (!overlap(previous, cursor))
+        {
+            m_cursors[++last] = cursor;
+            continue;
+        }
+
+        // The merged cursor covers both selections and keeps the direction of the first one
+        auto start = qMin(previous.selectionStart(), cursor.selectionStart());
+        auto end = qMax(previous.selectionEnd(), cursor.selectionEnd());
+        auto forward = previous.position() >= previous.anchor();
+
+        previous.setPosition(forward ? start : end);
+        previous.setPosition(forward ? end : start, QTextCursor::KeepAnchor);
+    }
+
+    m_cursors.resize(last + 1);
+}
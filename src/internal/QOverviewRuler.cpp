@@ -0,0 +1,363 @@
+// QCodeEditor
+#include <QCodeBlockData>
+#include <QCodeEditor>
+#include <QOverviewRuler>
+#include <QSyntaxStyle>
+
+// Qt
+#include <QPaintEvent>
+#include <QPainter>
+#include <QStyleOptionSlider>
+#include <QTextBlock>
+#include <QTextDocument>
+
+namespace
+{
+// Height of a marker, so single lines are visible, px
+constexpr int MarkerHeight = 3;
+
+// Markers are painted in three columns: changes, matches and diagnostics
+constexpr int ColumnCount = 3;
+
+int laneColumn(QOverviewRuler::Lane lane)
+{
+    switch (lane)
+    {
+    case QOverviewRuler::Lane::Changes:
+        return 0;
+    case QOverviewRuler::Lane::Occurrences:
+    case QOverviewRuler::Lane::SearchResults:
+        return 1;
+    case QOverviewRuler::Lane::Warnings:
+    case QOverviewRuler::Lane::Errors:
+        return 2;
+    default:
+        Q_UNREACHABLE();
+        return 0;
+    }
+}
+} // namespace
+
+QOverviewRuler::QOverviewRuler(QCodeEditor *editor)
+    : QScrollBar(Qt::Vertical, editor), m_editor(editor), m_markers(LaneCount), m_buckets(LaneCount),
+      m_bucketsValid(false), m_bucketBlockCount(0), m_groove()
+{
+    connect(editor->document(), &QTextDocument::blockCountChanged, this, [this](int) {
+        m_bucketsValid = false;
+        update();
+    });
+}
+
+QOverviewRuler::~QOverviewRuler()
+{
+    for (auto &markers : m_markers)
+    {
+        for (auto it = markers.cbegin(); it != markers.cend(); ++it)
+        {
+            it.key()->overviewRuler = nullptr;
+        }
+    }
+}
+
+void QOverviewRuler::addMarker(Lane lane, const QTextBlock &block)
+{
+    if (!block.isValid())
+    {
+        return;
+    }
+
+    auto data = QCodeBlockData::get(block, true);
+    data->overviewRuler = this;
+
+    ++m_markers[static_cast<int>(lane)][data];
+
+    auto rect = changeBucket(lane, data, 1);
+    if (rect.isNull())
+    {
+        update();
+    }
+    else
+    {
+        update(rect);
+    }
+}
+
+void QOverviewRuler::removeMarker(Lane lane, const QTextBlock &block)
+{
+    auto data = QCodeBlockData::get(block);
+    if (!data)
+    {
+        return;
+    }
+
+    auto &markers = m_markers[static_cast<int>(lane)];
+
+    auto it = markers.find(data);
+    if (it == markers.end())
+    {
+        return;
+    }
+
+    if (--it.value() == 0)
+    {
+        markers.erase(it);
+    }
+
+    auto rect = changeBucket(lane, data, -1);
+    if (rect.isNull())
+    {
+        update();
+    }
+    else
+    {
+        update(rect);
+    }
+}
+
+void QOverviewRuler::addMarkers(Lane lane, const QVector<int> &positions)
+{
+    auto document = m_editor->document();
+    auto &markers = m_markers[static_cast<int>(lane)];
+
+    for (auto position : positions)
+    {
+        auto block = document->findBlock(position);
+        if (!block.isValid())
+        {
+            continue;
+        }
+
+        auto data = QCodeBlockData::get(block, true);
+        data->overviewRuler = this;
+
+        ++markers[data];
+        changeBucket(lane, data, 1);
+    }
+
+    update();
+}
+
+void QOverviewRuler::setMarkers(Lane lane, const QVector<int> &positions)
+{
+    auto document = m_editor->document();
+
+    QHash<QCodeBlockData *, int> markers;
+
+    for (auto position : positions)
+    {
+        auto block = document->findBlock(position);
+        if (!block.isValid())
+        {
+            continue;
+        }
+
+        auto data = QCodeBlockData::get(block, true);
+        data->overviewRuler = this;
+
+        ++markers[data];
+    }
+
+    auto &current = m_markers[static_cast<int>(lane)];
+
+    for (auto it = current.cbegin(); it != current.cend(); ++it)
+    {
+        auto count = markers.value(it.key());
+        if (count != it.value())
+        {
+            changeBucket(lane, it.key(), count - it.value());
+        }
+    }
+
+    for (auto it = markers.cbegin(); it != markers.cend(); ++it)
+    {
+        if (!current.contains(it.key()))
+        {
+            changeBucket(lane, it.key(), it.value());
+        }
+    }
+
+    current = markers;
+
+    update();
+}
+
+void QOverviewRuler::clearMarkers(Lane lane)
+{
+    auto index = static_cast<int>(lane);
+    if (m_markers[index].isEmpty())
+    {
+        return;
+    }
+
+    m_markers[index].clear();
+    m_buckets[index].fill(0);
+
+    update();
+}
+
+int QOverviewRuler::markerCount(Lane lane, const QTextBlock &block) const
+{
+    auto data = QCodeBlockData::get(block);
+
+    return data ? m_markers[static_cast<int>(lane)].value(data) : 0;
+}
+
+void QOverviewRuler::removeBlock(QCodeBlockData *data)
+{
+    for (auto &markers : m_markers)
+    {
+        if (markers.remove(data) > 0)
+        {
+            m_bucketsValid = false;
+        }
+    }
+
+    data->overviewRuler = nullptr;
+
+    if (!m_bucketsValid)
+    {
+        update();
+    }
+}
+
+QRect QOverviewRuler::grooveRect() const
+{
+    QStyleOptionSlider option;
+    initStyleOption(&option);
+
+    return style()->subControlRect(QStyle::CC_ScrollBar, &option, QStyle::SC_ScrollBarGroove, this);
+}
+
+int QOverviewRuler::bucket(int blockNumber) const
+{
+    auto rows = m_buckets[0].size();
+
+    return qBound(0, static_cast<int>(static_cast<qint64>(blockNumber) * rows / qMax(m_bucketBlockCount, 1)),
+                  static_cast<int>(rows) - 1);
+}
+
+QRect QOverviewRuler::changeBucket(Lane lane, QCodeBlockData *data, int delta)
+{
+    auto &buckets = m_buckets[static_cast<int>(lane)];
+
+    if (!m_bucketsValid || buckets.isEmpty() || m_bucketBlockCount != m_editor->document()->blockCount())
+    {
+        m_bucketsValid = false;
+        return {};
+    }
+
+    auto row = bucket(data->block.blockNumber());
+    buckets[row] += delta;
+
+    return {0, m_groove.top() + row, width(), MarkerHeight};
+}
+
+void QOverviewRuler::rebuildBuckets()
+{
+    auto rows = qMax(m_groove.height(), 0);
+    m_bucketBlockCount = m_editor->document()->blockCount();
+
+    for (int i = 0; i < LaneCount; ++i)
+    {
+        m_buckets[i].fill(0, rows);
+
+        if (rows == 0)
+        {
+            continue;
+        }
+
+        for (auto it = m_markers[i].cbegin(); it != m_markers[i].cend(); ++it)
+        {
+            m_buckets[i][bucket(it.key()->block.blockNumber())] += it.value();
+        }
+    }
+
+    m_bucketsValid = true;
+}
+
+QColor QOverviewRuler::laneColor(Lane lane) const
+{
+    auto style = m_editor->syntaxStyle();
+
+    // Some styles color the search results with the foreground only
+    auto searchResult = style->getFormat("SearchResult");
+
+    switch (lane)
+    {
+    case Lane::Changes:
+        return style->getFormat("AddedLine").foreground().color();
+    case Lane::Occurrences:
+        return style->getFormat("Occurrences").background().color();
+    case Lane::SearchResults:
+        return searchResult.hasProperty(QTextFormat::BackgroundBrush) ? searchResult.background().color()
+                                                                      : searchResult.foreground().color();
+    case Lane::Warnings:
+        return style->getFormat("Warning").underlineColor();
+    case Lane::Errors:
+        return style->getFormat("Error").underlineColor();
+    default:
+        Q_UNREACHABLE();
+        return {};
+    }
+}
+
+void QOverviewRuler::resizeEvent(QResizeEvent *event)
+{
+    QScrollBar::resizeEvent(event);
+
+    auto groove = grooveRect();
+    if (groove != m_groove)
+    {
+        m_groove = groove;
+        m_bucketsValid = false;
+    }
+}
+
+void QOverviewRuler::paintEvent(QPaintEvent *event)
+{
+    QScrollBar::paintEvent(event);
+
+    if (!m_editor->syntaxStyle())
+    {
+        return;
+    }
+
+    if (!m_bucketsValid || m_bucketBlockCount != m_editor->document()->blockCount())
+    {
+        rebuildBuckets();
+    }
+
+    QPainter painter(this);
+
+    auto columnWidth = qMax(width() / ColumnCount, 1);
+
+    // Rows of the markers reaching the damaged rectangle
+    auto from = qMax(event->rect().top() - m_groove.top() - MarkerHeight + 1, 0);
+    auto to = qMin(event->rect().bottom() - m_groove.top() + 1, static_cast<int>(m_buckets[0].size()));
+
+    for (int i = 0; i < LaneCount; ++i)
+    {
+        auto lane = static_cast<Lane>(i);
+        auto &buckets = m_buckets[i];
+        auto color = laneColor(lane);
+        auto x = laneColumn(lane) * columnWidth;
+
+        for (auto row = from; row < to; ++row)
+        {
+            if (buckets[row] == 0)
+            {
+                continue;
+            }
+
+            // Adjacent rows are painted at once
+            auto end = row + 1;
+            while (end < to && buckets[end] > 0)
+            {
+                ++end;
+            }
+
+            painter.fillRect(x, m_groove.top() + row, columnWidth, end - row + MarkerHeight - 1, color);
+            row = end;
+        }
+    }
+}
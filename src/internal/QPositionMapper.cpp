@@ -0,0 +1,214 @@
+// QCodeEditor
+#include <QCodeBlockData>
+#include <QPositionMapper>
+
+// Qt
+#include <QTextBlock>
+#include <QTextDocument>
+
+// std
+#include <algorithm>
+
+namespace
+{
+// Lines, which are found by walking from the previous one
+constexpr int MaxWalk = 16;
+
+int column(const QCodeBlockData::WideCharacter &character, QPositionMapper::Encoding encoding)
+{
+    switch (encoding)
+    {
+    case QPositionMapper::Encoding::Utf8:
+        return character.utf8;
+    case QPositionMapper::Encoding::CodePoint:
+        return character.codePoint;
+    default:
+        return character.utf16;
+    }
+}
+} // namespace
+
+QPositionMapper::QPositionMapper(QTextDocument *document, QObject *parent) : QObject(parent), m_document(document)
+{
+    connect(document, &QTextDocument::contentsChange, this, &QPositionMapper::onContentsChange);
+
+    indexBlocks(0, m_document->characterCount());
+}
+
+int QPositionMapper::toOffset(const Position &position, Encoding encoding) const
+{
+    return toOffsets({position}, encoding).first();
+}
+
+QPositionMapper::Position QPositionMapper::toPosition(int offset, Encoding encoding) const
+{
+    return toPositions({offset}, encoding).first();
+}
+
+int QPositionMapper::convertColumn(int line, int column, Encoding from, Encoding to) const
+{
+    return convert(findLine(line, QTextBlock()), column, from, to);
+}
+
+int QPositionMapper::lineLength(int line, Encoding encoding) const
+{
+    auto block = findLine(line, QTextBlock());
+    return convert(block, block.length() - 1, Encoding::Utf16, encoding);
+}
+
+QVector<int> QPositionMapper::toOffsets(const QVector<Position> &positions, Encoding encoding) const
+{
+    QVector<int> offsets;
+    offsets.reserve(positions.size());
+
+    QTextBlock block;
+
+    for (auto &position : positions)
+    {
+        block = findLine(position.line, block);
+
+        auto column = convert(block, qMax(position.column, 0), encoding, Encoding::Utf16);
+        offsets.append(block.position() + qMin(column, block.length() - 1));
+    }
+
+    return offsets;
+}
+
+QVector<QPositionMapper::Position> QPositionMapper::toPositions(const QVector<int> &offsets, Encoding encoding) const
+{
+    QVector<Position> positions;
+    positions.reserve(offsets.size());
+
+    QTextBlock block;
+
+    for (auto offset : offsets)
+    {
+        block = findOffset(offset, block);
+
+        auto column = qBound(0, offset - block.position(), block.length() - 1);
+        positions.append({block.blockNumber(), convert(block, column, Encoding::Utf16, encoding)});
+    }
+
+    return positions;
+}
+
+void QPositionMapper::onContentsChange(int position, int, int charsAdded)
+{
+    // Format changes are re-indexed too, as same length replacements look the same
+    indexBlocks(position, position + charsAdded);
+}
+
+void QPositionMapper::indexBlocks(int from, int to)
+{
+    for (auto block = m_document->findBlock(from); block.isValid() && block.position() <= to; block = block.next())
+    {
+        auto text = block.text();
+
+        QVector<QCodeBlockData::WideCharacter> wideCharacters;
+        int utf8 = 0;
+        int codePoint = 0;
+
+        for (int i = 0; i < text.size();)
+        {
+            auto c = text[i].unicode();
+
+            ++codePoint;
+
+            if (c < 0x80)
+            {
+                ++i;
+                ++utf8;
+                continue;
+            }
+
+            if (QChar::isHighSurrogate(c) && i + 1 < text.size() && text[i + 1].isLowSurrogate())
+            {
+                i += 2;
+                utf8 += 4;
+            }
+            else
+            {
+                i += 1;
+                utf8 += c < 0x800 ? 2 : 3;
+            }
+
+            wideCharacters.append({i, utf8, codePoint});
+        }
+
+        auto data = QCodeBlockData::get(block, !wideCharacters.isEmpty());
+        if (data)
+        {
+            data->wideCharacters = wideCharacters;
+        }
+    }
+}
+
+QTextBlock QPositionMapper::findLine(int line, const QTextBlock &hint) const
+{
+    line = qBound(0, line, m_document->blockCount() - 1);
+
+    if (hint.isValid())
+    {
+        auto block = hint;
+        auto number = block.blockNumber();
+
+        for (int i = 0; i < MaxWalk && number < line; ++i, ++number)
+        {
+            block = block.next();
+        }
+
+        if (number == line)
+        {
+            return block;
+        }
+    }
+
+    return m_document->findBlockByNumber(line);
+}
+
+QTextBlock QPositionMapper::findOffset(int offset, const QTextBlock &hint) const
+{
+    offset = qBound(0, offset, m_document->characterCount() - 1);
+
+    if (hint.isValid())
+    {
+        auto block = hint;
+
+        for (int i = 0; i < MaxWalk && block.isValid() && block.position() <= offset; ++i)
+        {
+            if (offset < block.position() + block.length())
+            {
+                return block;
+            }
+
+            block = block.next();
+        }
+    }
+
+    return m_document->findBlock(offset);
+}
+
+int QPositionMapper::convert(const QTextBlock &block, int value, Encoding from, Encoding to)
+{
+    auto data = QCodeBlockData::get(block);
+    if (from == to || !data || data->wideCharacters.isEmpty())
+    {
+        return value;
+    }
+
+    auto &wideCharacters = data->wideCharacters;
+
+    // The last non-ASCII character ending at or before the column, the rest is ASCII
+    auto it = std::upper_bound(
+        wideCharacters.cbegin(), wideCharacters.cend(), value,
+        [from](int v, const QCodeBlockData::WideCharacter &character) { return v < column(character, from); });
+
+    if (it == wideCharacters.cbegin())
+    {
+        return value;
+    }
+
+    --it;
+
+    return column(*it, to) + value - column(*it, from);
+}
@@ -4,9 +4,8 @@
 
 // Qt
 #include <QFile>
-#include <QStringListModel>
 
-QPythonCompleter::QPythonCompleter(QObject *parent) : QCompleter(parent)
+QPythonCompleter::QPythonCompleter(QObject *parent) : QFuzzyCompleter(parent)
 {
     // Setting up Python types
     QStringList list;
@@ -33,9 +32,5 @@ QPythonCompleter::QPythonCompleter(QObject *parent) : QCompleter(parent)
         list.append(names);
     }
 
-    setModel(new QStringListModel(list, this));
-    setCompletionColumn(0);
-    setModelSorting(QCompleter::CaseInsensitivelySortedModel);
-    setCaseSensitivity(Qt::CaseSensitive);
-    setWrapAround(true);
+    setCandidates(list);
 }
@@ -59,6 +59,8 @@ QPythonHighlighter::QPythonHighlighter(QTextDocument *document)
     m_commentLineSequence = "#";
     m_startCommentBlockSequence = "'''";
     m_endCommentBlockSequence = m_startCommentBlockSequence;
+
+    m_foldingMode = FoldingMode::Indentation;
 }
 
 void QPythonHighlighter::highlightBlock(const QString &text)
@@ -0,0 +1,616 @@
+// QCodeEditor
+#include <QBracketIndex>
+#include <QScopeTree>
+
+// Qt
+#include <QRegularExpression>
+#include <QTextDocument>
+
+namespace
+{
+using Summary = QCodeBlockData::ScopeSummary;
+
+// Tag with its attributes, possibly continued on the next line
+const QRegularExpression TagRegex(R"(<(/?)([A-Za-z_][\w:.\-]*)[^<>]*(>?))");
+
+bool isBlank(const QString &text)
+{
+    for (auto c : text)
+    {
+        if (!c.isSpace())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int indentation(const QString &text)
+{
+    int width = 0;
+
+    for (auto c : text)
+    {
+        if (c == ' ')
+        {
+            ++width;
+        }
+        else if (c == '\t')
+        {
+            width += 4;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return width;
+}
+
+int addMinimum(int depth, int minimum)
+{
+    return minimum == Summary::NoMinimum ? minimum : depth + minimum;
+}
+
+Summary concat(const Summary &a, const Summary &b)
+{
+    return {a.delta + b.delta, qMin(a.minimum, addMinimum(a.delta, b.minimum))};
+}
+
+const Summary &own(const QCodeBlockData *node)
+{
+    return node->scopeNode.own;
+}
+
+Summary total(const QCodeBlockData *node)
+{
+    return node ? node->scopeNode.total : Summary();
+}
+
+void pull(QCodeBlockData *node)
+{
+    auto &links = node->scopeNode;
+
+    links.total = concat(concat(total(links.left), links.own), total(links.right));
+
+    if (links.left)
+    {
+        links.left->scopeNode.parent = node;
+    }
+
+    if (links.right)
+    {
+        links.right->scopeNode.parent = node;
+    }
+}
+
+QCodeBlockData *merge(QCodeBlockData *a, QCodeBlockData *b)
+{
+    if (!a || !b)
+    {
+        return a ? a : b;
+    }
+
+    if (a->scopeNode.priority > b->scopeNode.priority)
+    {
+        a->scopeNode.right = merge(a->scopeNode.right, b);
+        pull(a);
+        return a;
+    }
+
+    b->scopeNode.left = merge(a, b->scopeNode.left);
+    pull(b);
+    return b;
+}
+
+// Splits into blocks before position and the rest
+void split(QCodeBlockData *node, int position, QCodeBlockData *&left, QCodeBlockData *&right)
+{
+    if (!node)
+    {
+        left = right = nullptr;
+        return;
+    }
+
+    if (node->block.position() < position)
+    {
+        split(node->scopeNode.right, position, node->scopeNode.right, right);
+        left = node;
+        pull(left);
+    }
+    else
+    {
+        split(node->scopeNode.left, position, left, node->scopeNode.left);
+        right = node;
+        pull(right);
+    }
+}
+
+// Last node of the subtree, which lowest depth is below need
+QCodeBlockData *lastInside(QCodeBlockData *node, int depth, int need, int &nodeDepth)
+{
+    while (node && addMinimum(depth, total(node).minimum) < need)
+    {
+        auto &links = node->scopeNode;
+        auto start = depth + total(links.left).delta;
+
+        if (links.right && addMinimum(start + links.own.delta, total(links.right).minimum) < need)
+        {
+            depth = start + links.own.delta;
+            node = links.right;
+            continue;
+        }
+
+        if (addMinimum(start, links.own.minimum) < need)
+        {
+            nodeDepth = start;
+            return node;
+        }
+
+        node = links.left;
+    }
+
+    return nullptr;
+}
+
+// Last node before limit, which lowest depth is below need
+QCodeBlockData *lastBefore(QCodeBlockData *node, int limit, int depth, int need, int &nodeDepth)
+{
+    if (!node)
+    {
+        return nullptr;
+    }
+
+    auto &links = node->scopeNode;
+
+    if (node->block.position() >= limit)
+    {
+        return lastBefore(links.left, limit, depth, need, nodeDepth);
+    }
+
+    auto start = depth + total(links.left).delta;
+
+    if (auto found = lastBefore(links.right, limit, start + links.own.delta, need, nodeDepth))
+    {
+        return found;
+    }
+
+    if (addMinimum(start, links.own.minimum) < need)
+    {
+        nodeDepth = start;
+        return node;
+    }
+
+    return lastInside(links.left, depth, need, nodeDepth);
+}
+
+// First node of the subtree, which lowest depth is below need
+QCodeBlockData *firstInside(QCodeBlockData *node, int depth, int need, int &nodeDepth)
+{
+    while (node && addMinimum(depth, total(node).minimum) < need)
+    {
+        auto &links = node->scopeNode;
+
+        if (links.left && addMinimum(depth, total(links.left).minimum) < need)
+        {
+            node = links.left;
+            continue;
+        }
+
+        auto start = depth + total(links.left).delta;
+
+        if (addMinimum(start, links.own.minimum) < need)
+        {
+            nodeDepth = start;
+            return node;
+        }
+
+        depth = start + links.own.delta;
+        node = links.right;
+    }
+
+    return nullptr;
+}
+
+// First node after limit, which lowest depth is below need
+QCodeBlockData *firstAfter(QCodeBlockData *node, int limit, int depth, int need, int &nodeDepth)
+{
+    if (!node)
+    {
+        return nullptr;
+    }
+
+    auto &links = node->scopeNode;
+    auto start = depth + total(links.left).delta;
+
+    if (node->block.position() <= limit)
+    {
+        return firstAfter(links.right, limit, start + links.own.delta, need, nodeDepth);
+    }
+
+    if (auto found = firstAfter(links.left, limit, depth, need, nodeDepth))
+    {
+        return found;
+    }
+
+    if (addMinimum(start, links.own.minimum) < need)
+    {
+        nodeDepth = start;
+        return node;
+    }
+
+    return firstInside(links.right, start + links.own.delta, need, nodeDepth);
+}
+} // namespace
+
+QScopeTree::QScopeTree(QTextDocument *document, QBracketIndex *brackets, QObject *parent)
+    : QObject(parent), m_document(document), m_brackets(brackets),
+      m_mode(QStyleSyntaxHighlighter::FoldingMode::None), m_root(nullptr), m_seed(2463534242u)
+{
+    connect(document, &QTextDocument::contentsChange, this, &QScopeTree::onContentsChange);
+}
+
+QScopeTree::~QScopeTree()
+{
+    // The document may have been deleted first
+    if (!m_document)
+    {
+        return;
+    }
+
+    for (auto block = m_document->begin(); block.isValid(); block = block.next())
+    {
+        auto data = QCodeBlockData::get(block);
+        if (data && data->scopeTree == this)
+        {
+            data->scopeTree = nullptr;
+            data->scopeNode = QCodeBlockData::ScopeNode();
+        }
+    }
+}
+
+void QScopeTree::setMode(QStyleSyntaxHighlighter::FoldingMode mode)
+{
+    m_mode = mode;
+
+    for (auto block = m_document->begin(); block.isValid(); block = block.next())
+    {
+        auto data = QCodeBlockData::get(block);
+        if (data && data->scopeTree == this)
+        {
+            data->scopeTree = nullptr;
+            data->scopeNode = QCodeBlockData::ScopeNode();
+        }
+    }
+
+    m_root = nullptr;
+
+    indexBlocks(0, m_document->characterCount());
+
+    Q_EMIT scopesChanged(0, m_document->blockCount() - 1);
+}
+
+QStyleSyntaxHighlighter::FoldingMode QScopeTree::mode() const
+{
+    return m_mode;
+}
+
+QVector<QTextBlock> QScopeTree::enclosingScopes(const QTextBlock &block) const
+{
+    QVector<QTextBlock> scopes;
+
+    if (!block.isValid() || m_mode == QStyleSyntaxHighlighter::FoldingMode::None)
+    {
+        return scopes;
+    }
+
+    int need = 0;
+
+    if (m_mode == QStyleSyntaxHighlighter::FoldingMode::Indentation)
+    {
+        // A blank line belongs to the scope of the line after it
+        auto line = block;
+        while (line.isValid() && isBlank(line.text()))
+        {
+            line = line.next();
+        }
+
+        if (!line.isValid())
+        {
+            return scopes;
+        }
+
+        need = indentation(line.text());
+    }
+    else
+    {
+        need = depth(block.position());
+    }
+
+    // Each scope is opened by the last block before it reaching a lower depth
+    int nodeDepth = 0;
+    for (auto node = lastBefore(m_root, block.position(), 0, need, nodeDepth); node;
+         node = lastBefore(m_root, node->block.position(), 0, need, nodeDepth))
+    {
+        scopes.prepend(node->block);
+        need = addMinimum(nodeDepth, own(node).minimum);
+    }
+
+    return scopes;
+}
+
+QTextBlock QScopeTree::scopeEnd(const QTextBlock &block) const
+{
+    auto data = QCodeBlockData::get(block);
+    if (!data || data->scopeTree != this || !data->scopeNode.linked)
+    {
+        return {};
+    }
+
+    auto &summary = own(data);
+    auto indented = m_mode == QStyleSyntaxHighlighter::FoldingMode::Indentation;
+
+    // Nothing is left open after the lowest depth of the block
+    if (!indented && summary.delta - summary.minimum <= 0)
+    {
+        return {};
+    }
+
+    int nodeDepth = 0;
+    auto need = addMinimum(depth(block.position()), summary.minimum) + 1;
+    auto closing = firstAfter(m_root, block.position(), 0, need, nodeDepth);
+
+    QTextBlock end;
+    if (closing)
+    {
+        end = closing->block.previous();
+    }
+    else if (indented)
+    {
+        end = m_document->lastBlock();
+    }
+
+    // Trailing blank lines are left out of indented scopes
+    while (indented && end.isValid() && end.blockNumber() > block.blockNumber() && isBlank(end.text()))
+    {
+        end = end.previous();
+    }
+
+    return end.isValid() && end.blockNumber() > block.blockNumber() ? end : QTextBlock();
+}
+
+void QScopeTree::removeBlock(QCodeBlockData *data)
+{
+    if (data->scopeNode.linked)
+    {
+        unlink(data);
+    }
+}
+
+void QScopeTree::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (m_mode == QStyleSyntaxHighlighter::FoldingMode::None)
+    {
+        return;
+    }
+
+    auto first = m_document->findBlock(position);
+    auto last = m_document->findBlock(position + charsAdded);
+    if (!last.isValid())
+    {
+        last = m_document->lastBlock();
+    }
+
+    // Removed blocks are dropped by QCodeBlockData
+    auto changed = charsRemoved != charsAdded;
+
+    for (auto block = first; block.isValid(); block = block.next())
+    {
+        changed = indexBlock(block) || changed;
+
+        if (block == last)
+        {
+            break;
+        }
+    }
+
+    if (changed)
+    {
+        Q_EMIT scopesChanged(first.blockNumber(), last.blockNumber());
+    }
+}
+
+void QScopeTree::indexBlocks(int from, int to)
+{
+    if (m_mode == QStyleSyntaxHighlighter::FoldingMode::None)
+    {
+        return;
+    }
+
+    for (auto block = m_document->findBlock(from); block.isValid() && block.position() <= to; block = block.next())
+    {
+        indexBlock(block);
+    }
+}
+
+bool QScopeTree::indexBlock(const QTextBlock &block)
+{
+    auto summary = this->summary(block);
+    auto linked = summary.minimum != Summary::NoMinimum;
+
+    auto data = QCodeBlockData::get(block, linked);
+    if (!data)
+    {
+        return false;
+    }
+
+    auto &links = data->scopeNode;
+    auto changed = data->scopeTree != this || links.linked != linked || links.own.delta != summary.delta ||
+                   links.own.minimum != summary.minimum;
+
+    if (!changed)
+    {
+        return false;
+    }
+
+    links.own = summary;
+    data->scopeTree = this;
+
+    if (!linked)
+    {
+        if (links.linked)
+        {
+            unlink(data);
+        }
+    }
+    else if (!links.linked)
+    {
+        link(data);
+    }
+    else
+    {
+        for (auto node = data; node; node = node->scopeNode.parent)
+        {
+            pull(node);
+        }
+    }
+
+    return true;
+}
+
+QCodeBlockData::ScopeSummary QScopeTree::summary(const QTextBlock &block) const
+{
+    Summary result;
+
+    switch (m_mode)
+    {
+    case QStyleSyntaxHighlighter::FoldingMode::Brackets: {
+        auto brackets = m_brackets->brackets(block);
+        if (brackets.isEmpty())
+        {
+            break;
+        }
+
+        result.minimum = 0;
+        for (auto &bracket : brackets)
+        {
+            result.delta += bracket.open ? 1 : -1;
+            result.minimum = qMin(result.minimum, result.delta);
+        }
+        break;
+    }
+    case QStyleSyntaxHighlighter::FoldingMode::Indentation: {
+        auto text = block.text();
+        if (!isBlank(text))
+        {
+            result.minimum = indentation(text);
+        }
+        break;
+    }
+    case QStyleSyntaxHighlighter::FoldingMode::Tags: {
+        auto matchIterator = TagRegex.globalMatch(block.text());
+        while (matchIterator.hasNext())
+        {
+            auto match = matchIterator.next();
+
+            if (!match.captured(1).isEmpty())
+            {
+                result.delta -= 1;
+            }
+            else if (!match.captured(0).endsWith("/>"))
+            {
+                result.delta += 1;
+            }
+            else
+            {
+                continue;
+            }
+
+            result.minimum = qMin(result.minimum == Summary::NoMinimum ? 0 : result.minimum, result.delta);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    return result;
+}
+
+int QScopeTree::depth(int position) const
+{
+    int result = 0;
+
+    for (auto node = m_root; node;)
+    {
+        if (node->block.position() < position)
+        {
+            result += total(node->scopeNode.left).delta + own(node).delta;
+            node = node->scopeNode.right;
+        }
+        else
+        {
+            node = node->scopeNode.left;
+        }
+    }
+
+    return result;
+}
+
+void QScopeTree::link(QCodeBlockData *data)
+{
+    // xorshift32
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    auto &links = data->scopeNode;
+    links.left = links.right = links.parent = nullptr;
+    links.priority = m_seed;
+    links.linked = true;
+    links.total = links.own;
+
+    QCodeBlockData *left;
+    QCodeBlockData *right;
+    split(m_root, data->block.position(), left, right);
+
+    m_root = merge(merge(left, data), right);
+    m_root->scopeNode.parent = nullptr;
+}
+
+void QScopeTree::unlink(QCodeBlockData *data)
+{
+    auto &links = data->scopeNode;
+    auto parent = links.parent;
+    auto child = merge(links.left, links.right);
+
+    if (child)
+    {
+        child->scopeNode.parent = parent;
+    }
+
+    if (!parent)
+    {
+        m_root = child;
+    }
+    else if (parent->scopeNode.left == data)
+    {
+        parent->scopeNode.left = child;
+    }
+    else
+    {
+        parent->scopeNode.right = child;
+    }
+
+    for (auto node = parent; node; node = node->scopeNode.parent)
+    {
+        pull(node);
+    }
+
+    // The summary stays for when the block is linked again
+    auto summary = links.own;
+    links = QCodeBlockData::ScopeNode();
+    links.own = summary;
+}
@@ -3,7 +3,7 @@
 
 QStyleSyntaxHighlighter::QStyleSyntaxHighlighter(QTextDocument *document)
     : QSyntaxHighlighter(document), m_syntaxStyle(nullptr), m_commentLineSequence(), m_startCommentBlockSequence(),
-      m_endCommentBlockSequence()
+      m_endCommentBlockSequence(), m_foldingMode(FoldingMode::Brackets)
 {
 }
 
@@ -46,3 +46,13 @@ void QStyleSyntaxHighlighter::setEndCommentBlockSequence(const QString &endComme
 {
     m_endCommentBlockSequence = endCommentBlockSequence;
 }
+
+QStyleSyntaxHighlighter::FoldingMode QStyleSyntaxHighlighter::foldingMode() const
+{
+    return m_foldingMode;
+}
+
+void QStyleSyntaxHighlighter::setFoldingMode(FoldingMode mode)
+{
+    m_foldingMode = mode;
+}
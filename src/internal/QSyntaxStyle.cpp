@@ -104,6 +104,8 @@ bool QSyntaxStyle::load(const QString &fl)
                     format.setUnderlineColor(QColor(color.toString()));
                 }
 
+                format.setProperty(FormatNameProperty, name.toString());
+
                 m_data[name.toString()] = format;
             }
         }
@@ -131,6 +133,11 @@ QTextCharFormat QSyntaxStyle::getFormat(const QString &name) const
     return result.value();
 }
 
+bool QSyntaxStyle::hasFormat(const QString &name) const
+{
+    return m_data.contains(name);
+}
+
 bool QSyntaxStyle::isLoaded() const
 {
     return m_loaded;
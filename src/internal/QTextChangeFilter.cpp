@@ -0,0 +1,19 @@
+// QCodeEditor
+#include <QTextChangeFilter>
+
+// Qt
+#include <QTextDocument>
+
+QTextChangeFilter::QTextChangeFilter(QTextDocument *document)
+    : m_document(document), m_revision(document ? document->revision() : 0)
+{
+}
+
+bool QTextChangeFilter::isTextChange(int charsRemoved, int charsAdded)
+{
+    auto revision = m_document ? m_document->revision() : m_revision;
+    auto changed = revision != m_revision || charsRemoved != charsAdded;
+
+    m_revision = revision;
+    return changed;
+}
@@ -0,0 +1,404 @@
+// QCodeEditor
+#include <QCodeBlockData>
+#include <QTrigramIndex>
+
+// Qt
+#include <QElapsedTimer>
+#include <QTextDocument>
+#include <QTimer>
+
+// std
+#include <algorithm>
+
+namespace
+{
+// Time spent indexing before the events are processed, ms
+constexpr int SliceTime = 8;
+
+// Blocks indexed between checks of the time
+constexpr int SliceBlocks = 256;
+
+// Rough size of a hash node and of a set node, bytes
+constexpr int HashNodeSize = 32;
+constexpr int SetNodeSize = 16;
+} // namespace
+
+QTrigramIndex::QTrigramIndex(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_document(document), m_buildTimer(new QTimer(this)), m_enabled(false), m_threshold(-1),
+      m_buildBlock(0), m_ready(false), m_buildTime(0), m_postings(), m_postingCount(0)
+{
+    // Runs whenever there are no pending events
+    m_buildTimer->setSingleShot(true);
+    m_buildTimer->setInterval(0);
+
+    connect(m_buildTimer, &QTimer::timeout, this, &QTrigramIndex::buildSlice);
+    connect(document, &QTextDocument::contentsChange, this, &QTrigramIndex::onContentsChange);
+}
+
+QTrigramIndex::~QTrigramIndex()
+{
+    // The document may have been deleted first
+    if (!m_document)
+    {
+        return;
+    }
+
+    setEnabled(false);
+}
+
+QString QTrigramIndex::requiredLiteral(const QString &pattern)
+{
+    QString longest;
+    QString run;
+
+    auto endRun = [&]() {
+        if (run.size() > longest.size())
+        {
+            longest = run;
+        }
+        run.clear();
+    };
+
+    int depth = 0;
+
+    for (int i = 0; i < pattern.size(); ++i)
+    {
+        auto c = pattern[i];
+
+        if (c == '|')
+        {
+            return QString();
+        }
+
+        // Characters in groups and classes may be optional or alternatives
+        if (c == '(' || c == '[')
+        {
+            endRun();
+            ++depth;
+            continue;
+        }
+
+        if (c == ')' || c == ']')
+        {
+            depth = qMax(depth - 1, 0);
+            continue;
+        }
+
+        if (depth > 0)
+        {
+            if (c == '\\')
+            {
+                ++i;
+            }
+            continue;
+        }
+
+        if (c == '?' || c == '*' || c == '{')
+        {
+            // The previous character is optional or repeated
+            if (!run.isEmpty())
+            {
+                run.chop(1);
+            }
+            endRun();
+
+            if (c == '{')
+            {
+                auto end = pattern.indexOf('}', i);
+                i = end < 0 ? static_cast<int>(pattern.size()) : static_cast<int>(end);
+            }
+            continue;
+        }
+
+        if (c == '\\' || c == '.' || c == '^' || c == '$' || c == '+')
+        {
+            if (c == '\\')
+            {
+                ++i;
+            }
+            endRun();
+            continue;
+        }
+
+        run.append(c);
+    }
+
+    endRun();
+
+    return longest;
+}
+
+void QTrigramIndex::setEnabled(bool enabled)
+{
+    if (enabled == m_enabled)
+    {
+        return;
+    }
+
+    m_enabled = enabled;
+    m_ready = false;
+    m_buildBlock = 0;
+    m_buildTime = 0;
+
+    if (enabled)
+    {
+        m_buildTimer->start();
+        return;
+    }
+
+    m_buildTimer->stop();
+
+    for (auto block = m_document->begin(); block.isValid(); block = block.next())
+    {
+        auto data = QCodeBlockData::get(block);
+        if (data && data->trigramIndex == this)
+        {
+            data->trigramIndex = nullptr;
+            data->trigrams.clear();
+        }
+    }
+
+    m_postings.clear();
+    m_postingCount = 0;
+}
+
+bool QTrigramIndex::isEnabled() const
+{
+    return m_enabled;
+}
+
+void QTrigramIndex::setThreshold(int characters)
+{
+    m_threshold = characters;
+
+    if (m_threshold >= 0 && m_document->characterCount() >= m_threshold)
+    {
+        setEnabled(true);
+    }
+}
+
+int QTrigramIndex::threshold() const
+{
+    return m_threshold;
+}
+
+bool QTrigramIndex::isReady() const
+{
+    return m_ready;
+}
+
+qint64 QTrigramIndex::buildTime() const
+{
+    return m_buildTime;
+}
+
+qint64 QTrigramIndex::memoryUsage() const
+{
+    // Each posting is a set node and a trigram kept by the block
+    return m_postings.size() * (HashNodeSize + static_cast<qint64>(sizeof(QSet<QCodeBlockData *>))) +
+           m_postingCount * (SetNodeSize + static_cast<qint64>(sizeof(quint64)));
+}
+
+QVector<QTextBlock> QTrigramIndex::candidates(const QString &text) const
+{
+    QVector<const QSet<QCodeBlockData *> *> sets;
+
+    for (auto trigram : trigrams(text))
+    {
+        auto it = m_postings.find(trigram);
+        if (it == m_postings.end())
+        {
+            return {};
+        }
+
+        sets.append(&it.value());
+    }
+
+    if (sets.isEmpty())
+    {
+        return {};
+    }
+
+    // Intersection is driven by the rarest trigram
+    std::sort(sets.begin(), sets.end(), [](const QSet<QCodeBlockData *> *a, const QSet<QCodeBlockData *> *b) {
+        return a->size() < b->size();
+    });
+
+    QVector<QPair<int, QTextBlock>> blocks;
+
+    for (auto data : *sets.first())
+    {
+        if (std::all_of(sets.cbegin() + 1, sets.cend(),
+                        [data](const QSet<QCodeBlockData *> *set) { return set->contains(data); }))
+        {
+            blocks.append({data->block.position(), data->block});
+        }
+    }
+
+    std::sort(blocks.begin(), blocks.end(),
+              [](const QPair<int, QTextBlock> &a, const QPair<int, QTextBlock> &b) { return a.first < b.first; });
+
+    QVector<QTextBlock> result;
+    result.reserve(blocks.size());
+
+    for (auto &block : qAsConst(blocks))
+    {
+        result.append(block.second);
+    }
+
+    return result;
+}
+
+void QTrigramIndex::removeBlock(QCodeBlockData *data)
+{
+    for (auto trigram : qAsConst(data->trigrams))
+    {
+        auto it = m_postings.find(trigram);
+        if (it == m_postings.end())
+        {
+            continue;
+        }
+
+        it->remove(data);
+
+        if (it->isEmpty())
+        {
+            m_postings.erase(it);
+        }
+    }
+
+    m_postingCount -= data->trigrams.size();
+
+    data->trigrams.clear();
+    data->trigramIndex = nullptr;
+}
+
+void QTrigramIndex::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (!m_enabled)
+    {
+        if (m_threshold >= 0 && m_document->characterCount() >= m_threshold)
+        {
+            setEnabled(true);
+        }
+        return;
+    }
+
+    auto first = m_document->findBlock(position);
+    auto last = m_document->findBlock(position + charsAdded);
+
+    for (auto block = first; block.isValid(); block = block.next())
+    {
+        auto data = QCodeBlockData::get(block);
+
+        if (m_ready)
+        {
+            indexBlock(block);
+        }
+        else if (data && data->trigramIndex == this)
+        {
+            // Left to the build, e.g. while a file is being loaded
+            removeBlock(data);
+        }
+
+        if (block == last)
+        {
+            break;
+        }
+    }
+
+    // The build continues from the change, blocks may have moved before its position
+    if (!m_ready)
+    {
+        m_buildBlock = qMin(m_buildBlock, first.blockNumber());
+    }
+}
+
+void QTrigramIndex::buildSlice()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    auto block = m_document->findBlockByNumber(m_buildBlock);
+
+    while (block.isValid() && timer.elapsed() < SliceTime)
+    {
+        for (int i = 0; i < SliceBlocks && block.isValid(); ++i, block = block.next())
+        {
+            auto data = QCodeBlockData::get(block);
+            if (!data || data->trigramIndex != this)
+            {
+                indexBlock(block);
+            }
+        }
+    }
+
+    m_buildTime += timer.elapsed();
+
+    if (block.isValid())
+    {
+        m_buildBlock = block.blockNumber();
+        m_buildTimer->start();
+        return;
+    }
+
+    m_buildBlock = m_document->blockCount();
+    m_ready = true;
+
+    Q_EMIT ready();
+}
+
+QVector<quint64> QTrigramIndex::trigrams(const QString &text)
+{
+    QVector<quint64> result;
+    if (text.size() < 3)
+    {
+        return result;
+    }
+
+    result.reserve(text.size() - 2);
+
+    quint64 key = 0;
+    for (int i = 0; i < text.size(); ++i)
+    {
+        // Three folded UTF-16 units in the low 48 bits
+        key = ((key << 16) | text[i].toCaseFolded().unicode()) & 0xFFFFFFFFFFFFull;
+
+        if (i >= 2)
+        {
+            result.append(key);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    return result;
+}
+
+void QTrigramIndex::indexBlock(const QTextBlock &block)
+{
+    auto data = QCodeBlockData::get(block, true);
+    auto blockTrigrams = trigrams(block.text());
+
+    // Format changes (e.g. by the highlighter) don't change the trigrams
+    if (data->trigramIndex == this && data->trigrams == blockTrigrams)
+    {
+        return;
+    }
+
+    if (data->trigramIndex == this)
+    {
+        removeBlock(data);
+    }
+
+    for (auto trigram : qAsConst(blockTrigrams))
+    {
+        m_postings[trigram].insert(data);
+    }
+
+    m_postingCount += blockTrigrams.size();
+
+    data->trigrams = blockTrigrams;
+    data->trigramIndex = this;
+}
@@ -0,0 +1,218 @@
+// QCodeEditor
+#include <QCodeBlockData>
+#include <QWordIndex>
+
+// Qt
+#include <QTextBlock>
+#include <QTextDocument>
+
+// std
+#include <algorithm>
+
+namespace
+{
+bool isWordCharacter(QChar c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+} // namespace
+
+QWordIndex::QWordIndex(QTextDocument *document, QObject *parent)
+    : QObject(parent), m_document(document), m_entries(), m_revision(0)
+{
+    connect(document, &QTextDocument::contentsChange, this, &QWordIndex::onContentsChange);
+
+    indexBlocks(0, m_document->characterCount());
+}
+
+QWordIndex::~QWordIndex()
+{
+    // The document may have been deleted first
+    if (!m_document)
+    {
+        return;
+    }
+
+    for (auto block = m_document->begin(); block.isValid(); block = block.next())
+    {
+        auto data = QCodeBlockData::get(block);
+        if (data && data->wordIndex == this)
+        {
+            data->wordIndex = nullptr;
+            data->words.clear();
+            data->textHash = 0;
+        }
+    }
+}
+
+bool QWordIndex::isWord(const QString &text)
+{
+    return !text.isEmpty() && std::all_of(text.begin(), text.end(), isWordCharacter);
+}
+
+int QWordIndex::count(const QString &word) const
+{
+    auto it = m_entries.find(word);
+    return it == m_entries.end() ? 0 : it->count;
+}
+
+QVector<int> QWordIndex::occurrences(const QString &word) const
+{
+    QVector<int> positions;
+
+    auto it = m_entries.find(word);
+    if (it == m_entries.end())
+    {
+        return positions;
+    }
+
+    QVector<QCodeBlockData *> blocks(it->blocks.begin(), it->blocks.end());
+    std::sort(blocks.begin(), blocks.end(),
+              [](QCodeBlockData *a, QCodeBlockData *b) { return a->block.position() < b->block.position(); });
+
+    positions.reserve(it->count);
+
+    for (auto data : qAsConst(blocks))
+    {
+        auto position = data->block.position();
+        for (auto column : data->words.value(word))
+        {
+            positions.append(position + column);
+        }
+    }
+
+    return positions;
+}
+
+QVector<int> QWordIndex::occurrences(const QString &word, int from, int to) const
+{
+    QVector<int> positions;
+
+    if (!m_entries.contains(word))
+    {
+        return positions;
+    }
+
+    for (auto block = m_document->findBlock(from); block.isValid() && block.position() <= to; block = block.next())
+    {
+        auto data = QCodeBlockData::get(block);
+        if (!data)
+        {
+            continue;
+        }
+
+        auto position = block.position();
+        for (auto column : data->words.value(word))
+        {
+            positions.append(position + column);
+        }
+    }
+
+    return positions;
+}
+
+QStringList QWordIndex::words() const
+{
+    return m_entries.keys();
+}
+
+int QWordIndex::revision() const
+{
+    return m_revision;
+}
+
+void QWordIndex::removeBlock(QCodeBlockData *data)
+{
+    for (auto it = data->words.cbegin(); it != data->words.cend(); ++it)
+    {
+        auto entry = m_entries.find(it.key());
+        if (entry == m_entries.end())
+        {
+            continue;
+        }
+
+        entry->blocks.remove(data);
+        entry->count -= it.value().size();
+
+        if (entry->blocks.isEmpty())
+        {
+            m_entries.erase(entry);
+            ++m_revision;
+        }
+    }
+
+    data->words.clear();
+    data->textHash = 0;
+}
+
+void QWordIndex::onContentsChange(int position, int, int charsAdded)
+{
+    // Removed blocks are dropped by QCodeBlockData
+    indexBlocks(position, position + charsAdded);
+}
+
+void QWordIndex::indexBlocks(int from, int to)
+{
+    for (auto block = m_document->findBlock(from); block.isValid() && block.position() <= to; block = block.next())
+    {
+        auto text = block.text();
+        auto hash = qHash(text);
+        auto data = QCodeBlockData::get(block);
+
+        // Unchanged text, e.g. the highlighter has set formats
+        if (data && data->wordIndex == this && data->textHash == hash)
+        {
+            continue;
+        }
+
+        QHash<QString, QVector<int>> words;
+
+        for (int i = 0; i < text.size();)
+        {
+            if (!isWordCharacter(text[i]))
+            {
+                ++i;
+                continue;
+            }
+
+            int start = i;
+            while (i < text.size() && isWordCharacter(text[i]))
+            {
+                ++i;
+            }
+
+            words[text.mid(start, i - start)].append(start);
+        }
+
+        if (!data && words.isEmpty())
+        {
+            continue;
+        }
+
+        if (!data)
+        {
+            data = QCodeBlockData::get(block, true);
+        }
+
+        if (data->wordIndex == this)
+        {
+            removeBlock(data);
+        }
+
+        for (auto it = words.cbegin(); it != words.cend(); ++it)
+        {
+            auto &entry = m_entries[it.key()];
+            if (entry.blocks.isEmpty())
+            {
+                ++m_revision;
+            }
+
+            entry.blocks.insert(data);
+            entry.count += it.value().size();
+        }
+
+        data->words = words;
+        data->textHash = hash;
+        data->wordIndex = this;
+    }
+}
@@ -12,6 +12,8 @@ QXMLHighlighter::QXMLHighlighter(QTextDocument *document)
 
     m_startCommentBlockSequence = "<!--";
     m_endCommentBlockSequence = "-->";
+
+    m_foldingMode = FoldingMode::Tags;
 }
 
 void QXMLHighlighter::highlightBlock(const QString &text)